@@ -20,17 +20,11 @@
 
 
 /**
-   get_codeNum     :Get codenum based on sec 9.1 of H264 spec.
-   @param      cxt : Buffer adress & size are part inputs, the cxt is updated
-                     with codeNum & sign on sucess.
-                     Assumption: codeNum is a max of 32 bits
-                     
-   @retval       1 : Sucessfuly found a code num, cxt is updated with codeNum, sign, and size of code.
-   @retval       0 : Couldn't find a code in the current buffer.
-   be freed.
+   get_codeNum_bytewise : Same as h264_get_codeNum, looks for the leading 1 a byte at a time.
+                     Used for the last bits of a NAL, where a 32 bit peek fails.
 */
 
-uint32_t h264_get_codeNum(void *parent, h264_Info* pInfo)
+static uint32_t h264_get_codeNum_bytewise(void *parent)
 {
    int32_t    leadingZeroBits= 0;
    uint32_t    temp = 0, match = 0, noOfBits = 0, count = 0;
@@ -42,9 +36,6 @@ uint32_t h264_get_codeNum(void *parent, h264_Info* pInfo)
    uint32_t   bits_need_add_in_first_byte =0;
    int32_t    bits_operation_result=0;
 
-   //remove warning
-   pInfo = pInfo;   
-
    ////// Step 1: parse through zero bits until we find a bit with value 1.
    viddec_pm_get_au_pos(parent, &bits_offset, &byte_offset, &is_emul);
 
@@ -163,6 +154,59 @@ uint32_t h264_get_codeNum(void *parent, h264_Info* pInfo)
 }
 
 
+
+/**
+   get_codeNum     :Get codenum based on sec 9.1 of H264 spec.
+   @param      cxt : Buffer adress & size are part inputs, the cxt is updated
+                     with codeNum & sign on sucess.
+                     Assumption: codeNum is a max of 32 bits
+                     
+   @retval       1 : Sucessfuly found a code num, cxt is updated with codeNum, sign, and size of code.
+   @retval       0 : Couldn't find a code in the current buffer.
+   be freed.
+*/
+
+uint32_t h264_get_codeNum(void *parent, h264_Info* pInfo)
+{
+   int32_t    leadingZeroBits= 0;
+   uint32_t   temp = 0, codeNum = 0;
+
+   //remove warning
+   pInfo = pInfo;   
+
+   ////// Step 1: count the zero bits before the first 1 in the next 32 bits.
+   if(-1 == viddec_pm_peek_bits(parent, &temp, 32))
+   {
+      return h264_get_codeNum_bytewise(parent);
+   }
+
+   if(temp == 0)
+   {
+      // more than 31 leading zeros, codeNum doesn't fit in 32 bits
+      viddec_pm_skip_bits(parent, 32);
+      return MAX_INT32_VALUE;
+   }
+   leadingZeroBits = __builtin_clz(temp);
+
+   ////// Step 2: read the leadingZeroBits bits after the 1.
+   if(leadingZeroBits < 16)
+   {
+      // whole code is in temp, its top 2*leadingZeroBits+1 bits are codeNum + 1
+      viddec_pm_skip_bits(parent, 2 * leadingZeroBits + 1);
+      return (temp >> (31 - 2 * leadingZeroBits)) - 1;
+   }
+
+   viddec_pm_skip_bits(parent, leadingZeroBits + 1);
+   if(-1 == viddec_pm_get_bits(parent, &codeNum, leadingZeroBits))
+   {
+      return MAX_INT32_VALUE;
+   }
+
+   // codeNum = 2 ** (leadingZeroBits) -1 + read_bits(leadingZeroBits). 
+   return codeNum + ((uint32_t)1 << leadingZeroBits) - 1;
+}
+
+
 /*---------------------------------------*/
 /*---------------------------------------*/
 int32_t h264_GetVLCElement(void *parent, h264_Info* pInfo, uint8_t bIsSigned)
@@ -142,6 +142,9 @@ typedef enum
  */
 #define MAX_BITPLANE_SZ 272
 
+/* libVA bit-plane buffer size in bytes, two MBs per byte */
+#define MAX_PACKED_BITPLANE_SZ 16384
+
 /* Full Info */
 typedef struct {
    unsigned char*       bufptr;         /* current frame, point to header or data */
@@ -202,20 +205,11 @@ typedef struct
     VC1D_SPR_REGS spr;
     ref_frame_t   ref_frame[VC1_NUM_REFERENCE_FRAMES];
 #ifdef VBP
-    /* A storage area is provided for each type of bit plane.  Only one of */
-    /* each type will ever be used for a picture and never more than three */
-    /* bit-planes per picture, and often only one is used.  We never clear */
-    /* this data and writes into it when we need to.  vc1parse_bitplane.c  */
-    /* makes use of these set them to one of the bitplane types included   */
-    /* in the picture header structure.  Those sturctures are set every    */
-    /* time a picture parse begins. */
-    uint32_t      bp_forwardmb[4096];
-    uint32_t      bp_acpred[4096];
-    uint32_t      bp_mvtypemb[4096];
-    uint32_t      bp_overflags[4096];
-    uint32_t      bp_skipmb[4096];
-    uint32_t      bp_directmb[4096];
-    uint32_t      bp_fieldtx[4096];
+    /* Bit-planes of the current picture, packed the way libVA takes them */
+    /* (one nibble per MB, see va.h).  vc1parse_bitplane.c packs each     */
+    /* bit-plane in as soon as it is decoded, and the buffer is cleared   */
+    /* every time a picture parse begins. */
+    uint8_t       bp_packed[MAX_PACKED_BITPLANE_SZ];
     uint32_t	  start_code;
 #endif
 } vc1_viddec_parser_t;
@@ -73,6 +73,30 @@ extern const int32_t VC1_BITPLANE_K_TBL[];
 extern const int32_t VC1_BFRACTION_TBL[];
 extern const int32_t VC1_REFDIST_TBL[];
 
+/* Lookup table built from one of the VLC tables above. The first "bits" bits
+   of a code index entries[]; codes longer than that continue in a sub-table
+   indexed by the next sub_bits bits. */
+typedef struct
+{
+    int16_t first;      /* decoded value, or sub-table offset when len is 0 */
+    int16_t second;     /* second decoded value of a pair */
+    int8_t  len;        /* code length, 0 for a sub-table, -1 if invalid */
+    uint8_t sub_bits;
+} vc1_vlc_entry_t;
+
+typedef struct
+{
+    const int32_t *codes;   /* the VLC table this was built from */
+    uint32_t max_bits;
+    uint32_t bits;
+    const vc1_vlc_entry_t *entries;
+} vc1_vlc_table_t;
+
+extern const vc1_vlc_table_t VC1_BITPLANE_IMODE_VLC;
+extern const vc1_vlc_table_t VC1_BITPLANE_K_VLC;
+extern const vc1_vlc_table_t VC1_BFRACTION_VLC;
+extern const vc1_vlc_table_t VC1_REFDIST_VLC;
+
 void vc1_end_frame(vc1_viddec_parser_t *parser);
 
 /* Top-level functions to parse bitstream layers for rcv format. */
@@ -122,8 +146,8 @@ vc1_Status vc1_DMVRangeDecode(void* ctxt, vc1_Info *pInfo);
 vc1_Status vc1_CalculatePQuant(vc1_Info *pInfo);
 vc1_Status vc1_VOPDQuant(void* ctxt, vc1_Info *pInfo);
 vc1_Status vc1_DecodeBitplane(void* ctxt, vc1_Info *pInfo, uint32_t width, uint32_t height, vc1_bpp_type_t bptype);
-vc1_Status vc1_DecodeHuffmanOne(void* ctxt, int32_t *pDst, const int32_t *pDecodeTable);
-vc1_Status vc1_DecodeHuffmanPair(void* ctxt, const int32_t *pDecodeTable, int8_t *pFirst, int16_t *pSecond);
+vc1_Status vc1_DecodeHuffmanOne(void* ctxt, int32_t *pDst, const vc1_vlc_table_t *pVlc);
+vc1_Status vc1_DecodeHuffmanPair(void* ctxt, const vc1_vlc_table_t *pVlc, int8_t *pFirst, int16_t *pSecond);
 
 void vc1_start_new_frame(void *parent, vc1_viddec_parser_t *parser);
 int32_t vc1_parse_emit_current_frame(void *parent, vc1_viddec_parser_t *parser);
@@ -48,101 +48,157 @@ static inline void put_bit( uint32_t value, int x, int y, int mbx, int mby, uint
     *out |= 1 << bit; /* put bit */
 }
 
-/* if b is the bit at location (x,y)
- * b = b^invert
- * used for bitplane decoding, each bit correspond to a MB
- * HW requires row to start at DW (32 bits) boundary
- * input: value - bit value
- *        x   - x location (column) of MB in MB unit
- *        y   - y location (row) of MB in MB unit
- *        mbx - image width in MB
- * output: outp - buffer to fill
- * returns bit value
+/* read num_bits (1 to 32) of a bitplane row or column
+ * the first bit read is returned in bit 0, the order rows are stored in
  */
-static inline int xor_bit(  int x, int y, int mbx, uint32_t invert, uint32_t* outp)
+static inline uint32_t vc1_GetBitsReversed(void* ctxt, uint32_t num_bits)
 {
-    int bit;
-    uint32_t *out;
-    uint8_t value;
-    //if (invert == 0) return; /* do nothing if XOR with 0 */
-
-    out = outp;
-    out += (( mbx + 31 ) >> 5) * y; /* go to corresponding row location in DW unit */
-    out +=  x >> 5; /* go to corresponding row location in DW unit */
-    bit = x & 0x1f; /* compute remaining bits */
+    uint32_t value, bit, i;
 
-    if (invert == 1)
-        *out ^= (1 << bit); /* put XOR bit */
-    value = (*out & (1 << bit)) >> bit; /* return bit value */
+    if (viddec_pm_get_bits(ctxt, &value, num_bits) == -1)
+    {
+        /* fewer bits left than asked for, take what is there */
+        for (i = 0, value = 0; i < num_bits; i++)
+        {
+            VC1_GET_BITS(1, bit);
+            value = (value << 1) | (bit & 1);
+        }
+    }
 
-    return(value);
+    value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+    value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+    value = ((value >> 4) & 0x0F0F0F0F) | ((value & 0x0F0F0F0F) << 4);
+    value = ((value >> 8) & 0x00FF00FF) | ((value & 0x00FF00FF) << 8);
+    value = (value >> 16) | (value << 16);
 
+    return value >> (32 - num_bits);
 }
 
-/* get bit at location (x,y)
- * used for bitplane decoding, each bit correspond to a MB
- * HW requires row to start at DW (32 bits) boundary
- * input: value - bit value
- *        x   - x location (column) of MB in MB unit
- *        y   - y location (row) of MB in MB unit
- *        mbx - image width in MB
- *        outp - bit buffer in dwords
- * returns bit value
- */
-static inline int get_bit(  int x, int y, int mbx, uint32_t* outp)
+/* mask of the valid bits in the last dword of a row */
+static inline uint32_t vc1_LastWordMask(uint32_t width)
 {
-    int bit;
-    uint32_t *out;
-    uint8_t value;
-
-    out = outp;
-    out += (( mbx + 31 ) >> 5) * y; /* go to corresponding row location in DW unit */
-    out +=  x >> 5; /* go to corresponding row location in DW unit */
-    bit = x & 0x1f; /* compute remaining bits */
-    value = (*out & (1 << bit)) >> bit; /* return bit value */
+    return (width & 0x1f) ? ((1u << (width & 0x1f)) - 1) : 0xffffffff;
+}
 
-    return(value);
+/* XOR every MB of the bitplane with 1, row padding stays zero */
+static void vc1_InvertBitplane(uint32_t *databits, uint32_t width, uint32_t height)
+{
+    uint32_t stride = (width + 31) >> 5;
+    uint32_t last = vc1_LastWordMask(width);
+    uint32_t i, k;
 
+    for (i = 0; i < height; i++, databits += stride)
+    {
+        for (k = 0; k < stride - 1; k++)
+            databits[k] = ~databits[k];
+        databits[k] ^= last;
+    }
 }
 
+/* inverse of the DIFF modes (SMPTE 421M 8.7.3): a MB is XORed with its left
+ * neighbour, with the top neighbour in the first column, and with invert
+ * where the left and top neighbours differ or in the first MB. Where
+ * top == invert the prediction is always invert; elsewhere it is the left
+ * neighbour, so each row is a prefix XOR that restarts at MBs whose top
+ * equals invert. It is computed 32 MBs at a time with log2(32) shift steps.
+ */
 static void vc1_InverseDiff(vc1_Bitplane *pBitplane, int32_t widthMB, int32_t heightMB)
 {
-    int32_t i, j, previousBit=0, temp;
-
-    for (i = 0; i < heightMB; i++)
+    uint32_t stride = (widthMB + 31) >> 5;
+    uint32_t last = vc1_LastWordMask(widthMB);
+    uint32_t inv = pBitplane->invert ? 0xffffffff : 0;
+    uint32_t *row = pBitplane->databits;
+    uint32_t *top = NULL;
+    uint32_t x, chain, carry, s;
+    int32_t i, k;
+
+    for (i = 0; i < heightMB; i++, row += stride)
     {
-        for (j = 0; j < widthMB; j++)
+        /* left of the first MB: invert in the first row, the opposite of
+           invert below (so that a chained first MB takes its top) */
+        carry = (pBitplane->invert ^ (i != 0)) & 1;
+
+        for (k = 0; k < (int32_t)stride; k++)
         {
-            if ((i == 0 && j == 0))
-            {
-                previousBit=xor_bit(j, i, widthMB, pBitplane->invert,
-                                    pBitplane->databits);
-            }
-            else if (j == 0) /* XOR with TOP */
+            /* chain: MB takes its left neighbour, else invert */
+            chain = top ? (top[k] ^ inv) : 0xffffffff;
+            x = row[k] ^ (~chain & inv);
+            for (s = 1; s < 32; s <<= 1)
             {
-                previousBit = get_bit(0, i-1, widthMB, pBitplane->databits);
-                temp=xor_bit(j, i, widthMB, previousBit,
-                             pBitplane->databits);
-                previousBit = temp;
-            }
-            //TODO isSameAsTop can be optimized
-            else if (((i > 0) && (previousBit !=
-                                  get_bit(j, i-1, widthMB, pBitplane->databits))))
-            {
-                temp=xor_bit(j, i, widthMB, pBitplane->invert,
-                             pBitplane->databits);
-                previousBit = temp;
-            }
-            else
-            {
-                temp=xor_bit(j, i, widthMB, previousBit,
-                             pBitplane->databits);
-                previousBit = temp;
+                x ^= (x << s) & chain;
+                chain &= (chain << s) | ((1u << s) - 1);
             }
+            x ^= chain & (0 - carry);
+            carry = x >> 31;
+            row[k] = (k == (int32_t)stride - 1) ? (x & last) : x;
         }
+        top = row;
+    }
+}
+
+/* read width bits of a rowskip row into its dwords */
+static void vc1_GetBitplaneRow(void* ctxt, uint32_t *row, uint32_t width)
+{
+    uint32_t x;
+
+    for (x = 0; x < width; x += 32)
+        row[x >> 5] = vc1_GetBitsReversed(ctxt, (width - x < 32) ? width - x : 32);
+}
+
+/* read height bits of a colskip column into bit (col & 31) of each row */
+static void vc1_GetBitplaneColumn(void* ctxt, uint32_t *databits, uint32_t col,
+                                  uint32_t width, uint32_t height)
+{
+    uint32_t stride = (width + 31) >> 5;
+    uint32_t *out = databits + (col >> 5);
+    uint32_t bit = col & 0x1f;
+    uint32_t y, k, n, bits;
+
+    for (y = 0; y < height; y += 32)
+    {
+        n = (height - y < 32) ? height - y : 32;
+        bits = vc1_GetBitsReversed(ctxt, n);
+        for (k = 0; k < n; k++, out += stride)
+            *out |= ((bits >> k) & 1) << bit;
     }
 }
 
+#ifdef VBP
+/* store a bitplane in the layout libVA takes: one nibble per MB in raster
+ * order, two MBs per byte with the first one in the high nibble, and this
+ * bitplane at bit "shift" of each nibble (see va.h)
+ */
+static void vc1_PackBitplane(uint8_t *packed, const uint32_t *databits,
+                             uint32_t width, uint32_t height, uint32_t shift)
+{
+    static const uint8_t pair[4] = { 0x00, 0x10, 0x01, 0x11 };
+    uint32_t stride = (width + 31) >> 5;
+    uint32_t lo = 0x01 << shift, hi = 0x10 << shift;
+    uint32_t x, y, n, bits;
+    uint8_t *out;
+
+    for (y = 0, n = 0; y < height; y++, n += width, databits += stride)
+    {
+        out = packed + (n >> 1);
+        x = 0;
+        if (n & 1)
+        {
+            /* odd width, row starts in the low nibble */
+            *out = (*out & ~lo) | ((databits[0] & 1) << shift);
+            out++;
+            x = 1;
+        }
+        for (; x + 1 < width; x += 2, out++)
+        {
+            bits = ((databits[x >> 5] >> (x & 0x1f)) & 1) |
+                   (((databits[(x + 1) >> 5] >> ((x + 1) & 0x1f)) & 1) << 1);
+            *out = (*out & ~(lo | hi)) | (pair[bits] << shift);
+        }
+        if (x < width)
+            *out = (*out & ~hi) | (((databits[x >> 5] >> (x & 0x1f)) & 1) << (shift + 4));
+    }
+}
+#endif
 
 /*----------------------------------------------------------------------------*/
 /* implement normal 2 mode bitplane decoding, SMPTE 412M 8.7.3.2
@@ -310,7 +366,7 @@ static void vc1_Norm6ModeDecode(void* ctxt, vc1_Bitplane *pBitplane,
                 col = 2*j + (width & 1); /* compute column location for tile */
 
                 /* get k=sum(bi2^i) were i is the ith bit of the tile */
-                status = vc1_DecodeHuffmanOne(ctxt, &k, VC1_BITPLANE_K_TBL);
+                status = vc1_DecodeHuffmanOne(ctxt, &k, &VC1_BITPLANE_K_VLC);
                 VC1_ASSERT(status == VC1_STATUS_OK);
 
                 /* put bits in tile */
@@ -347,7 +403,7 @@ static void vc1_Norm6ModeDecode(void* ctxt, vc1_Bitplane *pBitplane,
                 col = 3*j + (width%3); /* compute column location for tile */
 
                 /* get k=sum(bi2^i) were i is the ith bit of the tile */
-                status = vc1_DecodeHuffmanOne(ctxt, &k, VC1_BITPLANE_K_TBL);
+                status = vc1_DecodeHuffmanOne(ctxt, &k, &VC1_BITPLANE_K_VLC);
                 VC1_ASSERT(status == VC1_STATUS_OK);
 
                 put_bit(k&1, col, row, width, height,pBitplane->invert,
@@ -470,10 +526,9 @@ int initBitplane(vc1_Bitplane *pBitplane,uint32_t width, uint32_t height)
 vc1_Status vc1_DecodeBitplane(void* ctxt, vc1_Info *pInfo, 
                               uint32_t width, uint32_t height, vc1_bpp_type_t bpnum)
 {
-    uint32_t i, j;
+    uint32_t i;
     uint32_t tempValue;
     vc1_Status status = VC1_STATUS_OK;
-    uint32_t biplaneSz; /* bitplane sz in dwords */
     vc1_Bitplane bp;
     vc1_Bitplane *bpp = &bp;
 
@@ -483,14 +538,14 @@ vc1_Status vc1_DecodeBitplane(void* ctxt, vc1_Info *pInfo,
     // bitplane data would be temporarily stored in the vc1 context
     bpp->databits = pInfo->bitplane;
 
-    /* init bitplane to zero, function retunr bitplane buffer size in dword */
-    biplaneSz = initBitplane(bpp, width, height);
+    /* init bitplane to zero */
+    initBitplane(bpp, width, height);
 
     VC1_GET_BITS(1, tempValue);
     bpp->invert = (uint8_t) tempValue;
 
     if ((status = vc1_DecodeHuffmanOne(ctxt, &bpp->imode,
-                                       VC1_BITPLANE_IMODE_TBL)) != VC1_STATUS_OK)
+                                       &VC1_BITPLANE_IMODE_VLC)) != VC1_STATUS_OK)
     {
         return status;
     }
@@ -521,51 +576,29 @@ vc1_Status vc1_DecodeBitplane(void* ctxt, vc1_Info *pInfo,
     }
     else if (bpp->imode == VC1_BITPLANE_ROWSKIP_MODE)
     {
+        uint32_t stride = (width + 31) >> 5;
 
+        /* rows not coded stay zero until inverted */
         for (i = 0; i < height; i++)
         {
             VC1_GET_BITS(1, tempValue);
-            /* if tempValue==0,  put row of zeros Dwords*/
             if (tempValue == 1)
-            {
-                for (j = 0; j < width; j++)
-                {
-                    VC1_GET_BITS(1, tempValue);
-                    put_bit( tempValue, j, i, width, height, bpp->invert,
-                             bpp->databits);
-                }
-            }
-            else if (bpp->invert) { //TO TEST
-                for (j = 0; j < width; j++) {
-                    put_bit( 0, j, i, width, height, bpp->invert,
-                             bpp->databits);
-                }
-            }
+                vc1_GetBitplaneRow(ctxt, bpp->databits + i * stride, width);
         }
-
+        if (bpp->invert)
+            vc1_InvertBitplane(bpp->databits, width, height);
     }
     else if (bpp->imode == VC1_BITPLANE_COLSKIP_MODE)
     {
+        /* columns not coded stay zero until inverted */
         for (i = 0; i < width; i++)
         {
             VC1_GET_BITS(1, tempValue);
-            /* if tempValue==0, and invert == 0, fill column with zeros */
             if (tempValue == 1)
-            {
-                for (j = 0; j < height; j++)
-                {
-                    VC1_GET_BITS(1, tempValue);
-                    put_bit( tempValue, i, j, width, height, bpp->invert,
-                             bpp->databits);
-                }
-            } 
-            else if (bpp->invert) { // fill column with ones
-                for (j = 0; j < height; j++) {
-                    put_bit( 0, i, j, width, height, bpp->invert,
-                             bpp->databits);
-                }
-            }//end for else  
+                vc1_GetBitplaneColumn(ctxt, bpp->databits, i, width, height);
         }
+        if (bpp->invert)
+            vc1_InvertBitplane(bpp->databits, width, height);
     }
 
     if(bpp->imode != VC1_BITPLANE_RAW_MODE)
@@ -603,149 +636,91 @@ vc1_Status vc1_DecodeBitplane(void* ctxt, vc1_Info *pInfo,
     {
       viddec_pm_cxt_t     *cxt    = (viddec_pm_cxt_t *)ctxt;
       vc1_viddec_parser_t *parser = (vc1_viddec_parser_t *)(cxt->codec_data);
+      vc1_Bitplane *pPlane = NULL;
+      uint8_t *pRaw = NULL;
+      uint32_t shift = 0;
 
-      if (biplaneSz > 4096)
+      if ((width * height + 1) / 2 > sizeof(parser->bp_packed))
       {
         /* bigger than we got, so let's bail with a non meaningful error. */
         return VC1_STATUS_ERROR;
       }
-      
+
       /* At this point bp contains the information we need for the bit-plane */
       /* bpnum is the enumeration that tells us which bitplane this is for.  */
       /* pInfo->picLayerHeader.ACPRED is one of the bitplanes I need to fill.*/
+      /* shift is the bit of the libVA nibble the bitplane goes to.          */
       switch (bpnum)
       {
         case VIDDEC_WORKLOAD_VC1_BITPLANE0:
           if (pInfo->picLayerHeader.PTYPE == VC1_B_FRAME)
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.FORWARDMB.invert = bp.invert;
-              pInfo->picLayerHeader.FORWARDMB.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_forwardmb[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.FORWARDMB.databits = parser->bp_forwardmb;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_FORWARDMB = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.FORWARDMB;
+            pRaw = &pInfo->picLayerHeader.raw_FORWARDMB;
+            shift = 2;
           }
           if ( (pInfo->picLayerHeader.PTYPE == VC1_I_FRAME)
                 || (pInfo->picLayerHeader.PTYPE == VC1_BI_FRAME) )
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.ACPRED.invert = bp.invert;
-              pInfo->picLayerHeader.ACPRED.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_acpred[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.ACPRED.databits = parser->bp_acpred;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_ACPRED = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.ACPRED;
+            pRaw = &pInfo->picLayerHeader.raw_ACPRED;
+            shift = 1;
           }
           if (pInfo->picLayerHeader.PTYPE == VC1_P_FRAME)
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.MVTYPEMB.invert = bp.invert;
-              pInfo->picLayerHeader.MVTYPEMB.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_mvtypemb[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.MVTYPEMB.databits = parser->bp_mvtypemb;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_MVTYPEMB = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.MVTYPEMB;
+            pRaw = &pInfo->picLayerHeader.raw_MVTYPEMB;
+            shift = 2;
           }
           break;
         case VIDDEC_WORKLOAD_VC1_BITPLANE1:
           if ( (pInfo->picLayerHeader.PTYPE == VC1_I_FRAME)
                 || (pInfo->picLayerHeader.PTYPE == VC1_BI_FRAME) )
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.OVERFLAGS.invert = bp.invert;
-              pInfo->picLayerHeader.OVERFLAGS.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_overflags[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.OVERFLAGS.databits = parser->bp_overflags;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_OVERFLAGS = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.OVERFLAGS;
+            pRaw = &pInfo->picLayerHeader.raw_OVERFLAGS;
+            shift = 2;
           }
           if ( (pInfo->picLayerHeader.PTYPE == VC1_P_FRAME)
                 || (pInfo->picLayerHeader.PTYPE == VC1_B_FRAME) )
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.SKIPMB.invert = bp.invert;
-              pInfo->picLayerHeader.SKIPMB.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_skipmb[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.SKIPMB.databits = parser->bp_skipmb;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_SKIPMB = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.SKIPMB;
+            pRaw = &pInfo->picLayerHeader.raw_SKIPMB;
+            shift = 1;
           }
           break;
         case VIDDEC_WORKLOAD_VC1_BITPLANE2:
           if ( (pInfo->picLayerHeader.PTYPE == VC1_P_FRAME)
                 || (pInfo->picLayerHeader.PTYPE == VC1_B_FRAME) )
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.DIRECTMB.invert = bp.invert;
-              pInfo->picLayerHeader.DIRECTMB.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_directmb[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.DIRECTMB.databits = parser->bp_directmb;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_DIRECTMB = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.DIRECTMB;
+            pRaw = &pInfo->picLayerHeader.raw_DIRECTMB;
+            shift = 0;
           }
           if ( (pInfo->picLayerHeader.PTYPE == VC1_I_FRAME)
                 || (pInfo->picLayerHeader.PTYPE == VC1_BI_FRAME) )
           {
-            if(bp.imode != VC1_BITPLANE_RAW_MODE)
-            {
-              pInfo->picLayerHeader.FIELDTX.invert = bp.invert;
-              pInfo->picLayerHeader.FIELDTX.imode = bp.imode;
-              for (i = 0; i < biplaneSz; i++)
-              {
-                parser->bp_fieldtx[i] = bp.databits[i];
-              }
-              pInfo->picLayerHeader.FIELDTX.databits = parser->bp_fieldtx;
-            }
-            else
-            {
-              pInfo->picLayerHeader.raw_FIELDTX = 1;
-            }
+            pPlane = &pInfo->picLayerHeader.FIELDTX;
+            pRaw = &pInfo->picLayerHeader.raw_FIELDTX;
+            shift = 0;
           }
           break;
       }
+
+      if (pPlane != NULL)
+      {
+        if(bp.imode != VC1_BITPLANE_RAW_MODE)
+        {
+          /* packed straight into the picture's libVA bitplane buffer */
+          pPlane->invert = bp.invert;
+          pPlane->imode = bp.imode;
+          vc1_PackBitplane(parser->bp_packed, bp.databits, width, height, shift);
+        }
+        else
+        {
+          *pRaw = 1;
+        }
+      }
     }
 #endif
     
@@ -28,7 +28,7 @@ vc1_Status vc1_ParsePictureHeader_ProgressiveBpicture(void* ctxt, vc1_Info *pInf
     vc1_metadata_t *md = &pInfo->metadata;
     vc1_PictureLayerHeader *picLayerHeader = &pInfo->picLayerHeader;
 
-    if ((status = vc1_DecodeHuffmanPair(ctxt, VC1_BFRACTION_TBL,
+    if ((status = vc1_DecodeHuffmanPair(ctxt, &VC1_BFRACTION_VLC,
         &picLayerHeader->BFRACTION_NUM, &picLayerHeader->BFRACTION_DEN)) !=
         VC1_STATUS_OK)
     {
@@ -196,3 +196,298 @@ const int32_t VC1_REFDIST_TBL[] =
         65534, 16,
     -1  /* end of table. */
 };
+
+/* Lookup tables for the VLC tables above, generated from them. A code is
+   resolved by one peek of max bits instead of one read per bit. */
+
+/* Lookup table for VC1_BITPLANE_IMODE_TBL. */
+static const vc1_vlc_entry_t VC1_BITPLANE_IMODE_VLC_ENTRIES[] =
+{
+    /* first 4 bits */
+    { VC1_BITPLANE_RAW_MODE, 0, 4, 0 }, { VC1_BITPLANE_DIFF6_MODE, 0, 4, 0 }, { VC1_BITPLANE_DIFF2_MODE, 0, 3, 0 }, { VC1_BITPLANE_DIFF2_MODE, 0, 3, 0 },
+    { VC1_BITPLANE_ROWSKIP_MODE, 0, 3, 0 }, { VC1_BITPLANE_ROWSKIP_MODE, 0, 3, 0 }, { VC1_BITPLANE_COLSKIP_MODE, 0, 3, 0 }, { VC1_BITPLANE_COLSKIP_MODE, 0, 3, 0 },
+    { VC1_BITPLANE_NORM2_MODE, 0, 2, 0 }, { VC1_BITPLANE_NORM2_MODE, 0, 2, 0 }, { VC1_BITPLANE_NORM2_MODE, 0, 2, 0 }, { VC1_BITPLANE_NORM2_MODE, 0, 2, 0 },
+    { VC1_BITPLANE_NORM6_MODE, 0, 2, 0 }, { VC1_BITPLANE_NORM6_MODE, 0, 2, 0 }, { VC1_BITPLANE_NORM6_MODE, 0, 2, 0 }, { VC1_BITPLANE_NORM6_MODE, 0, 2, 0 }
+};
+
+const vc1_vlc_table_t VC1_BITPLANE_IMODE_VLC = { VC1_BITPLANE_IMODE_TBL, 4, 4, VC1_BITPLANE_IMODE_VLC_ENTRIES };
+
+/* Lookup table for VC1_BITPLANE_K_TBL. */
+static const vc1_vlc_entry_t VC1_BITPLANE_K_VLC_ENTRIES[] =
+{
+    /* first 8 bits */
+    { 3, 0, 8, 0 }, { 5, 0, 8, 0 }, { 6, 0, 8, 0 }, { 9, 0, 8, 0 },
+    { 10, 0, 8, 0 }, { 12, 0, 8, 0 }, { 17, 0, 8, 0 }, { 18, 0, 8, 0 },
+    { 20, 0, 8, 0 }, { 24, 0, 8, 0 }, { 33, 0, 8, 0 }, { 34, 0, 8, 0 },
+    { 36, 0, 8, 0 }, { 40, 0, 8, 0 }, { 48, 0, 8, 0 }, { 0, 0, -1, 0 },
+    { 256, 0, 0, 2 }, { 260, 0, 0, 2 }, { 264, 0, 0, 2 }, { 268, 0, 0, 2 },
+    { 272, 0, 0, 2 }, { 276, 0, 0, 2 }, { 280, 0, 0, 2 }, { 284, 0, 0, 2 },
+    { 288, 0, 0, 5 }, { 320, 0, 0, 1 }, { 322, 0, 0, 1 }, { 324, 0, 0, 1 },
+    { 63, 0, 6, 0 }, { 63, 0, 6, 0 }, { 63, 0, 6, 0 }, { 63, 0, 6, 0 },
+    { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 },
+    { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 },
+    { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 },
+    { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 }, { 1, 0, 4, 0 },
+    { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 },
+    { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 },
+    { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 },
+    { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 }, { 2, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 },
+    { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 },
+    { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 },
+    { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 }, { 8, 0, 4, 0 },
+    { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 },
+    { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 },
+    { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 },
+    { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 }, { 16, 0, 4, 0 },
+    { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 },
+    { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 },
+    { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 },
+    { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 }, { 32, 0, 4, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 }, { 0, 0, 1, 0 },
+    /* sub-table at 256 */
+    { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 35, 0, 10, 0 },
+    /* sub-table at 260 */
+    { 0, 0, -1, 0 }, { 37, 0, 10, 0 }, { 38, 0, 10, 0 }, { 7, 0, 10, 0 },
+    /* sub-table at 264 */
+    { 0, 0, -1, 0 }, { 41, 0, 10, 0 }, { 42, 0, 10, 0 }, { 11, 0, 10, 0 },
+    /* sub-table at 268 */
+    { 44, 0, 10, 0 }, { 13, 0, 10, 0 }, { 14, 0, 10, 0 }, { 0, 0, -1, 0 },
+    /* sub-table at 272 */
+    { 0, 0, -1, 0 }, { 49, 0, 10, 0 }, { 50, 0, 10, 0 }, { 19, 0, 10, 0 },
+    /* sub-table at 276 */
+    { 52, 0, 10, 0 }, { 21, 0, 10, 0 }, { 22, 0, 10, 0 }, { 0, 0, -1, 0 },
+    /* sub-table at 280 */
+    { 56, 0, 10, 0 }, { 25, 0, 10, 0 }, { 26, 0, 10, 0 }, { 0, 0, -1, 0 },
+    /* sub-table at 284 */
+    { 28, 0, 10, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 },
+    /* sub-table at 288 */
+    { 60, 0, 13, 0 }, { 58, 0, 13, 0 }, { 57, 0, 13, 0 }, { 54, 0, 13, 0 },
+    { 53, 0, 13, 0 }, { 51, 0, 13, 0 }, { 46, 0, 13, 0 }, { 45, 0, 13, 0 },
+    { 43, 0, 13, 0 }, { 39, 0, 13, 0 }, { 30, 0, 13, 0 }, { 29, 0, 13, 0 },
+    { 27, 0, 13, 0 }, { 23, 0, 13, 0 }, { 15, 0, 13, 0 }, { 0, 0, -1, 0 },
+    { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 },
+    { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 },
+    { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 },
+    { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 0, -1, 0 },
+    /* sub-table at 320 */
+    { 62, 0, 9, 0 }, { 61, 0, 9, 0 },
+    /* sub-table at 322 */
+    { 59, 0, 9, 0 }, { 55, 0, 9, 0 },
+    /* sub-table at 324 */
+    { 47, 0, 9, 0 }, { 31, 0, 9, 0 }
+};
+
+const vc1_vlc_table_t VC1_BITPLANE_K_VLC = { VC1_BITPLANE_K_TBL, 13, 8, VC1_BITPLANE_K_VLC_ENTRIES };
+
+/* Lookup table for VC1_BFRACTION_TBL. */
+static const vc1_vlc_entry_t VC1_BFRACTION_VLC_ENTRIES[] =
+{
+    /* first 7 bits */
+    { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 },
+    { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 },
+    { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 },
+    { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 }, { 1, 2, 3, 0 },
+    { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 },
+    { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 },
+    { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 },
+    { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 }, { 1, 3, 3, 0 },
+    { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 },
+    { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 },
+    { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 },
+    { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 }, { 2, 3, 3, 0 },
+    { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 },
+    { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 },
+    { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 },
+    { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 }, { 1, 4, 3, 0 },
+    { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 },
+    { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 },
+    { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 },
+    { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 }, { 3, 4, 3, 0 },
+    { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 },
+    { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 },
+    { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 },
+    { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 }, { 1, 5, 3, 0 },
+    { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 },
+    { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 },
+    { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 },
+    { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 }, { 2, 5, 3, 0 },
+    { 3, 5, 7, 0 }, { 4, 5, 7, 0 }, { 1, 6, 7, 0 }, { 5, 6, 7, 0 },
+    { 1, 7, 7, 0 }, { 2, 7, 7, 0 }, { 3, 7, 7, 0 }, { 4, 7, 7, 0 },
+    { 5, 7, 7, 0 }, { 6, 7, 7, 0 }, { 1, 8, 7, 0 }, { 3, 8, 7, 0 },
+    { 5, 8, 7, 0 }, { 7, 8, 7, 0 }, { VC1_BFRACTION_INVALID, VC1_BFRACTION_INVALID, 7, 0 }, { VC1_BFRACTION_BI, VC1_BFRACTION_BI, 7, 0 }
+};
+
+const vc1_vlc_table_t VC1_BFRACTION_VLC = { VC1_BFRACTION_TBL, 7, 7, VC1_BFRACTION_VLC_ENTRIES };
+
+/* Lookup table for VC1_REFDIST_TBL. */
+static const vc1_vlc_entry_t VC1_REFDIST_VLC_ENTRIES[] =
+{
+    /* first 8 bits */
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 }, { 0, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 }, { 1, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 }, { 2, 0, 2, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 }, { 3, 0, 3, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 }, { 4, 0, 4, 0 },
+    { 5, 0, 5, 0 }, { 5, 0, 5, 0 }, { 5, 0, 5, 0 }, { 5, 0, 5, 0 },
+    { 5, 0, 5, 0 }, { 5, 0, 5, 0 }, { 5, 0, 5, 0 }, { 5, 0, 5, 0 },
+    { 6, 0, 6, 0 }, { 6, 0, 6, 0 }, { 6, 0, 6, 0 }, { 6, 0, 6, 0 },
+    { 7, 0, 7, 0 }, { 7, 0, 7, 0 }, { 8, 0, 8, 0 }, { 256, 0, 0, 8 },
+    /* sub-table at 256 */
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 }, { 9, 0, 9, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 }, { 10, 0, 10, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 }, { 11, 0, 11, 0 },
+    { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 },
+    { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 },
+    { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 },
+    { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 }, { 12, 0, 12, 0 },
+    { 13, 0, 13, 0 }, { 13, 0, 13, 0 }, { 13, 0, 13, 0 }, { 13, 0, 13, 0 },
+    { 13, 0, 13, 0 }, { 13, 0, 13, 0 }, { 13, 0, 13, 0 }, { 13, 0, 13, 0 },
+    { 14, 0, 14, 0 }, { 14, 0, 14, 0 }, { 14, 0, 14, 0 }, { 14, 0, 14, 0 },
+    { 15, 0, 15, 0 }, { 15, 0, 15, 0 }, { 16, 0, 16, 0 }, { 0, 0, -1, 0 }
+};
+
+const vc1_vlc_table_t VC1_REFDIST_VLC = { VC1_REFDIST_TBL, 16, 8, VC1_REFDIST_VLC_ENTRIES };
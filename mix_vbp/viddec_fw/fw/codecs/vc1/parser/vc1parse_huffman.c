@@ -14,7 +14,7 @@
 
 /*----------------------------------------------------------------------------*/
 
-vc1_Status vc1_DecodeHuffmanOne(void* ctxt, int32_t *pDst, const int32_t *pDecodeTable)
+static vc1_Status vc1_DecodeHuffmanOne_bitwise(void* ctxt, int32_t *pDst, const int32_t *pDecodeTable)
 {
     uint32_t tempValue;
     const int32_t *pTable = pDecodeTable;
@@ -55,8 +55,8 @@ vc1_Status vc1_DecodeHuffmanOne(void* ctxt, int32_t *pDst, const int32_t *pDecod
 
 /*----------------------------------------------------------------------------*/
 
-vc1_Status vc1_DecodeHuffmanPair(void* ctxt, const int32_t *pDecodeTable,
-                                 int8_t *pFirst, int16_t *pSecond)
+static vc1_Status vc1_DecodeHuffmanPair_bitwise(void* ctxt, const int32_t *pDecodeTable,
+        int8_t *pFirst, int16_t *pSecond)
 {
     uint32_t tempValue;
     const int32_t *pTable = pDecodeTable;
@@ -95,3 +95,58 @@ vc1_Status vc1_DecodeHuffmanPair(void* ctxt, const int32_t *pDecodeTable,
 
     return status;
 }
+
+/*----------------------------------------------------------------------------*/
+
+/* Peeks max_bits and looks the code up. Returns NULL without consuming bits
+   when fewer than max_bits are left or the code is not in the table; the
+   bitwise decoders handle those cases as before. */
+static const vc1_vlc_entry_t *vc1_LookupVLC(void* ctxt, const vc1_vlc_table_t *pVlc)
+{
+    uint32_t code, rest;
+    const vc1_vlc_entry_t *pEntry;
+
+    if (viddec_pm_peek_bits(ctxt, &code, pVlc->max_bits) == -1)
+        return NULL;
+
+    pEntry = &pVlc->entries[code >> (pVlc->max_bits - pVlc->bits)];
+    if (pEntry->len == 0)
+    {
+        rest = pVlc->max_bits - pVlc->bits - pEntry->sub_bits;
+        code = (code >> rest) & ((1 << pEntry->sub_bits) - 1);
+        pEntry = &pVlc->entries[pEntry->first + code];
+    }
+    if (pEntry->len < 0)
+        return NULL;
+
+    viddec_pm_skip_bits(ctxt, pEntry->len);
+    return pEntry;
+}
+
+/*----------------------------------------------------------------------------*/
+
+vc1_Status vc1_DecodeHuffmanOne(void* ctxt, int32_t *pDst, const vc1_vlc_table_t *pVlc)
+{
+    const vc1_vlc_entry_t *pEntry = vc1_LookupVLC(ctxt, pVlc);
+
+    if (pEntry == NULL)
+        return vc1_DecodeHuffmanOne_bitwise(ctxt, pDst, pVlc->codes);
+
+    *pDst = pEntry->first;
+    return VC1_STATUS_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+vc1_Status vc1_DecodeHuffmanPair(void* ctxt, const vc1_vlc_table_t *pVlc,
+                                 int8_t *pFirst, int16_t *pSecond)
+{
+    const vc1_vlc_entry_t *pEntry = vc1_LookupVLC(ctxt, pVlc);
+
+    if (pEntry == NULL)
+        return vc1_DecodeHuffmanPair_bitwise(ctxt, pVlc->codes, pFirst, pSecond);
+
+    *pFirst = pEntry->first;
+    *pSecond = pEntry->second;
+    return VC1_STATUS_OK;
+}
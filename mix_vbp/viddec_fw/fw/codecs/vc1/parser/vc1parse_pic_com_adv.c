@@ -153,7 +153,7 @@ vc1_Status vc1_ParsePictureHeader_Adv(void* ctxt, vc1_Info *pInfo)
         if ((picLayerHeader->PTYPE == VC1_B_FRAME) &&
             (picLayerHeader->FCM == VC1_FCM_PROGRESSIVE))
         {
-            if ((status = vc1_DecodeHuffmanPair(ctxt, VC1_BFRACTION_TBL,
+            if ((status = vc1_DecodeHuffmanPair(ctxt, &VC1_BFRACTION_VLC,
                                                 &picLayerHeader->BFRACTION_NUM, &picLayerHeader->BFRACTION_DEN))
                 != VC1_STATUS_OK)
             {
@@ -309,7 +309,7 @@ vc1_Status vc1_ParseFieldHeader_Adv(void* ctxt, vc1_Info *pInfo)
     {
         int32_t tmp;
         if ((status = vc1_DecodeHuffmanOne(ctxt, &tmp,
-                                           VC1_REFDIST_TBL)) != VC1_STATUS_OK)
+                                           &VC1_REFDIST_VLC)) != VC1_STATUS_OK)
         {
             return status;
         }
@@ -318,7 +318,7 @@ vc1_Status vc1_ParseFieldHeader_Adv(void* ctxt, vc1_Info *pInfo)
 
     if ((picLayerHeader->FPTYPE >= 4) && (picLayerHeader->FPTYPE <= 7))
     {
-        if ((status = vc1_DecodeHuffmanPair(ctxt, VC1_BFRACTION_TBL,
+        if ((status = vc1_DecodeHuffmanPair(ctxt, &VC1_BFRACTION_VLC,
                                             &picLayerHeader->BFRACTION_NUM, &picLayerHeader->BFRACTION_DEN)) !=
             VC1_STATUS_OK)
         {
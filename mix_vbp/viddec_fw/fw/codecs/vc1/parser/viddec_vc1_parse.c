@@ -137,6 +137,9 @@ static uint32_t viddec_vc1_parse(void *parent, void *ctxt)
         case vc1_SCFrameHeader:
         {
             memset(&parser->info.picLayerHeader, 0, sizeof(vc1_PictureLayerHeader));
+#ifdef VBP
+            memset(parser->bp_packed, 0, sizeof(parser->bp_packed));
+#endif
             status = vc1_ParsePictureLayer(parent, &parser->info);
             if((parser->info.picLayerHeader.PTypeField1 == VC1_I_FRAME) ||
                (parser->info.picLayerHeader.PTypeField1 == VC1_P_FRAME) ||
@@ -194,6 +197,7 @@ static uint32_t viddec_vc1_parse(void *parent, void *ctxt)
 			memset(&(parser->info.picLayerHeader.FIELDTX), 0, sizeof(vc1_Bitplane));
 			memset(&(parser->info.picLayerHeader.OVERFLAGS), 0, sizeof(vc1_Bitplane));
 			memset(&(parser->info.picLayerHeader.FORWARDMB), 0, sizeof(vc1_Bitplane));
+			memset(parser->bp_packed, 0, sizeof(parser->bp_packed));
 															  
 			parser->info.picLayerHeader.ALTPQUANT = 0;
 			parser->info.picLayerHeader.DQDBEDGE = 0;
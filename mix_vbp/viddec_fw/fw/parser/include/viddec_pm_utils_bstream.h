@@ -29,11 +29,33 @@ typedef struct
     uint32_t bitoff; /* bit offset in first valid byte */
 }viddec_pm_utils_bstream_scratch_cxt_t;
 
+#ifdef VBP
+/* When emulation prevention is required, a list item is unescaped into buf before it's read, a chunk at a time
+   as reads get close to the end of what was unescaped so far. */
+typedef struct
+{
+    uint8_t *buf;        /* unescaped bytes of the list item, bstrm_buf reads from here */
+    uint32_t *emul_map;  /* for each removed emulation prevention byte, index in buf of the byte that followed it */
+    uint32_t size;       /* bytes allocated for buf, emul_map has room for size/3 + 1 entries */
+    uint32_t emul_count; /* number of entries in emul_map */
+    uint8_t *esc_buf;    /* escaped data */
+    uint32_t esc_st;     /* index in esc_buf of first byte of list item */
+    uint32_t esc_pos;    /* next byte in esc_buf to unescape */
+    uint32_t esc_end;    /* first invalid byte in esc_buf */
+    uint32_t enabled;    /* list item is read from buf */
+}viddec_pm_utils_bstream_rbsp_cxt_t;
+#endif
+
 typedef struct
 {
 #ifdef VBP
-	/* counter of emulation preventation byte */
-	uint32_t emulation_byte_counter;
+	/* unescaped copy of current list item */
+	viddec_pm_utils_bstream_rbsp_cxt_t rbsp;
+	/* Next bits of the stream msb first, all reads go through it. cache_bits counts the valid bits,
+	   cache_pos is the stream bit position of the msb. */
+	uint64_t cache;
+	uint32_t cache_bits;
+	uint32_t cache_pos;
 #endif	
     /* After First pass of scan we figure out how many bytes are in the current access unit(N bytes). We store
        the bstream buffer's first valid byte index wrt to accessunit in this variable */
@@ -64,10 +86,29 @@ uint8_t viddec_pm_utils_bstream_nomoredata(viddec_pm_utils_bstream_cxt_t *cxt);
 
 uint8_t viddec_pm_utils_bstream_nomorerbspdata(viddec_pm_utils_bstream_cxt_t *cxt);
 
+#ifdef VBP
+void viddec_pm_utils_bstream_init_rbsp(viddec_pm_utils_bstream_cxt_t *cxt);
+
+void viddec_pm_utils_bstream_get_escaped_offsets(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t *bit, uint32_t *byte, uint8_t *is_emul);
+
+/* Bit position in current list item with emulation prevention bytes removed */
+static inline uint32_t viddec_pm_utils_bstream_get_rbsp_bitpos(viddec_pm_utils_bstream_cxt_t *cxt)
+{
+    return ((cxt->bstrm_buf.buf_index - cxt->bstrm_buf.buf_st) << 3) + cxt->bstrm_buf.buf_bitoff;
+}
+#endif
+
 static inline void viddec_pm_utils_bstream_get_au_offsets(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t *bit, uint32_t *byte, uint8_t *is_emul)
 {
     uint32_t phase=cxt->phase;
 
+#ifdef VBP
+    if(cxt->rbsp.enabled)
+    {
+        viddec_pm_utils_bstream_get_escaped_offsets(cxt, bit, byte, is_emul);
+        return;
+    }
+#endif
     *bit = cxt->bstrm_buf.buf_bitoff;
     *byte = cxt->au_pos + (cxt->bstrm_buf.buf_index - cxt->bstrm_buf.buf_st);
     if(cxt->phase > 0)
@@ -16,9 +16,6 @@
 #include "vbp_h264_parser.h"
 
 
-/* number of bytes used to encode length of NAL payload. Default is 4 bytes. */
-static int NAL_length_size = 4;
-
 /* default scaling list table */
 unsigned char Default_4x4_Intra[16] =
 {     
@@ -129,6 +126,9 @@ uint32 vbp_init_parser_entries_h264(vbp_context *pcontext)
 
 	/* entry point not needed */
 	pcontext->parser_ops->is_frame_start = NULL;
+
+	/* number of bytes used to encode length of NAL payload. Default is 4 bytes. */
+	pcontext->NAL_length_size = 4;
 	return VBP_OK;
 }
 
@@ -1162,8 +1162,8 @@ static uint32_t vbp_add_slice_data_h264(vbp_context *pcontext, int index)
 	/* whole slice is in this buffer */
 	slc_parms->slice_data_flag = VA_SLICE_DATA_FLAG_ALL;
         
-	/* bit offset from NAL start code to the beginning of slice data */
-	slc_parms->slice_data_bit_offset = bit + byte * 8;
+	/* bit offset from NAL start code to the beginning of slice data, without emulation prevention bytes */
+	slc_parms->slice_data_bit_offset = viddec_pm_utils_bstream_get_rbsp_bitpos(&(cxt->getbits));
 #endif
 	
 	if (is_emul)
@@ -1171,11 +1171,6 @@ static uint32_t vbp_add_slice_data_h264(vbp_context *pcontext, int index)
 		WTRACE("next byte is emulation prevention byte.");
 		/*slc_parms->slice_data_bit_offset += 8; */
 	}
-	   
-	if (cxt->getbits.emulation_byte_counter != 0)
-   	{
-   		slc_parms->slice_data_bit_offset -= cxt->getbits.emulation_byte_counter * 8;
-   	}
    
 	slice_header = &(h264_parser->info.SliceHeader);
 	slc_parms->first_mb_in_slice = slice_header->first_mb_in_slice;
@@ -1276,7 +1271,7 @@ uint32 vbp_parse_init_data_h264(vbp_context* pcontext)
 		WTRACE("length size (%d) is not equal to 4.", length_size_minus_one + 1);
 	}
 
-	NAL_length_size = length_size_minus_one + 1;
+	pcontext->NAL_length_size = length_size_minus_one + 1;
 	
   	cur_data++;
   
@@ -1376,9 +1371,9 @@ uint32 vbp_parse_init_data_h264(vbp_context* pcontext)
  	return VBP_OK;
 }
 
-static inline uint32_t vbp_get_NAL_length_h264(uint8_t* p)
+static inline uint32_t vbp_get_NAL_length_h264(vbp_context *pcontext, uint8_t* p)
 {
-	switch (NAL_length_size)
+	switch (pcontext->NAL_length_size)
 	{
 		case 4:
 			return vbp_utils_ntohl(p);
@@ -1396,9 +1391,9 @@ static inline uint32_t vbp_get_NAL_length_h264(uint8_t* p)
 			return *p;
 		
 		default:
-			WTRACE("invalid NAL_length_size: %d.", NAL_length_size);
+			WTRACE("invalid NAL_length_size: %d.", pcontext->NAL_length_size);
 			/* default to 4 bytes for length */
-			NAL_length_size = 4;
+			pcontext->NAL_length_size = 4;
 			return vbp_utils_ntohl(p);
 	}	
 }
@@ -1436,11 +1431,11 @@ uint32 vbp_parse_start_code_h264(vbp_context *pcontext)
 
   	size_left = cubby->size;
 
-  	while (size_left >= NAL_length_size)
+  	while (size_left >= pcontext->NAL_length_size)
   	{
-    	NAL_length = vbp_get_NAL_length_h264(cubby->buf + size_parsed);    	
+    	NAL_length = vbp_get_NAL_length_h264(pcontext, cubby->buf + size_parsed);    	
     	  
-    	size_parsed += NAL_length_size;
+    	size_parsed += pcontext->NAL_length_size;
     	cxt->list.data[cxt->list.num_items].stpos = size_parsed;
     	size_parsed += NAL_length; /* skip NAL bytes */
     	/* end position is exclusive */
@@ -1545,7 +1540,7 @@ uint32 vbp_populate_query_data_h264(vbp_context *pcontext)
   	vbp_set_codec_data_h264(parser, query_data->codec_data);
   	
   	/* buffer number */
-  	query_data->buf_number = buffer_counter;
+  	query_data->buf_number = pcontext->buffer_counter;
 
   	/* VQIAMatrixBufferH264 */
   	vbp_set_scaling_list_h264(parser, query_data->IQ_matrix_buf);
@@ -20,10 +20,6 @@
 
 
 
-/* buffer counter */         
-uint32 buffer_counter = 0;
-
-
 /**
  *
  * uninitialize parser context
@@ -169,6 +165,11 @@ static uint32 vbp_utils_free_parser_memory(vbp_context *pcontext)
 	g_free(pcontext->persist_mem);
 	pcontext->persist_mem = NULL;
 
+	if (pcontext->parser_cxt)
+	{
+		g_free(pcontext->parser_cxt->getbits.rbsp.buf);
+		g_free(pcontext->parser_cxt->getbits.rbsp.emul_map);
+	}
 	g_free(pcontext->parser_cxt);
 	pcontext->parser_cxt = NULL;
 	
@@ -187,7 +188,7 @@ static uint32 vbp_utils_allocate_parser_memory(vbp_context *pcontext)
 	uint32 error = VBP_OK;
 	viddec_parser_memory_sizes_t sizes;
 
-	pcontext->parser_cxt = g_try_new(viddec_pm_cxt_t, 1);
+	pcontext->parser_cxt = g_try_new0(viddec_pm_cxt_t, 1);
 	if (NULL == pcontext->parser_cxt)
 	{
 		ETRACE("Failed to allocate memory");
@@ -261,6 +262,40 @@ cleanup:
 
 
 
+/**
+ *
+ * make sure a list item of a sample buffer of the size can be unescaped
+ *
+ */
+static uint32 vbp_utils_allocate_rbsp(vbp_context *pcontext, uint32 size)
+{
+	viddec_pm_utils_bstream_rbsp_cxt_t *rbsp = &(pcontext->parser_cxt->getbits.rbsp);
+
+	if (size <= rbsp->size)
+	{
+		return VBP_OK;
+	}
+
+	g_free(rbsp->buf);
+	g_free(rbsp->emul_map);
+	rbsp->size = 0;
+
+	/* at most one emulation prevention byte in every 3 bytes */
+	rbsp->buf = g_try_malloc(size);
+	rbsp->emul_map = g_try_new(uint32_t, size / 3 + 1);
+	if (NULL == rbsp->buf || NULL == rbsp->emul_map)
+	{
+		ETRACE("Failed to allocate memory");
+		g_free(rbsp->buf);
+		g_free(rbsp->emul_map);
+		rbsp->buf = NULL;
+		rbsp->emul_map = NULL;
+		return VBP_MEM;
+	}
+	rbsp->size = size;
+	return VBP_OK;
+}
+
 /**
  *
  * parse the elementary sample buffer or codec configuration data
@@ -316,9 +351,6 @@ static uint32 vbp_utils_parse_es_buffer(vbp_context *pcontext, uint8 init_data_f
 	/* set up bitstream buffer */
 	cxt->getbits.list = &(cxt->list);
 
-	/* setup buffer pointer */
-	cxt->getbits.bstrm_buf.buf = cxt->parse_cubby.buf;
-
 	/* 
 	* TO DO:
 	* check if cxt->getbits.is_emul_reqd is set properly 
@@ -326,6 +358,9 @@ static uint32 vbp_utils_parse_es_buffer(vbp_context *pcontext, uint8 init_data_f
 
 	for (i = 0; i < cxt->list.num_items; i++)
 	{
+		/* setup buffer pointer, the previous list item may have been read from the unescaped copy */
+		cxt->getbits.bstrm_buf.buf = cxt->parse_cubby.buf;
+
 		/* setup bitstream parser */
 		cxt->getbits.bstrm_buf.buf_index = cxt->list.data[i].stpos;
 		cxt->getbits.bstrm_buf.buf_st = cxt->list.data[i].stpos;
@@ -337,7 +372,9 @@ static uint32 vbp_utils_parse_es_buffer(vbp_context *pcontext, uint8 init_data_f
 		cxt->getbits.au_pos = 0;    
     	cxt->getbits.list_off = 0;
     	cxt->getbits.phase = 0;
-    	cxt->getbits.emulation_byte_counter = 0;
+
+		/* emulation prevention bytes are removed before the list item is read */
+		viddec_pm_utils_bstream_init_rbsp(&(cxt->getbits));
 
 		cxt->list.start_offset = cxt->list.data[i].stpos;
 		cxt->list.end_offset = cxt->list.data[i].edpos;
@@ -489,7 +526,7 @@ uint32 vbp_utils_parse_buffer(vbp_context *pcontext, uint8 *data, uint32 size,
 
 	uint32 error = VBP_OK;
 
-	/* ITRACE("buffer counter: %d",buffer_counter);  */
+	/* ITRACE("buffer counter: %d", pcontext->buffer_counter);  */
 
 	/* set up emitter. */
 	pcontext->parser_cxt->emitter.cur.data = pcontext->workload1;
@@ -504,12 +541,18 @@ uint32 vbp_utils_parse_buffer(vbp_context *pcontext, uint8 *data, uint32 size,
 	pcontext->parser_cxt->parse_cubby.size = size;
 	pcontext->parser_cxt->parse_cubby.phase = 0;
 
+	error = vbp_utils_allocate_rbsp(pcontext, size);
+	if (VBP_OK != error)
+	{
+		return error;
+	}
+
 	error = vbp_utils_parse_es_buffer(pcontext, init_data_flag);
 
 	/* rolling count of buffers. */
 	if (0 == init_data_flag)
 	{
-		buffer_counter++;
+		pcontext->buffer_counter++;
 	}
 	return error;
 }
@@ -26,9 +26,6 @@
 
 extern uint32 viddec_parse_sc(void *in, void *pcxt, void *sc_state);
 
-/* rolling counter of sample buffer */
-extern uint32 buffer_counter;
-
 typedef struct vbp_context_t vbp_context;
 
 typedef uint32 (*function_init_parser_entries)(vbp_context* cxt);
@@ -67,6 +64,12 @@ struct vbp_context_t
 	/* format specific query data */
 	void *query_data;
 
+	/* rolling counter of sample buffer */
+	uint32 buffer_counter;
+
+	/* number of bytes used to encode length of NAL payload (H.264 only) */
+	int NAL_length_size;
+
 	
 	function_init_parser_entries 	func_init_parser_entries;
 	function_allocate_query_data 	func_allocate_query_data;
@@ -17,7 +17,7 @@
 #include "vbp_vc1_parser.h"
 
 /* maximum number of Macroblock divided by 2, see va.h */
-#define MAX_BITPLANE_SIZE 16384
+#define MAX_BITPLANE_SIZE MAX_PACKED_BITPLANE_SZ
 
 /* Start code prefix is 001 which is 3 bytes. */
 #define PREFIX_SIZE 3
@@ -413,79 +413,6 @@ uint32_t vbp_parse_start_code_vc1(vbp_context *pcontext)
 }
 
 
-/**
- *
- */
-static inline uint8 vbp_get_bit_vc1(uint32 *data, uint32 *current_word, uint32 *current_bit)
-{
-	uint8 value;
-
-	value = (data[*current_word] >> *current_bit) & 1;
-
-	/* Fix up bit/byte offsets.  endianess?? */
-	if (*current_bit < 31)
-	{
-		++(*current_bit);
-	}
-	else
-	{
-		++(*current_word);
-		*current_bit = 0;
-	}
-
-	return value;
-}
-
-
-/**
- *
- */
-static uint32 vbp_pack_bitplane_vc1(
-	uint32 *from_plane, 
-	uint8 *to_plane,
-	uint32 width, 
-	uint32 height, 
-	uint32 nibble_shift)
-{
-	uint32 error = VBP_OK;
-	uint32 current_word = 0;
-	uint32 current_bit = 0;  /* must agree with number in vbp_get_bit_vc1 */
-	uint32 i, j, n;
-	uint8 value;
-	uint32 stride = 0;
-
-	stride = 32 * ((width + 31) / 32);
-
-	for (i = 0, n = 0; i < height; i++)
-	{
-		for (j = 0; j < stride; j++)
-		{
-			if (j < width)
-			{
-				value = vbp_get_bit_vc1(
-					from_plane, 
-					&current_word, 
-					&current_bit);
-
-				to_plane[n / 2] |= value << (nibble_shift + ((n % 2) ? 0 : 4));
-				n++;
-			}
-			else
-			{
-				break;
-			}
-		}
-		if (stride > width)
-		{
-			current_word++;
-			current_bit = 0;
-		}
-	}
-
-	return error;
-}
-
-
 /**
  *
  */
@@ -527,41 +454,20 @@ static uint32 vbp_pack_bitplanes_vc1(
 	pic_data->size_bitplanes = ((seqLayerHeader->widthMB * seqLayerHeader->heightMB) + 1) / 2;
 
 
-	memset(pic_data->packed_bitplanes, 0, pic_data->size_bitplanes);
+	if (pic_data->size_bitplanes > MAX_BITPLANE_SIZE)
+	{
+		ETRACE("Bit-plane is too large.");
+		return VBP_DATA;
+	}
+
+	/* the parser has already packed the bit-planes of this picture the way libVA takes them */
+	memcpy(pic_data->packed_bitplanes, parser->bp_packed, pic_data->size_bitplanes);
 
-	/* see libva library va.h for nibble bit */
+	/* sanity check, see libva library va.h for nibble bit */
 	switch (picLayerHeader->PTYPE)
 	{
 		case VC1_I_FRAME:
 		case VC1_BI_FRAME:
-		if (picLayerHeader->OVERFLAGS.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->OVERFLAGS.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB, 
-				seqLayerHeader->heightMB,
-				2);
-		}
-		if (picLayerHeader->ACPRED.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->ACPRED.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB,
-				seqLayerHeader->heightMB, 
-				1);
-		}
-		if (picLayerHeader->FIELDTX.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->FIELDTX.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB,
-				seqLayerHeader->heightMB,
-				0);
-		}
-		/* sanity check */
 		if (picLayerHeader->MVTYPEMB.imode || 
 			picLayerHeader->DIRECTMB.imode ||
 			picLayerHeader->SKIPMB.imode || 
@@ -573,34 +479,6 @@ static uint32 vbp_pack_bitplanes_vc1(
 		break;
 
 		case VC1_P_FRAME:
-		if (picLayerHeader->MVTYPEMB.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->MVTYPEMB.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB,
-				seqLayerHeader->heightMB,
-				2);
-		}
-		if (picLayerHeader->SKIPMB.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->SKIPMB.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB,
-				seqLayerHeader->heightMB,
-				1);
-		}
-		if (picLayerHeader->DIRECTMB.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->DIRECTMB.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB,
-				seqLayerHeader->heightMB,
-				0);
-		}
-		/* sanity check */
 		if (picLayerHeader->FIELDTX.imode || 
 			picLayerHeader->FORWARDMB.imode ||
 			picLayerHeader->ACPRED.imode || 
@@ -612,34 +490,6 @@ static uint32 vbp_pack_bitplanes_vc1(
 		break;
 
 		case VC1_B_FRAME:
-		if (picLayerHeader->FORWARDMB.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->FORWARDMB.databits, 
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB, 
-				seqLayerHeader->heightMB,
-				2);
-		}
-		if (picLayerHeader->SKIPMB.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->SKIPMB.databits,
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB, 
-				seqLayerHeader->heightMB, 
-				1);
-		}
-		if (picLayerHeader->DIRECTMB.imode)
-		{
-			vbp_pack_bitplane_vc1(
-				picLayerHeader->DIRECTMB.databits, 
-				pic_data->packed_bitplanes,
-				seqLayerHeader->widthMB, 
-				seqLayerHeader->heightMB,
-				0);
-		}
-		/* sanity check */
 		if (picLayerHeader->MVTYPEMB.imode || 
 			picLayerHeader->FIELDTX.imode ||
 			picLayerHeader->ACPRED.imode || 
@@ -709,7 +559,7 @@ uint32 vbp_populate_query_data_vc1(vbp_context *pcontext)
 	se_data->LUMSHIFT2 = seqLayerHeader->LUMSHIFT2;
 
 	/* update buffer number */
-	query_data->buf_number = buffer_counter;
+	query_data->buf_number = pcontext->buffer_counter;
 
 	if (query_data->num_pictures > 2)
 	{
@@ -1,5 +1,8 @@
 #include "viddec_pm_parse.h"
 #include "viddec_fw_debug.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define FIRST_STARTCODE_BYTE        0x00
 #define SECOND_STARTCODE_BYTE       0x00
@@ -35,6 +38,34 @@ uint32_t viddec_parse_sc(void *in, void *pcxt, void *sc_state)
     /* parse until there is more data and start code not found */
     while((data_left > 0) &&(phase < 3))
     {
+#ifdef __SSE2__
+        /* Look at 16 bytes at a time: skip blocks with no start code and stop on the first one found */
+        if(phase == 0)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i third = _mm_set1_epi8(THIRD_STARTCODE_BYTE);
+            while(data_left >= 16)
+            {
+                __m128i block = _mm_loadu_si128((const __m128i *)ptr);
+                uint32_t zeros = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, zero));
+                uint32_t thirds = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, third));
+                /* bit n is set if bytes n-2, n-1 and n are 0x00 0x00 0x01 */
+                uint32_t found = thirds & (zeros << 1) & (zeros << 2);
+                if(found)
+                {/* Move to the first zero of the start code and let the byte loop below match it */
+                    uint32_t skip = __builtin_ctz(found) - 2;
+                    ptr+=skip;size+=skip;data_left-=skip;
+                    break;
+                }
+                ptr+=16;size+=16;data_left-=16;
+                if(zeros & 0x8000)
+                {/* Block ends with zero bytes which may begin a start code */
+                    phase = (zeros & 0x4000) ? 2 : 1;
+                    break;
+                }
+            }
+        }
+#endif
         /* Check if we are byte aligned & phase=0, if thats the case we can check
            work at a time instead of byte*/
         if(((((uint32_t)ptr) & 0x3) == 0) && (phase == 0))
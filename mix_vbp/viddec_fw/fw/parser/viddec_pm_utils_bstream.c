@@ -1,5 +1,11 @@
 #include "viddec_pm_utils_bstream.h"
 #include "viddec_fw_debug.h"
+#ifdef VBP
+#include <string.h>
+
+/* Smallest number of escaped bytes unescaped at a time */
+#define RBSP_CHUNK 64
+#endif
 
 /* Internal data structure for calculating required bits. */
 typedef union
@@ -18,6 +24,47 @@ static inline uint32_t viddec_pm_utils_bstream_bytesincubby(viddec_pm_utils_bstr
     return (cxt->buf_end - cxt->buf_index);
 }
 
+#ifdef VBP
+/*
+  Unescapes the current list item until there are num_bytes from buf_index or the list item ends. An emulation
+  prevention byte is 0x3 following two 0x0 bytes of the same list item. They are found with memchr and the data
+  between them is copied with memcpy, so there's no per byte work for runs without 0x3.
+*/
+static void viddec_pm_utils_bstream_unescape(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t num_bytes)
+{
+    viddec_pm_utils_bstream_rbsp_cxt_t *rbsp = &(cxt->rbsp);
+    viddec_pm_utils_bstream_buf_cxt_t *bstream = &(cxt->bstrm_buf);
+    uint8_t *esc = rbsp->esc_buf;
+
+    while(((bstream->buf_end - bstream->buf_index) < num_bytes) && (rbsp->esc_pos < rbsp->esc_end))
+    {
+        uint32_t pos = rbsp->esc_pos, end;
+        uint8_t *emul;
+
+        end = pos + ((num_bytes > RBSP_CHUNK) ? num_bytes : RBSP_CHUNK);
+        if(end > rbsp->esc_end)
+        {
+            end = rbsp->esc_end;
+        }
+        while((emul = memchr(&esc[pos], 0x3, end - pos)) != NULL)
+        {
+            pos = emul - esc;
+            if((pos >= rbsp->esc_st + 2) && (esc[pos - 1] == 0) && (esc[pos - 2] == 0))
+            {
+                memcpy(&(rbsp->buf[bstream->buf_end]), &esc[rbsp->esc_pos], pos - rbsp->esc_pos);
+                bstream->buf_end += pos - rbsp->esc_pos;
+                rbsp->emul_map[rbsp->emul_count++] = bstream->buf_end;
+                rbsp->esc_pos = pos + 1;
+            }
+            pos++;
+        }
+        memcpy(&(rbsp->buf[bstream->buf_end]), &esc[rbsp->esc_pos], end - rbsp->esc_pos);
+        bstream->buf_end += end - rbsp->esc_pos;
+        rbsp->esc_pos = end;
+    }
+}
+#endif
+
 /*
   This function checks to see if we are at the last valid byte for current access unit.
 */
@@ -26,6 +73,19 @@ uint8_t viddec_pm_utils_bstream_nomorerbspdata(viddec_pm_utils_bstream_cxt_t *cx
     uint32_t data_remaining = 0;
     uint8_t ret = false;
 
+#ifdef VBP
+    if(cxt->rbsp.enabled)
+    {
+        /* Only the end of unescaped data is the end of list item */
+        viddec_pm_utils_bstream_unescape(cxt, 3);
+        if(cxt->rbsp.esc_pos < cxt->rbsp.esc_end)
+        {
+            return ret;
+        }
+        data_remaining = cxt->bstrm_buf.buf_end - cxt->bstrm_buf.buf_index;
+    }
+    else
+#endif
     /* How much data is remaining including current byte to be processed.*/
     data_remaining = cxt->list->total_bytes - (cxt->au_pos + (cxt->bstrm_buf.buf_index - cxt->bstrm_buf.buf_st));
 
@@ -201,6 +261,11 @@ static inline void viddec_pm_utils_check_bstream_reload(viddec_pm_utils_bstream_
 {
 #ifdef VBP	
 	*data_left = viddec_pm_utils_bstream_bytesincubby(&(cxt->bstrm_buf));
+	if((*data_left < MIN_DATA) && cxt->rbsp.enabled)
+	{
+		viddec_pm_utils_bstream_unescape(cxt, MIN_DATA);
+		*data_left = viddec_pm_utils_bstream_bytesincubby(&(cxt->bstrm_buf));
+	}
 #else	
     uint8_t isReload=0;
 
@@ -331,7 +396,10 @@ void viddec_pm_utils_bstream_reload(viddec_pm_utils_bstream_cxt_t *cxt)
 void viddec_pm_utils_bstream_init(viddec_pm_utils_bstream_cxt_t *cxt, viddec_pm_utils_list_t *list, uint32_t is_emul)
 {
 #ifdef VBP
-	cxt->emulation_byte_counter = 0;
+	cxt->rbsp.enabled = 0;
+	cxt->cache = 0;
+	cxt->cache_bits = 0;
+	cxt->cache_pos = 0;
 #endif    
 
     cxt->au_pos = 0;
@@ -342,6 +410,56 @@ void viddec_pm_utils_bstream_init(viddec_pm_utils_bstream_cxt_t *cxt, viddec_pm_
     cxt->bstrm_buf.buf_st = cxt->bstrm_buf.buf_end = cxt->bstrm_buf.buf_index = cxt->bstrm_buf.buf_bitoff = 0;
 }
 
+#ifdef VBP
+/*
+  Called for each list item once bstrm_buf is set up on the escaped data. If emulation prevention is required,
+  the list item is read from rbsp.buf from here on.
+*/
+void viddec_pm_utils_bstream_init_rbsp(viddec_pm_utils_bstream_cxt_t *cxt)
+{
+    viddec_pm_utils_bstream_rbsp_cxt_t *rbsp = &(cxt->rbsp);
+    viddec_pm_utils_bstream_buf_cxt_t *bstream = &(cxt->bstrm_buf);
+
+    rbsp->enabled = cxt->is_emul_reqd;
+    if(rbsp->enabled)
+    {
+        rbsp->esc_buf = bstream->buf;
+        rbsp->esc_st = rbsp->esc_pos = bstream->buf_index;
+        rbsp->esc_end = bstream->buf_end;
+        rbsp->emul_count = 0;
+        bstream->buf = rbsp->buf;
+        bstream->buf_st = bstream->buf_index = bstream->buf_end = 0;
+    }
+    /* cache can't tell new data apart by position */
+    cxt->cache_bits = 0;
+}
+
+/*
+  Same as viddec_pm_utils_bstream_get_au_offsets for a list item read from rbsp.buf. The byte offset is mapped
+  back to the escaped data. If the next byte to read follows an emulation prevention byte, it points to that byte
+  like it did when emulation prevention was done while reading.
+*/
+void viddec_pm_utils_bstream_get_escaped_offsets(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t *bit, uint32_t *byte, uint8_t *is_emul)
+{
+    viddec_pm_utils_bstream_rbsp_cxt_t *rbsp = &(cxt->rbsp);
+    viddec_pm_utils_bstream_buf_cxt_t *bstream = &(cxt->bstrm_buf);
+    uint32_t index = bstream->buf_index, removed = 0, esc;
+
+    while((removed < rbsp->emul_count) &&
+          ((rbsp->emul_map[removed] < index) || ((rbsp->emul_map[removed] == index) && (bstream->buf_bitoff != 0))))
+    {
+        removed++;
+    }
+    *bit = bstream->buf_bitoff;
+    *byte = index + removed;
+    /* Current byte and the one before it are 0 with no emulation prevention byte between them, next one is 0x3 */
+    esc = rbsp->esc_st + *byte;
+    *is_emul = (index > 0) && (bstream->buf[index - 1] == 0) &&
+        ((removed == 0) || (rbsp->emul_map[removed - 1] != index)) &&
+        (esc + 1 < rbsp->esc_end) && (rbsp->esc_buf[esc] == 0) && (rbsp->esc_buf[esc + 1] == 0x3);
+}
+#endif
+
 /* Get the requested byte position. If the byte is already present in cubby its returned
    else we seek forward and get the requested byte.
    Limitation:Once we seek forward we can't return back.
@@ -362,11 +480,91 @@ int32_t viddec_pm_utils_bstream_get_current_byte(viddec_pm_utils_bstream_cxt_t *
     return ret;
 }
 
+#ifdef VBP
+/*
+  Loads up to 64 bits from the current position into the cache. Bits beyond buf_end are zero and not counted
+  in cache_bits.
+*/
+static inline void viddec_pm_utils_bstream_refill_cache(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t pos)
+{
+    viddec_pm_utils_bstream_buf_cxt_t *bstream = &(cxt->bstrm_buf);
+    uint8_t *ptr = &(bstream->buf[bstream->buf_index]);
+    uint32_t bytes = bstream->buf_end - bstream->buf_index;
+    uint64_t cache = 0;
+
+    if((bytes < 8) && cxt->rbsp.enabled)
+    {
+        viddec_pm_utils_bstream_unescape(cxt, 8);
+        bytes = bstream->buf_end - bstream->buf_index;
+    }
+
+    if(bytes >= 8)
+    {
+        cache = ((uint64_t)ptr[0] << 56) | ((uint64_t)ptr[1] << 48) | ((uint64_t)ptr[2] << 40) | ((uint64_t)ptr[3] << 32) |
+                ((uint64_t)ptr[4] << 24) | ((uint64_t)ptr[5] << 16) | ((uint64_t)ptr[6] << 8) | (uint64_t)ptr[7];
+        bytes = 8;
+    }
+    else
+    {
+        uint32_t i;
+        for(i=0; i<bytes; i++)
+        {
+            cache |= (uint64_t)ptr[i] << (56 - (i << 3));
+        }
+    }
+    cxt->cache = cache << bstream->buf_bitoff;
+    cxt->cache_bits = (bytes << 3) - bstream->buf_bitoff;
+    cxt->cache_pos = pos;
+}
+
+/*
+  Reads N bits ( 0 < N <= 32) from the cache. Data has no emulation prevention bytes, either because none are
+  expected or because the list item is read from rbsp.buf, so a position is just buf_index and buf_bitoff.
+  Fails like the byte reader if the bits go past the end of the list item.
+*/
+static inline int32_t viddec_pm_utils_bstream_peekbits_cached(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t *out, uint32_t num_bits, uint8_t skip)
+{
+    viddec_pm_utils_bstream_buf_cxt_t *bstream = &(cxt->bstrm_buf);
+    uint32_t pos;
+
+    if((num_bits > 32) || (num_bits == 0))
+    {
+        return -1;
+    }
+    /* position moves only through this function, anything else sets it directly and gets a refill */
+    pos = (bstream->buf_index << 3) + bstream->buf_bitoff;
+    if((pos != cxt->cache_pos) || (cxt->cache_bits < num_bits))
+    {
+        viddec_pm_utils_bstream_refill_cache(cxt, pos);
+        if(cxt->cache_bits < num_bits)
+        {
+            return -1;
+        }
+    }
+    if(out != NULL)
+    {
+        *out = (uint32_t)(cxt->cache >> (64 - num_bits));
+    }
+    if(skip)
+    {
+        cxt->cache <<= num_bits;
+        cxt->cache_bits -= num_bits;
+        cxt->cache_pos = pos + num_bits;
+        bstream->buf_index = cxt->cache_pos >> 3;
+        bstream->buf_bitoff = cxt->cache_pos & 0x7;
+    }
+    return 1;
+}
+#endif
+
 /*
   Function to skip N bits ( N<= 32).
 */
 int32_t viddec_pm_utils_bstream_skipbits(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t num_bits)
 {
+#ifdef VBP
+    return viddec_pm_utils_bstream_peekbits_cached(cxt, NULL, num_bits, 1);
+#else
     int32_t ret = -1;
     uint32_t data_left=0;
     viddec_pm_utils_bstream_buf_cxt_t *bstream;
@@ -388,15 +586,11 @@ int32_t viddec_pm_utils_bstream_skipbits(viddec_pm_utils_bstream_cxt_t *cxt, uin
                 total_bits=num_bits+bstream->buf_bitoff;
                 viddec_pm_utils_update_skipoffsets(bstream, total_bits, act_bytes);
                 ret=1;
-                
-                if (act_bytes > bytes_required)
-                {
-                	cxt->emulation_byte_counter = act_bytes - bytes_required;
-                }
             }
         }
     }
     return ret;
+#endif
 }
 
 /*
@@ -404,6 +598,9 @@ int32_t viddec_pm_utils_bstream_skipbits(viddec_pm_utils_bstream_cxt_t *cxt, uin
 */
 int32_t viddec_pm_utils_bstream_peekbits(viddec_pm_utils_bstream_cxt_t *cxt, uint32_t *out, uint32_t num_bits, uint8_t skip)
 {
+#ifdef VBP
+    return viddec_pm_utils_bstream_peekbits_cached(cxt, out, num_bits, skip);
+#else
     uint32_t data_left=0;
     int32_t ret = -1;
     /* STEP 1: Make sure that we have at least minimum data before we calculate bits */
@@ -457,11 +654,6 @@ int32_t viddec_pm_utils_bstream_peekbits(viddec_pm_utils_bstream_cxt_t *cxt, uin
                     /* update au byte position if needed */
                     viddec_pm_utils_update_skipoffsets(bstream, total_bits, act_bytes);
                     cxt->phase = phase;
-                    
-                    if (act_bytes > bytes_required)
-                    {
-                    	cxt->emulation_byte_counter += act_bytes - bytes_required;
-                    }
                 }
 
                 ret =1;
@@ -469,4 +661,5 @@ int32_t viddec_pm_utils_bstream_peekbits(viddec_pm_utils_bstream_cxt_t *cxt, uin
         }
     }
     return ret;
+#endif
 }
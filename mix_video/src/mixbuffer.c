@@ -39,6 +39,10 @@ static void mix_buffer_init(MixBuffer * self) {
 	self->reserved = priv;
 
 	priv->pool = NULL;
+	priv->pool_link.data = self;
+	priv->pool_link.next = NULL;
+	priv->pool_link.prev = NULL;
+	priv->in_use = FALSE;
 
 	self->data = NULL;
 	self->size = 0;
@@ -18,6 +18,8 @@ struct _MixBufferPrivate
 {
   /*< private > */
   MixBufferPool *pool;
+  GList pool_link;	/* node in the free or in use queue of the pool */
+  gboolean in_use;	/* pool_link is in the in use queue */
 
 };
 
@@ -22,6 +22,10 @@
 
 #define SAFE_FREE(p) if(p) { g_free(p); p = NULL; }
 
+/* queue node embedded in the private data of a pooled buffer */
+#define MIX_BUFFER_POOL_LINK(buffer) \
+	(&((MixBufferPrivate *) (buffer)->reserved)->pool_link)
+
 static GType _mix_bufferpool_type = 0;
 static MixParamsClass *parent_class = NULL;
 
@@ -37,8 +41,8 @@ G_DEFINE_TYPE_WITH_CODE (MixBufferPool, mix_bufferpool, MIX_TYPE_PARAMS,
 
 static void mix_bufferpool_init(MixBufferPool * self) {
 	/* initialize properties here */
-	self->free_list = NULL;
-	self->in_use_list = NULL;
+	self->free_list = g_queue_new();
+	self->in_use_list = g_queue_new();
 	self->free_list_max_size = 0;
 	self->high_water_mark = 0;
 
@@ -77,6 +81,22 @@ void mix_bufferpool_finalize(MixParams * obj) {
 
 	MixBufferPool *self = MIX_BUFFERPOOL(obj);
 
+	/* the nodes belong to the buffers, unlink them so that only the
+	 * queue heads are freed here */
+	if (self->free_list) {
+		while (g_queue_pop_head_link(self->free_list))
+			;
+		g_queue_free(self->free_list);
+		self->free_list = NULL;
+	}
+
+	if (self->in_use_list) {
+		while (g_queue_pop_head_link(self->in_use_list))
+			;
+		g_queue_free(self->in_use_list);
+		self->in_use_list = NULL;
+	}
+
 	if (self->objectlock) {
 		g_mutex_free(self->objectlock);
 		self->objectlock = NULL;
@@ -143,9 +163,8 @@ gboolean mix_bufferpool_copy(MixParams * target, const MixParams * src) {
 
 		// Free the existing properties
 
-		// Duplicate string
-		this_target->free_list = this_src->free_list;
-		this_target->in_use_list = this_src->in_use_list;
+		// The queues are not shared; their nodes are owned by the pooled
+		// buffers and each buffer belongs to one pool only
 		this_target->free_list_max_size = this_src->free_list_max_size;
 		this_target->high_water_mark = this_src->high_water_mark;
 
@@ -213,8 +232,10 @@ gboolean mix_bufferpool_equal(MixParams * first, MixParams * second) {
  * mix_bufferpool_initialize:
  * @returns: MIX_RESULT_SUCCESS if successful in creating the buffer pool
  *
- * Use this method to create a new buffer pool, consisting of a GSList of
- * buffer objects that represents a pool of buffers.
+ * Use this method to create a new buffer pool, consisting of a GQueue of
+ * buffer objects that represents a pool of buffers. The queue nodes are
+ * embedded in the buffers, so moving a buffer between the free and in use
+ * queues never allocates.
  */
 MIX_RESULT mix_bufferpool_initialize(MixBufferPool * obj, guint num_buffers) {
 
@@ -225,7 +246,8 @@ MIX_RESULT mix_bufferpool_initialize(MixBufferPool * obj, guint num_buffers) {
 
 	MIX_LOCK(obj->objectlock);
 
-	if ((obj->free_list != NULL) || (obj->in_use_list != NULL)) {
+	if (!g_queue_is_empty(obj->free_list)
+			|| !g_queue_is_empty(obj->in_use_list)) {
 		//buffer pool is in use; return error; need proper cleanup
 		//TODO need cleanup here?
 
@@ -235,10 +257,6 @@ MIX_RESULT mix_bufferpool_initialize(MixBufferPool * obj, guint num_buffers) {
 	}
 
 	if (num_buffers == 0) {
-		obj->free_list = NULL;
-
-		obj->in_use_list = NULL;
-
 		obj->free_list_max_size = num_buffers;
 
 		obj->high_water_mark = 0;
@@ -269,12 +287,10 @@ MIX_RESULT mix_bufferpool_initialize(MixBufferPool * obj, guint num_buffers) {
 		mix_buffer_set_pool(buffer, obj);
 
 		//Add each MixBuffer object to the pool list
-		obj->free_list = g_slist_append(obj->free_list, buffer);
+		g_queue_push_tail_link(obj->free_list, MIX_BUFFER_POOL_LINK(buffer));
 
 	}
 
-	obj->in_use_list = NULL;
-
 	obj->free_list_max_size = num_buffers;
 
 	obj->high_water_mark = 0;
@@ -299,31 +315,21 @@ MIX_RESULT mix_bufferpool_put(MixBufferPool * obj, MixBuffer * buffer) {
 
 	MIX_LOCK(obj->objectlock);
 
-	if (obj->in_use_list == NULL) {
-		//in use list cannot be empty if a buffer is in use
-		//TODO need better error code for this
-
-		MIX_UNLOCK(obj->objectlock);
-
-		return MIX_RESULT_FAIL;
-	}
-
-	GSList *element = g_slist_find(obj->in_use_list, buffer);
-	if (element == NULL) {
+	MixBufferPrivate *priv = (MixBufferPrivate *) buffer->reserved;
+	if (priv->pool != obj || !priv->in_use) {
 		//Integrity error; buffer not found in in use list
 		//TODO need better error code and handling for this
 
 		MIX_UNLOCK(obj->objectlock);
 
 		return MIX_RESULT_FAIL;
-	} else {
-		//Remove this element from the in_use_list
-		obj->in_use_list = g_slist_remove_link(obj->in_use_list, element);
-
-		//Concat the element to the free_list
-		obj->free_list = g_slist_concat(obj->free_list, element);
 	}
 
+	//Move the buffer's own node from the in_use_list to the free_list
+	g_queue_unlink(obj->in_use_list, &priv->pool_link);
+	g_queue_push_tail_link(obj->free_list, &priv->pool_link);
+	priv->in_use = FALSE;
+
 	//Note that we do nothing with the ref count for this.  We want it to
 	//stay at 1, which is what triggered it to be added back to the free list.
 
@@ -345,7 +351,7 @@ MIX_RESULT mix_bufferpool_get(MixBufferPool * obj, MixBuffer ** buffer) {
 
 	MIX_LOCK(obj->objectlock);
 
-	if (obj->free_list == NULL) {
+	if (g_queue_is_empty(obj->free_list)) {
 		//We are out of buffers
 		//TODO need to log this as well
 
@@ -357,33 +363,25 @@ MIX_RESULT mix_bufferpool_get(MixBufferPool * obj, MixBuffer ** buffer) {
 	//Remove a buffer from the free pool
 
 	//We just remove the one at the head, since it's convenient
-	GSList *element = obj->free_list;
-	obj->free_list = g_slist_remove_link(obj->free_list, element);
-	if (element == NULL) {
-		//Unexpected behavior
-		//TODO need better error code and handling for this
+	GList *element = g_queue_pop_head_link(obj->free_list);
 
-		MIX_UNLOCK(obj->objectlock);
+	//Add the element to the in_use_list
+	g_queue_push_tail_link(obj->in_use_list, element);
+	((MixBufferPrivate *) MIX_BUFFER(element->data)->reserved)->in_use = TRUE;
 
-		return MIX_RESULT_FAIL;
-	} else {
-		//Concat the element to the in_use_list
-		obj->in_use_list = g_slist_concat(obj->in_use_list, element);
+	//TODO replace with proper logging
 
-		//TODO replace with proper logging
+	LOG_I( "buffer refcount%d\n",
+			MIX_PARAMS(element->data)->refcount);
 
-		LOG_I( "buffer refcount%d\n",
-				MIX_PARAMS(element->data)->refcount);
+	//Set the out buffer pointer
+	*buffer = (MixBuffer *) element->data;
 
-		//Set the out buffer pointer
-		*buffer = (MixBuffer *) element->data;
-
-		//Check the high water mark for buffer use
-		guint size = g_slist_length(obj->in_use_list);
-		if (size > obj->high_water_mark)
-			obj->high_water_mark = size;
-		//TODO Log this high water mark
-	}
+	//Check the high water mark for buffer use
+	guint size = g_queue_get_length(obj->in_use_list);
+	if (size > obj->high_water_mark)
+		obj->high_water_mark = size;
+	//TODO Log this high water mark
 
 	//Increment the reference count for the buffer
 	mix_buffer_ref(*buffer);
@@ -405,8 +403,8 @@ MIX_RESULT mix_bufferpool_deinitialize(MixBufferPool * obj) {
 
 	MIX_LOCK(obj->objectlock);
 
-	if ((obj->in_use_list != NULL) || (g_slist_length(obj->free_list)
-			!= obj->free_list_max_size)) {
+	if (!g_queue_is_empty(obj->in_use_list) || (g_queue_get_length(
+			obj->free_list) != obj->free_list_max_size)) {
 		//TODO better error code
 		//We have outstanding buffer objects in use and they need to be
 		//freed before we can deinitialize.
@@ -420,17 +418,14 @@ MIX_RESULT mix_bufferpool_deinitialize(MixBufferPool * obj) {
 
 	MixBuffer *buffer = NULL;
 
-	while (obj->free_list != NULL) {
-		//Get the buffer object from the head of the list
-		buffer = obj->free_list->data;
-		//buffer = g_slist_nth_data(obj->free_list, 0);
+	while (!g_queue_is_empty(obj->free_list)) {
+		//Unlink the buffer's node from the head of the queue; the node
+		//is part of the buffer and goes away with it
+		buffer = g_queue_pop_head_link(obj->free_list)->data;
 
 		//Release it
 		mix_buffer_unref(buffer);
 
-		//Delete the head node of the list and store the new head
-		obj->free_list = g_slist_delete_link(obj->free_list, obj->free_list);
-
 		//Repeat until empty
 	}
 
@@ -467,17 +462,17 @@ mix_bufferpool_dumpprint (MixBufferPool * obj)
 	//TODO replace this with proper logging later
 
 	LOG_I( "BUFFER POOL DUMP:\n");
-	LOG_I( "Free list size is %d\n", g_slist_length(obj->free_list));
-	LOG_I( "In use list size is %d\n", g_slist_length(obj->in_use_list));
+	LOG_I( "Free list size is %d\n", g_queue_get_length(obj->free_list));
+	LOG_I( "In use list size is %d\n", g_queue_get_length(obj->in_use_list));
 	LOG_I( "High water mark is %lu\n", obj->high_water_mark);
 
 	//Walk the free list and report the contents
 	LOG_I( "Free list contents:\n");
-	g_slist_foreach(obj->free_list, (GFunc) mix_bufferpool_dumpbuffer, NULL);
+	g_queue_foreach(obj->free_list, (GFunc) mix_bufferpool_dumpbuffer, NULL);
 
 	//Walk the in_use list and report the contents
 	LOG_I( "In Use list contents:\n");
-	g_slist_foreach(obj->in_use_list, (GFunc) mix_bufferpool_dumpbuffer, NULL);
+	g_queue_foreach(obj->in_use_list, (GFunc) mix_bufferpool_dumpbuffer, NULL);
 
 	return MIX_RESULT_SUCCESS;
 }
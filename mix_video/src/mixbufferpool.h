@@ -74,8 +74,8 @@ struct _MixBufferPool
   MixParams parent;
 
   /*< public > */
-  GSList *free_list;		/* list of free buffers */
-  GSList *in_use_list;		/* list of buffers in use */
+  GQueue *free_list;		/* queue of free buffers */
+  GQueue *in_use_list;		/* queue of buffers in use */
   gulong free_list_max_size;	/* initial size of the free list */
   gulong high_water_mark;	/* most buffers in use at one time */
 
@@ -11,9 +11,20 @@
 #include "mixframemanager.h"
 #include "mixvideoframe_private.h"
 
-#define INITIAL_FRAME_ARRAY_SIZE 	16
+#define INITIAL_FRAME_HEAP_SIZE 	16
 #define MIX_SECOND  (G_USEC_PER_SEC * G_GINT64_CONSTANT (1000))
 
+/*
+ * Element of frame_heap. The timestamp is cached so that sifting does not
+ * go through the frame accessors.
+ */
+typedef struct _MixFrameHeapEntry MixFrameHeapEntry;
+
+struct _MixFrameHeapEntry {
+	guint64 timestamp;
+	MixVideoFrame *frame;
+};
+
 static GObjectClass *parent_class = NULL;
 
 static void mix_framemanager_finalize(GObject * obj);
@@ -32,7 +43,7 @@ static void mix_framemanager_init(MixFrameManager * self) {
 
 	self->flushing = FALSE;
 	self->eos = FALSE;
-	self->frame_array = NULL;
+	self->frame_heap = NULL;
 	self->frame_queue = NULL;
 	self->initialized = FALSE;
 
@@ -116,8 +127,9 @@ MIX_RESULT mix_framemanager_initialize(MixFrameManager *fm,
 	}
 
 	if (mode == MIX_FRAMEORDER_MODE_DISPLAYORDER) {
-		fm->frame_array = g_ptr_array_sized_new(INITIAL_FRAME_ARRAY_SIZE);
-		if (!fm->frame_array) {
+		fm->frame_heap = g_array_sized_new(FALSE, FALSE,
+				sizeof(MixFrameHeapEntry), INITIAL_FRAME_HEAP_SIZE);
+		if (!fm->frame_heap) {
 			goto cleanup;
 		}
 	}
@@ -143,9 +155,9 @@ MIX_RESULT mix_framemanager_initialize(MixFrameManager *fm,
 	cleanup:
 
 	if (ret != MIX_RESULT_SUCCESS) {
-		if (fm->frame_array) {
-			g_ptr_array_free(fm->frame_array, TRUE);
-			fm->frame_array = NULL;
+		if (fm->frame_heap) {
+			g_array_free(fm->frame_heap, TRUE);
+			fm->frame_heap = NULL;
 		}
 		if (fm->frame_queue) {
 			g_queue_free(fm->frame_queue);
@@ -172,9 +184,9 @@ MIX_RESULT mix_framemanager_deinitialize(MixFrameManager *fm) {
 
 	g_mutex_lock(fm->lock);
 
-	if (fm->frame_array) {
-		g_ptr_array_free(fm->frame_array, TRUE);
-		fm->frame_array = NULL;
+	if (fm->frame_heap) {
+		g_array_free(fm->frame_heap, TRUE);
+		fm->frame_heap = NULL;
 	}
 	if (fm->frame_queue) {
 		g_queue_free(fm->frame_queue);
@@ -261,158 +273,154 @@ MIX_RESULT mix_framemanager_get_frame_order_mode(MixFrameManager *fm,
 	return MIX_RESULT_SUCCESS;
 }
 
-MIX_RESULT mix_framemanager_flush(MixFrameManager *fm) {
+/*
+ * frame_heap is a binary min-heap on timestamp stored in a GArray, so
+ * finding the earliest waiting frame is O(1) and adding or removing a
+ * frame is O(log n).
+ */
 
-	if (!MIX_IS_FRAMEMANAGER(fm)) {
-		return MIX_RESULT_INVALID_PARAM;
-	}
+static void push_frame_into_heap(GArray *heap, MixVideoFrame *mvf,
+		guint64 timestamp) {
 
-	if (!fm->initialized) {
-		return MIX_RESULT_NOT_INIT;
+	MixFrameHeapEntry entry;
+	MixFrameHeapEntry *entries = NULL;
+	guint idx = 0;
+
+	if (!heap || !mvf) {
+		return;
 	}
 
-	g_mutex_lock(fm->lock);
+	entry.timestamp = timestamp;
+	entry.frame = mvf;
 
-	/* flush frame_array */
-	if (fm->frame_array) {
-		guint len = fm->frame_array->len;
-		if (len) {
-			guint idx = 0;
-			MixVideoFrame *frame = NULL;
-			for (idx = 0; idx < len; idx++) {
-				frame = (MixVideoFrame *) g_ptr_array_index(fm->frame_array,
-						idx);
-				if (frame) {
-					mix_videoframe_unref(frame);
-					g_ptr_array_index(fm->frame_array, idx) = NULL;
-				}
-			}
-			/* g_ptr_array_remove_range(fm->frame_array, 0, len); */
+	/* grow by one and sift the hole up from the new leaf */
+	g_array_set_size(heap, heap->len + 1);
+	entries = (MixFrameHeapEntry *) heap->data;
+	idx = heap->len - 1;
+	while (idx > 0) {
+		guint parent = (idx - 1) / 2;
+		if (entries[parent].timestamp <= timestamp) {
+			break;
 		}
+		entries[idx] = entries[parent];
+		idx = parent;
 	}
+	entries[idx] = entry;
+}
 
-	if (fm->frame_queue) {
-		guint len = fm->frame_queue->length;
-		if (len) {
-			MixVideoFrame *frame = NULL;
-			while ((frame = (MixVideoFrame *) g_queue_pop_head(fm->frame_queue))) {
-				mix_videoframe_unref(frame);
+static MixVideoFrame *pop_frame_from_heap(GArray *heap, guint64 *timestamp) {
+
+	MixFrameHeapEntry *entries = NULL;
+	MixFrameHeapEntry last;
+	MixVideoFrame *frame = NULL;
+	guint len = 0;
+	guint idx = 0;
+
+	if (!heap || !heap->len) {
+		return NULL;
+	}
+
+	entries = (MixFrameHeapEntry *) heap->data;
+	frame = entries[0].frame;
+	if (timestamp) {
+		*timestamp = entries[0].timestamp;
+	}
+
+	/* move the last leaf into the root and sift it down */
+	len = heap->len - 1;
+	last = entries[len];
+	g_array_set_size(heap, len);
+	if (len) {
+		while (2 * idx + 1 < len) {
+			guint child = 2 * idx + 1;
+			if (child + 1 < len && entries[child + 1].timestamp
+					< entries[child].timestamp) {
+				child++;
+			}
+			if (last.timestamp <= entries[child].timestamp) {
+				break;
 			}
+			entries[idx] = entries[child];
+			idx = child;
 		}
+		entries[idx] = last;
 	}
 
-	if(fm->p_frame) {
-		mix_videoframe_unref(fm->p_frame);
-		fm->p_frame = NULL;
-	}
-	fm->prev_timestamp = 0;
+	return frame;
+}
 
-	fm->eos = FALSE;
+static void clear_frame_heap(GArray *heap) {
 
-	fm->is_first_frame = TRUE;
+	guint idx = 0;
 
-	g_mutex_unlock(fm->lock);
+	if (!heap) {
+		return;
+	}
 
-	return MIX_RESULT_SUCCESS;
+	for (idx = 0; idx < heap->len; idx++) {
+		mix_videoframe_unref(g_array_index(heap, MixFrameHeapEntry, idx).frame);
+	}
+	g_array_set_size(heap, 0);
 }
 
-MixVideoFrame *get_expected_frame_from_array(GPtrArray *array,
+MixVideoFrame *get_expected_frame_from_heap(GArray *heap,
 		guint64 expected, guint64 tolerance, guint64 *frametimestamp) {
 
-	guint idx = 0;
-	guint len = 0;
-	guint64 timestamp = 0;
-	guint64 lowest_timestamp = (guint64)-1;
-	guint lowest_timestamp_idx = -1;
-	
-	MixVideoFrame *frame = NULL;
-
-	if (!array || !expected || !tolerance || !frametimestamp || expected < tolerance) {
+	if (!heap || !expected || !tolerance || !frametimestamp || expected < tolerance) {
 
 		return NULL;
 	}
 
-	len = array->len;
-	if (!len) {
+	if (!heap->len) {
 		return NULL;
 	}
 
-	for (idx = 0; idx < len; idx++) {
-		MixVideoFrame *_frame = (MixVideoFrame *) g_ptr_array_index(array, idx);
-		if (_frame) {
-
-			if (mix_videoframe_get_timestamp(_frame, &timestamp)
-					!= MIX_RESULT_SUCCESS) {
-
-				/*
-				 * Oops, this shall never happen!
-				 * In case it heppens, release the frame!
-				 */
-
-				mix_videoframe_unref(_frame);
-
-				/* make an available slot */
-				g_ptr_array_index(array, idx) = NULL;
-
-				break;
-			}
-			
-			if (lowest_timestamp > timestamp)
-			{
-				lowest_timestamp = timestamp;
-				lowest_timestamp_idx = idx;
-			}
-		}
-	}
-	
-	if (lowest_timestamp == (guint64)-1)
-	{
+	/* check if the earliest frame is the expected next frame */
+	if (g_array_index(heap, MixFrameHeapEntry, 0).timestamp > expected + tolerance) {
 		return NULL;
 	}
-		
-
-	/* check if this is the expected next frame */
-	if (lowest_timestamp <= expected + tolerance)
-	{
-		MixVideoFrame *_frame = (MixVideoFrame *) g_ptr_array_index(array, lowest_timestamp_idx);
-		/* make this slot available */
-		g_ptr_array_index(array, lowest_timestamp_idx) = NULL;
 
-		*frametimestamp = lowest_timestamp;
-		frame = _frame;
-	}
-	
-	return frame;
+	return pop_frame_from_heap(heap, frametimestamp);
 }
 
-void add_frame_into_array(GPtrArray *array, MixVideoFrame *mvf) {
+MIX_RESULT mix_framemanager_flush(MixFrameManager *fm) {
 
-	gboolean found_slot = FALSE;
-	guint len = 0;
+	if (!MIX_IS_FRAMEMANAGER(fm)) {
+		return MIX_RESULT_INVALID_PARAM;
+	}
 
-	if (!array || !mvf) {
-		return;
+	if (!fm->initialized) {
+		return MIX_RESULT_NOT_INIT;
 	}
 
-	/* do we have slot for this frame? */
-	len = array->len;
-	if (len) {
-		guint idx = 0;
-		gpointer frame = NULL;
-		for (idx = 0; idx < len; idx++) {
-			frame = g_ptr_array_index(array, idx);
-			if (!frame) {
-				found_slot = TRUE;
-				g_ptr_array_index(array, idx) = (gpointer) mvf;
-				break;
+	g_mutex_lock(fm->lock);
+
+	/* flush frame_heap */
+	clear_frame_heap(fm->frame_heap);
+
+	if (fm->frame_queue) {
+		guint len = fm->frame_queue->length;
+		if (len) {
+			MixVideoFrame *frame = NULL;
+			while ((frame = (MixVideoFrame *) g_queue_pop_head(fm->frame_queue))) {
+				mix_videoframe_unref(frame);
 			}
 		}
 	}
 
-	if (!found_slot) {
-		g_ptr_array_add(array, (gpointer) mvf);
+	if(fm->p_frame) {
+		mix_videoframe_unref(fm->p_frame);
+		fm->p_frame = NULL;
 	}
+	fm->prev_timestamp = 0;
+
+	fm->eos = FALSE;
+
+	fm->is_first_frame = TRUE;
 
+	g_mutex_unlock(fm->lock);
+
+	return MIX_RESULT_SUCCESS;
 }
 
 MIX_RESULT mix_framemanager_timestamp_based_enqueue(MixFrameManager *fm,
@@ -423,12 +431,12 @@ MIX_RESULT mix_framemanager_timestamp_based_enqueue(MixFrameManager *fm,
 	 * if this is the first frame, we always push it into
 	 * output queue, if it is not, check if it is the one
 	 * expected, if yes, push it into the output queue.
-	 * if not, put it into waiting list.
+	 * if not, put it into waiting heap.
 	 *
 	 * while the expected frame is pushed into output queue,
 	 * the expected next timestamp is also updated. with this
-	 * updated expected next timestamp, we search for expected
-	 * frame from the waiting list, if found, repeat the process.
+	 * updated expected next timestamp, we check the earliest
+	 * frame in the waiting heap, if expected, repeat the process.
 	 *
 	 */
 
@@ -464,8 +472,8 @@ MIX_RESULT mix_framemanager_timestamp_based_enqueue(MixFrameManager *fm,
 
 		/* calculate tolerance */
 		guint64 tolerance = fm->frame_timestamp_delta / 4;
-		MixVideoFrame *frame_from_array = NULL;
-		guint64 timestamp_frame_array = 0;
+		MixVideoFrame *frame_from_heap = NULL;
+		guint64 timestamp_frame_heap = 0;
 
 		/*
 		* timestamp may be associated with the second field, which
@@ -489,21 +497,21 @@ MIX_RESULT mix_framemanager_timestamp_based_enqueue(MixFrameManager *fm,
 			
 			/*
 			 * since we updated next_frame_timestamp, there might be a frame
-			 * in the frame_array that satisfying this new next_frame_timestamp
+			 * in the frame_heap that satisfying this new next_frame_timestamp
 			 */
 
-			while ((frame_from_array = get_expected_frame_from_array(
-					fm->frame_array, fm->next_frame_timestamp, tolerance,
-					&timestamp_frame_array))) {
+			while ((frame_from_heap = get_expected_frame_from_heap(
+					fm->frame_heap, fm->next_frame_timestamp, tolerance,
+					&timestamp_frame_heap))) {
 
-				g_queue_push_tail(fm->frame_queue, (gpointer) frame_from_array);
+				g_queue_push_tail(fm->frame_queue, (gpointer) frame_from_heap);
 				
 				/*
 			 	* update next_frame_timestamp only if it falls within the tolerance range
 			 	*/				
-				if (timestamp_frame_array >= fm->next_frame_timestamp - tolerance)
+				if (timestamp_frame_heap >= fm->next_frame_timestamp - tolerance)
 				{
-					fm->next_frame_timestamp = timestamp_frame_array
+					fm->next_frame_timestamp = timestamp_frame_heap
 							+ fm->frame_timestamp_delta;
 				}
 			}
@@ -520,24 +528,12 @@ MIX_RESULT mix_framemanager_timestamp_based_enqueue(MixFrameManager *fm,
 			}
 
 			/*
-			 * If this is a frame with discontinuity flag set, clear frame_array
+			 * If this is a frame with discontinuity flag set, clear frame_heap
 			 * and treat the frame as the first frame.
 			 */
 			if (discontinuity) {
 
-				guint len = fm->frame_array->len;
-				if (len) {
-					guint idx = 0;
-					MixVideoFrame *frame = NULL;
-					for (idx = 0; idx < len; idx++) {
-						frame = (MixVideoFrame *) g_ptr_array_index(
-								fm->frame_array, idx);
-						if (frame) {
-							mix_videoframe_unref(frame);
-							g_ptr_array_index(fm->frame_array, idx) = NULL;
-						}
-					}
-				}
+				clear_frame_heap(fm->frame_heap);
 
 				fm->is_first_frame = TRUE;
 				goto first_frame;
@@ -549,29 +545,29 @@ MIX_RESULT mix_framemanager_timestamp_based_enqueue(MixFrameManager *fm,
 			 * 
 			 */
 			guint64 tolerance = fm->frame_timestamp_delta / 4;
-			MixVideoFrame *frame_from_array = NULL;
-			guint64 timestamp_frame_array = 0;
+			MixVideoFrame *frame_from_heap = NULL;
+			guint64 timestamp_frame_heap = 0;
 
-			while ((frame_from_array = get_expected_frame_from_array(
-					fm->frame_array, timestamp, tolerance,
-					&timestamp_frame_array)))
+			while ((frame_from_heap = get_expected_frame_from_heap(
+					fm->frame_heap, timestamp, tolerance,
+					&timestamp_frame_heap)))
 			{
-				g_queue_push_tail(fm->frame_queue, (gpointer) frame_from_array);
+				g_queue_push_tail(fm->frame_queue, (gpointer) frame_from_heap);
 				
 				/*
 			 	* update next_frame_timestamp only if it falls within the tolerance range
 			 	*/				
-				if (timestamp_frame_array >= fm->next_frame_timestamp - tolerance)
+				if (timestamp_frame_heap >= fm->next_frame_timestamp - tolerance)
 				{
-					fm->next_frame_timestamp = timestamp_frame_array
+					fm->next_frame_timestamp = timestamp_frame_heap
 							+ fm->frame_timestamp_delta;
 				}
 			}
 			/*
-			 * this is not the expected frame, put it into frame_array
+			 * this is not the expected frame, put it into frame_heap
 			 */					
 
-			add_frame_into_array(fm->frame_array, mvf);
+			push_frame_into_heap(fm->frame_heap, mvf, timestamp);
 		}
 	}
 	cleanup:
@@ -773,3 +769,45 @@ MIX_RESULT mix_framemanager_eos(MixFrameManager *fm) {
 	return ret;
 }
 
+
+MIX_RESULT mix_framemanager_dequeue_batch(MixFrameManager *fm,
+		MixVideoFrame **mvf, guint max_frames, guint *num_frames) {
+
+	MIX_RESULT ret = MIX_RESULT_FAIL;
+	guint count = 0;
+
+	if (!MIX_IS_FRAMEMANAGER(fm)) {
+		return MIX_RESULT_INVALID_PARAM;
+	}
+
+	if (!mvf || !max_frames || !num_frames) {
+		return MIX_RESULT_INVALID_PARAM;
+	}
+
+	if (!fm->initialized) {
+		return MIX_RESULT_NOT_INIT;
+	}
+
+	g_mutex_lock(fm->lock);
+
+	while (count < max_frames) {
+		mvf[count] = (MixVideoFrame *) g_queue_pop_head(fm->frame_queue);
+		if (!mvf[count]) {
+			break;
+		}
+		count++;
+	}
+
+	ret = MIX_RESULT_FRAME_NOTAVAIL;
+	if (count) {
+		ret = MIX_RESULT_SUCCESS;
+	} else if (fm->eos) {
+		ret = MIX_RESULT_EOS;
+	}
+
+	g_mutex_unlock(fm->lock);
+
+	*num_frames = count;
+
+	return ret;
+}
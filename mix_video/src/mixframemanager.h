@@ -38,7 +38,7 @@ struct _MixFrameManager {
 	gboolean eos;
 
 	GMutex *lock;
-	GPtrArray *frame_array;
+	GArray *frame_heap;	/* frames waiting for display, min-heap on timestamp */
 	GQueue *frame_queue;
 
 	gint framerate_numerator;
@@ -155,6 +155,13 @@ MIX_RESULT mix_framemanager_enqueue(MixFrameManager *fm, MixVideoFrame *mvf);
  */
 MIX_RESULT mix_framemanager_dequeue(MixFrameManager *fm, MixVideoFrame **mvf);
 
+/*
+ * Dequeue up to max_frames ready MixVideoFrames with one lock acquisition.
+ * num_frames is set to the number of frames stored in mvf.
+ */
+MIX_RESULT mix_framemanager_dequeue_batch(MixFrameManager *fm,
+		MixVideoFrame **mvf, guint max_frames, guint *num_frames);
+
 /*
  * End of stream.
  */
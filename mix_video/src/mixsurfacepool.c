@@ -22,6 +22,10 @@
 
 #define SAFE_FREE(p) if(p) { g_free(p); p = NULL; }
 
+/* queue node embedded in the private data of a pooled frame */
+#define MIX_VIDEOFRAME_POOL_LINK(frame) \
+	(&((MixVideoFramePrivate *) (frame)->reserved1)->pool_link)
+
 static GType _mix_surfacepool_type = 0;
 static MixParamsClass *parent_class = NULL;
 
@@ -37,8 +41,8 @@ G_DEFINE_TYPE_WITH_CODE (MixSurfacePool, mix_surfacepool, MIX_TYPE_PARAMS,
 
 static void mix_surfacepool_init(MixSurfacePool * self) {
 	/* initialize properties here */
-	self->free_list = NULL;
-	self->in_use_list = NULL;
+	self->free_list = g_queue_new();
+	self->in_use_list = g_queue_new();
 	self->free_list_max_size = 0;
 	self->free_list_cur_size = 0;
 	self->high_water_mark = 0;
@@ -78,6 +82,22 @@ void mix_surfacepool_finalize(MixParams * obj) {
 
 	MixSurfacePool *self = MIX_SURFACEPOOL(obj);
 
+	/* the nodes belong to the frames, unlink them so that only the
+	 * queue heads are freed here */
+	if (self->free_list) {
+		while (g_queue_pop_head_link(self->free_list))
+			;
+		g_queue_free(self->free_list);
+		self->free_list = NULL;
+	}
+
+	if (self->in_use_list) {
+		while (g_queue_pop_head_link(self->in_use_list))
+			;
+		g_queue_free(self->in_use_list);
+		self->in_use_list = NULL;
+	}
+
 	if (self->objectlock) {
 		g_mutex_free(self->objectlock);
 		self->objectlock = NULL;
@@ -144,9 +164,8 @@ gboolean mix_surfacepool_copy(MixParams * target, const MixParams * src) {
 
 		// Free the existing properties
 
-		// Duplicate string
-		this_target->free_list = this_src->free_list;
-		this_target->in_use_list = this_src->in_use_list;
+		// The queues are not shared; their nodes are owned by the pooled
+		// frames and each frame belongs to one pool only
 		this_target->free_list_max_size = this_src->free_list_max_size;
 		this_target->free_list_cur_size = this_src->free_list_cur_size;
 		this_target->high_water_mark = this_src->high_water_mark;
@@ -217,8 +236,10 @@ gboolean mix_surfacepool_equal(MixParams * first, MixParams * second) {
  * mix_surfacepool_initialize:
  * @returns: MIX_RESULT_SUCCESS if successful in creating the surface pool
  *
- * Use this method to create a new surface pool, consisting of a GSList of
- * frame objects that represents a pool of surfaces.
+ * Use this method to create a new surface pool, consisting of a GQueue of
+ * frame objects that represents a pool of surfaces. The queue nodes are
+ * embedded in the frames, so moving a frame between the free and in use
+ * queues never allocates.
  */
 MIX_RESULT mix_surfacepool_initialize(MixSurfacePool * obj,
 		VASurfaceID *surfaces, guint num_surfaces) {
@@ -236,7 +257,8 @@ MIX_RESULT mix_surfacepool_initialize(MixSurfacePool * obj,
 
 	MIX_LOCK(obj->objectlock);
 
-	if ((obj->free_list != NULL) || (obj->in_use_list != NULL)) {
+	if (!g_queue_is_empty(obj->free_list)
+			|| !g_queue_is_empty(obj->in_use_list)) {
 		//surface pool is in use; return error; need proper cleanup
 		//TODO need cleanup here?
 
@@ -246,10 +268,6 @@ MIX_RESULT mix_surfacepool_initialize(MixSurfacePool * obj,
 	}
 
 	if (num_surfaces == 0) {
-		obj->free_list = NULL;
-
-		obj->in_use_list = NULL;
-
 		obj->free_list_max_size = num_surfaces;
 
 		obj->free_list_cur_size = num_surfaces;
@@ -288,12 +306,10 @@ MIX_RESULT mix_surfacepool_initialize(MixSurfacePool * obj,
 		mix_videoframe_set_pool(frame, obj);
 
 		//Add each frame object to the pool list
-		obj->free_list = g_slist_append(obj->free_list, frame);
+		g_queue_push_tail_link(obj->free_list, MIX_VIDEOFRAME_POOL_LINK(frame));
 
 	}
 
-	obj->in_use_list = NULL;
-
 	obj->free_list_max_size = num_surfaces;
 
 	obj->free_list_cur_size = num_surfaces;
@@ -322,36 +338,27 @@ MIX_RESULT mix_surfacepool_put(MixSurfacePool * obj, MixVideoFrame * frame) {
 	LOG_V( "Frame id: %d\n", frame->frame_id);
 	MIX_LOCK(obj->objectlock);
 
-	if (obj->in_use_list == NULL) {
-		//in use list cannot be empty if a frame is in use
-		//TODO need better error code for this
-
-		MIX_UNLOCK(obj->objectlock);
-
-		return MIX_RESULT_FAIL;
-	}
-
-	GSList *element = g_slist_find(obj->in_use_list, frame);
-	if (element == NULL) {
+	MixVideoFramePrivate *priv = (MixVideoFramePrivate *) frame->reserved1;
+	if (priv->pool != obj || !priv->in_use) {
 		//Integrity error; frame not found in in use list
 		//TODO need better error code and handling for this
 
 		MIX_UNLOCK(obj->objectlock);
 
 		return MIX_RESULT_FAIL;
-	} else {
-		//Remove this element from the in_use_list
-		obj->in_use_list = g_slist_remove_link(obj->in_use_list, element);
-
-		//Concat the element to the free_list and reset the timestamp of the frame
-		//Note that the surface ID stays valid
-		mix_videoframe_set_timestamp(frame, 0);
-		obj->free_list = g_slist_concat(obj->free_list, element);
-		
-		//increment the free list count
-		obj->free_list_cur_size++;
 	}
 
+	//Move the frame's own node from the in_use_list to the free_list and
+	//reset the timestamp of the frame
+	//Note that the surface ID stays valid
+	g_queue_unlink(obj->in_use_list, &priv->pool_link);
+	mix_videoframe_set_timestamp(frame, 0);
+	g_queue_push_tail_link(obj->free_list, &priv->pool_link);
+	priv->in_use = FALSE;
+
+	//increment the free list count
+	obj->free_list_cur_size++;
+
 	//Note that we do nothing with the ref count for this.  We want it to
 	//stay at 1, which is what triggered it to be added back to the free list.
 
@@ -394,8 +401,7 @@ MIX_RESULT mix_surfacepool_get(MixSurfacePool * obj, MixVideoFrame ** frame) {
 	//Remove a frame from the free pool
 
 	//We just remove the one at the head, since it's convenient
-	GSList *element = obj->free_list;
-	obj->free_list = g_slist_remove_link(obj->free_list, element);
+	GList *element = g_queue_pop_head_link(obj->free_list);
 	if (element == NULL) {
 		//Unexpected behavior
 		//TODO need better error code and handling for this
@@ -406,8 +412,8 @@ MIX_RESULT mix_surfacepool_get(MixSurfacePool * obj, MixVideoFrame ** frame) {
 
 		return MIX_RESULT_FAIL;
 	} else {
-		//Concat the element to the in_use_list
-		obj->in_use_list = g_slist_concat(obj->in_use_list, element);
+		//Add the element to the in_use_list
+		g_queue_push_tail_link(obj->in_use_list, element);
 
 		//TODO replace with proper logging
 
@@ -416,6 +422,7 @@ MIX_RESULT mix_surfacepool_get(MixSurfacePool * obj, MixVideoFrame ** frame) {
 
 		//Set the out frame pointer
 		*frame = (MixVideoFrame *) element->data;
+		((MixVideoFramePrivate *) (*frame)->reserved1)->in_use = TRUE;
 
 		LOG_V( "Frame id: %d\n", (*frame)->frame_id);
 		
@@ -423,7 +430,7 @@ MIX_RESULT mix_surfacepool_get(MixSurfacePool * obj, MixVideoFrame ** frame) {
 		obj->free_list_cur_size--;
 
 		//Check the high water mark for surface use
-		guint size = g_slist_length(obj->in_use_list);
+		guint size = g_queue_get_length(obj->in_use_list);
 		if (size > obj->high_water_mark)
 			obj->high_water_mark = size;
 		//TODO Log this high water mark
@@ -466,7 +473,7 @@ MIX_RESULT mix_surfacepool_get_frame_with_ci_frameidx (MixSurfacePool * obj, Mix
 
 	MIX_LOCK(obj->objectlock);
 
-	if (obj->free_list == NULL) {
+	if (g_queue_is_empty(obj->free_list)) {
 		//We are out of surfaces
 		//TODO need to log this as well
 
@@ -480,8 +487,7 @@ MIX_RESULT mix_surfacepool_get_frame_with_ci_frameidx (MixSurfacePool * obj, Mix
 	//Remove a frame from the free pool
 
 	//We just remove the one at the head, since it's convenient
-	GSList *element = g_slist_find_custom (obj->free_list, in_frame, (GCompareFunc) mixframe_compare_index);
-	obj->free_list = g_slist_remove_link(obj->free_list, element);
+	GList *element = g_queue_find_custom (obj->free_list, in_frame, (GCompareFunc) mixframe_compare_index);
 	if (element == NULL) {
 		//Unexpected behavior
 		//TODO need better error code and handling for this
@@ -492,8 +498,9 @@ MIX_RESULT mix_surfacepool_get_frame_with_ci_frameidx (MixSurfacePool * obj, Mix
 
 		return MIX_RESULT_FAIL;
 	} else {
-		//Concat the element to the in_use_list
-		obj->in_use_list = g_slist_concat(obj->in_use_list, element);
+		//Move the element to the in_use_list
+		g_queue_unlink(obj->free_list, element);
+		g_queue_push_tail_link(obj->in_use_list, element);
 
 		//TODO replace with proper logging
 
@@ -502,9 +509,10 @@ MIX_RESULT mix_surfacepool_get_frame_with_ci_frameidx (MixSurfacePool * obj, Mix
 
 		//Set the out frame pointer
 		*frame = (MixVideoFrame *) element->data;
+		((MixVideoFramePrivate *) (*frame)->reserved1)->in_use = TRUE;
 
 		//Check the high water mark for surface use
-		guint size = g_slist_length(obj->in_use_list);
+		guint size = g_queue_get_length(obj->in_use_list);
 		if (size > obj->high_water_mark)
 			obj->high_water_mark = size;
 		//TODO Log this high water mark
@@ -572,8 +580,8 @@ MIX_RESULT mix_surfacepool_deinitialize(MixSurfacePool * obj) {
 
 	MIX_LOCK(obj->objectlock);
 
-	if ((obj->in_use_list != NULL) || (g_slist_length(obj->free_list)
-			!= obj->free_list_max_size)) {
+	if (!g_queue_is_empty(obj->in_use_list) || (g_queue_get_length(
+			obj->free_list) != obj->free_list_max_size)) {
 		//TODO better error code
 		//We have outstanding frame objects in use and they need to be
 		//freed before we can deinitialize.
@@ -587,17 +595,14 @@ MIX_RESULT mix_surfacepool_deinitialize(MixSurfacePool * obj) {
 
 	MixVideoFrame *frame = NULL;
 
-	while (obj->free_list != NULL) {
-		//Get the frame object from the head of the list
-		frame = obj->free_list->data;
-		//frame = g_slist_nth_data(obj->free_list, 0);
+	while (!g_queue_is_empty(obj->free_list)) {
+		//Unlink the frame's node from the head of the queue; the node
+		//is part of the frame and goes away with it
+		frame = g_queue_pop_head_link(obj->free_list)->data;
 
 		//Release it
 		mix_videoframe_unref(frame);
 
-		//Delete the head node of the list and store the new head
-		obj->free_list = g_slist_delete_link(obj->free_list, obj->free_list);
-
 		//Repeat until empty
 	}
 
@@ -637,16 +642,16 @@ mix_surfacepool_dumpprint (MixSurfacePool * obj)
 
 	LOG_I( "SURFACE POOL DUMP:\n");
 	LOG_I( "Free list size is %d\n", obj->free_list_cur_size);
-	LOG_I( "In use list size is %d\n", g_slist_length(obj->in_use_list));
+	LOG_I( "In use list size is %d\n", g_queue_get_length(obj->in_use_list));
 	LOG_I( "High water mark is %lu\n", obj->high_water_mark);
 
 	//Walk the free list and report the contents
 	LOG_I( "Free list contents:\n");
-	g_slist_foreach(obj->free_list, (GFunc) mix_surfacepool_dumpframe, NULL);
+	g_queue_foreach(obj->free_list, (GFunc) mix_surfacepool_dumpframe, NULL);
 
 	//Walk the in_use list and report the contents
 	LOG_I( "In Use list contents:\n");
-	g_slist_foreach(obj->in_use_list, (GFunc) mix_surfacepool_dumpframe, NULL);
+	g_queue_foreach(obj->in_use_list, (GFunc) mix_surfacepool_dumpframe, NULL);
 
 	return MIX_RESULT_SUCCESS;
 }
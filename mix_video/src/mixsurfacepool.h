@@ -74,8 +74,8 @@ struct _MixSurfacePool
   MixParams parent;
 
   /*< public > */
-  GSList *free_list;		/* list of free surfaces */
-  GSList *in_use_list;		/* list of surfaces in use */
+  GQueue *free_list;		/* queue of free surfaces */
+  GQueue *in_use_list;		/* queue of surfaces in use */
   gulong free_list_max_size;	/* initial size of the free list */
   gulong free_list_cur_size;	/* current size of the free list */
   gulong high_water_mark;	/* most surfaces in use at one time */
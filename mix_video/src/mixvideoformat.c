@@ -46,6 +46,9 @@ static void mix_videoformat_init(MixVideoFormat * self) {
 	self->surfacepool = NULL;
 	self->inputbufpool = NULL;
 	self->inputbufqueue = NULL;
+	self->inputbufentry_cache = NULL;
+	self->buffer_ids = NULL;
+	self->buffer_ids_size = 0;
 	self->va_display = NULL;
 	self->va_context = VA_INVALID_ID;
 	self->va_config = VA_INVALID_ID;
@@ -146,15 +149,23 @@ void mix_videoformat_finalize(GObject * obj) {
 
 	//Deinit input buffer queue 
 
-	while (!g_queue_is_empty(mix->inputbufqueue))
+	while ((buf_entry = mix_videofmt_dequeue_inputbuf(mix)) != NULL)
 	{
-		buf_entry = g_queue_pop_head(mix->inputbufqueue); 
 		mix_buffer_unref(buf_entry->buf);
 		g_free(buf_entry);
 	}
 
 	g_queue_free(mix->inputbufqueue);
 
+	while (mix->inputbufentry_cache)
+	{
+		g_free(g_trash_stack_pop(&mix->inputbufentry_cache));
+	}
+
+	g_free(mix->buffer_ids);
+	mix->buffer_ids = NULL;
+	mix->buffer_ids_size = 0;
+
 	//MixBuffer pool is deallocated in MixVideo object
 	mix->inputbufpool = NULL;
 
@@ -254,11 +265,10 @@ static MIX_RESULT mix_videofmt_initialize_default(MixVideoFormat *mix,
 	{
 		//Deinit previous input buffer queue 
 	
-		while (!g_queue_is_empty(mix->inputbufqueue))
+		while ((buf_entry = mix_videofmt_dequeue_inputbuf(mix)) != NULL)
 		{
-			buf_entry = g_queue_pop_head(mix->inputbufqueue); 
 			mix_buffer_unref(buf_entry->buf);
-			g_free(buf_entry);
+			mix_videofmt_release_inputbufentry(mix, buf_entry);
 		}
 
 		g_queue_free(mix->inputbufqueue);
@@ -399,3 +409,77 @@ MIX_RESULT mix_videofmt_deinitialize(MixVideoFormat *mix) {
 
 	return MIX_RESULT_FAIL;
 }
+
+/* helpers for derived classes */
+
+MIX_RESULT mix_videofmt_queue_inputbuf(MixVideoFormat *mix, MixBuffer *buf,
+		guint64 timestamp) {
+
+	MixInputBufferEntry *entry = NULL;
+
+	if (mix->inputbufentry_cache)
+	{
+		entry = g_trash_stack_pop(&mix->inputbufentry_cache);
+	}
+	else
+	{
+		entry = g_malloc(sizeof(MixInputBufferEntry));
+		if (entry == NULL)
+		{
+			LOG_E( "Error allocating bufentry\n");
+			return MIX_RESULT_NO_MEMORY;
+		}
+	}
+
+	entry->buf = buf;
+	entry->timestamp = timestamp;
+	entry->link.data = entry;
+	entry->link.next = NULL;
+	entry->link.prev = NULL;
+
+	LOG_V( "Setting bufentry %x for mixbuffer %x ts to %"G_GINT64_FORMAT"\n", (guint)entry, (guint)buf, timestamp);
+
+	g_queue_push_tail_link(mix->inputbufqueue, &entry->link);
+
+	return MIX_RESULT_SUCCESS;
+}
+
+MixInputBufferEntry *mix_videofmt_dequeue_inputbuf(MixVideoFormat *mix) {
+
+	GList *link = NULL;
+
+	if (mix->inputbufqueue == NULL)
+		return NULL;
+
+	//The node is embedded in the entry, so it is unlinked rather than freed
+	link = g_queue_pop_head_link(mix->inputbufqueue);
+	if (link == NULL)
+		return NULL;
+
+	return (MixInputBufferEntry *) link->data;
+}
+
+void mix_videofmt_release_inputbufentry(MixVideoFormat *mix,
+		MixInputBufferEntry *entry) {
+
+	g_trash_stack_push(&mix->inputbufentry_cache, entry);
+}
+
+VABufferID *mix_videofmt_get_buffer_ids(MixVideoFormat *mix, guint count) {
+
+	if (count > mix->buffer_ids_size)
+	{
+		LOG_V( "Growing buffer_ids from %d to %d\n", mix->buffer_ids_size, count);
+
+		g_free(mix->buffer_ids);
+		mix->buffer_ids = g_malloc(sizeof(VABufferID) * count);
+		if (mix->buffer_ids == NULL)
+		{
+			mix->buffer_ids_size = 0;
+			return NULL;
+		}
+		mix->buffer_ids_size = count;
+	}
+
+	return mix->buffer_ids;
+}
@@ -82,6 +82,9 @@ struct _MixVideoFormat {
 	guint64 current_timestamp;
 	MixBufferPool *inputbufpool;
 	GQueue *inputbufqueue;
+	GTrashStack *inputbufentry_cache;	/* released MixInputBufferEntry structs */
+	VABufferID *buffer_ids;		/* per picture VA buffer IDs, reused */
+	guint buffer_ids_size;
 };
 
 /**
@@ -157,4 +160,27 @@ MIX_RESULT mix_videofmt_eos(MixVideoFormat *mix);
 
 MIX_RESULT mix_videofmt_deinitialize(MixVideoFormat *mix);
 
+/* Helpers for derived classes, called with objectlock held */
+
+/*
+ * Queue buf at the tail of inputbufqueue. The entry comes from a per instance
+ * cache, so steady state decoding does not allocate. The caller holds the
+ * reference to buf that the queue entry keeps.
+ */
+MIX_RESULT mix_videofmt_queue_inputbuf(MixVideoFormat *mix, MixBuffer *buf,
+		guint64 timestamp);
+
+/* Dequeue the head of inputbufqueue, NULL if empty */
+MixInputBufferEntry *mix_videofmt_dequeue_inputbuf(MixVideoFormat *mix);
+
+/* Return an entry from mix_videofmt_dequeue_inputbuf to the cache */
+void mix_videofmt_release_inputbufentry(MixVideoFormat *mix,
+		MixInputBufferEntry *entry);
+
+/*
+ * Array for at least count VA buffer IDs, owned by mix and reused for every
+ * picture; it only grows when a picture has more slices than any before.
+ */
+VABufferID *mix_videofmt_get_buffer_ids(MixVideoFormat *mix, guint count);
+
 #endif /* __MIX_VIDEOFORMAT_H__ */
@@ -572,7 +572,6 @@ MIX_RESULT mix_videofmt_h264_decode(MixVideoFormat *mix, MixBuffer * bufin[],
 	guint64 ts = 0;
 	vbp_data_h264 *data = NULL;
 	gboolean discontinuity = FALSE;
-	MixInputBufferEntry *bufentry = NULL;
 
         LOG_V( "Begin\n");
 
@@ -690,27 +689,12 @@ MIX_RESULT mix_videofmt_h264_decode(MixVideoFormat *mix, MixBuffer * bufin[],
 			//Increase the ref count of this input buffer
 			mix_buffer_ref(bufin[i]);
 
-			//Create a new MixInputBufferEntry
-			//TODO make this from a pool to optimize
-			bufentry = g_malloc(sizeof(
-				MixInputBufferEntry));
-			if (bufentry == NULL)
-        		{
-				ret = MIX_RESULT_NO_MEMORY;
-				LOG_E( "Error allocating bufentry\n");
-               			goto cleanup;
-        		}
-
-			bufentry->buf = bufin[i];
-	LOG_V( "Setting bufentry %x for mixbuffer %x ts to %"G_GINT64_FORMAT"\n", (guint)bufentry, (guint)bufentry->buf, ts);
-			bufentry->timestamp = ts;
-
-			LOG_V( "Enqueue this input buffer for current frame\n");
-			LOG_V( "bufentry->timestamp %"G_GINT64_FORMAT"\n", bufentry->timestamp);
-
 			//Enqueue this input buffer
-			g_queue_push_tail(parent->inputbufqueue, 
-				(gpointer)bufentry);
+			ret = mix_videofmt_queue_inputbuf(parent, bufin[i], ts);
+			if (ret != MIX_RESULT_SUCCESS)
+			{
+				goto cleanup;
+			}
 
 			//process and decode data
 			ret = mix_videofmt_h264_process_decode(mix,
@@ -740,26 +724,12 @@ MIX_RESULT mix_videofmt_h264_decode(MixVideoFormat *mix, MixBuffer * bufin[],
 			//Increase the ref count of this input buffer
 			mix_buffer_ref(bufin[i]);
 
-			//Create a new MixInputBufferEntry
-			//TODO make this from a pool to optimize
-			bufentry = g_malloc(sizeof
-				(MixInputBufferEntry));
-			if (bufentry == NULL)
-        		{
-				ret = MIX_RESULT_NO_MEMORY;
-				LOG_E( "Error allocating bufentry\n");
-               			goto cleanup;
-        		}
-			bufentry->buf = bufin[i];
-	LOG_V( "Setting bufentry %x for mixbuffer %x ts to %"G_GINT64_FORMAT"\n", (guint)bufentry, (guint)bufentry->buf, ts);
-			bufentry->timestamp = ts;
-
-			LOG_V( "Enqueue this input buffer for current frame\n");
-			LOG_V( "bufentry->timestamp %"G_GINT64_FORMAT"\n", bufentry->timestamp);
-
 			//Enqueue this input buffer
-			g_queue_push_tail(parent->inputbufqueue, 
-				(gpointer)bufentry);
+			ret = mix_videofmt_queue_inputbuf(parent, bufin[i], ts);
+			if (ret != MIX_RESULT_SUCCESS)
+			{
+				goto cleanup;
+			}
 	LOG_V( "Setting parse_in_progress to TRUE\n");
 			parent->parse_in_progress = TRUE;
 		}
@@ -810,12 +780,11 @@ MIX_RESULT ret = MIX_RESULT_SUCCESS;
 	//Clear the contents of inputbufqueue
 	while (!g_queue_is_empty(mix->inputbufqueue))
 	{
-		bufentry = (MixInputBufferEntry *) g_queue_pop_head(
-				mix->inputbufqueue);
+		bufentry = mix_videofmt_dequeue_inputbuf(mix);
 		if (bufentry == NULL) continue;
 
 		mix_buffer_unref(bufentry->buf);
-		g_free(bufentry);
+		mix_videofmt_release_inputbufentry(mix, bufentry);
 	}
 
 	//Clear parse_in_progress flag and current timestamp
@@ -1062,8 +1031,8 @@ MIX_RESULT mix_videofmt_h264_process_decode_picture(MixVideoFormat *mix,
 
 	LOG_V( "num_slices is %d, allocating %d buffer_ids\n", pic_data->num_slices, (pic_data->num_slices * 2) + 2);
 
-	buffer_ids = g_malloc(sizeof(VABufferID) * 
-					((pic_data->num_slices * 2) + 2));
+	buffer_ids = mix_videofmt_get_buffer_ids(mix,
+					(pic_data->num_slices * 2) + 2);
 
 	if (buffer_ids == NULL) 
 	{
@@ -1383,9 +1352,7 @@ MIX_RESULT mix_videofmt_h264_process_decode_picture(MixVideoFormat *mix,
 
 	cleanup:
 
-	if (NULL != buffer_ids)
-		g_free(buffer_ids);
-
+	//buffer_ids belongs to mix and is reused for the next picture
 
 	LOG_V( "End\n");
 
@@ -1646,11 +1613,10 @@ MIX_RESULT mix_videofmt_h264_release_input_buffers(MixVideoFormat *mix,
 			break;
 		}
 
-		bufentry = (MixInputBufferEntry *) g_queue_pop_head(
-				mix->inputbufqueue);
+		bufentry = mix_videofmt_dequeue_inputbuf(mix);
 		LOG_V( "Unref this MixBuffers %x\n", (guint)bufentry->buf);
 		mix_buffer_unref(bufentry->buf);
-		g_free(bufentry);
+		mix_videofmt_release_inputbufentry(mix, bufentry);
 	}
 	
 
@@ -395,7 +395,6 @@ MIX_RESULT mix_videofmt_mp42_decode(MixVideoFormat *mix, MixBuffer * bufin[],
 	guint64 ts = 0;
 	vbp_data_mp42 *data = NULL;
 	gboolean discontinuity = FALSE;
-	MixInputBufferEntry *bufentry = NULL;
 	gint i = 0;
 
 	LOG_V("Begin\n");
@@ -503,23 +502,12 @@ MIX_RESULT mix_videofmt_mp42_decode(MixVideoFormat *mix, MixBuffer * bufin[],
 			/* Increase the ref count of this input buffer */
 			mix_buffer_ref(bufin[i]);
 
-			/* Create a new MixInputBufferEntry
-			 * TODO: make this from a pool later 
-			 */
-			bufentry = g_malloc(sizeof(MixInputBufferEntry));
-			if (bufentry == NULL) {
-				ret = MIX_RESULT_NO_MEMORY;
+			/* Enqueue this input buffer */
+			ret = mix_videofmt_queue_inputbuf(parent, bufin[i], ts);
+			if (ret != MIX_RESULT_SUCCESS) {
 				goto cleanup;
 			}
 
-			bufentry->buf = bufin[i];
-			bufentry->timestamp = ts;
-
-			LOG_I("bufentry->buf = %x bufentry->timestamp FOR VBP_DONE = %"G_GINT64_FORMAT"\n", bufentry->buf, bufentry->timestamp);
-
-			/* Enqueue this input buffer */
-			g_queue_push_tail(parent->inputbufqueue, (gpointer) bufentry);
-
 			/* process and decode data */
 			ret
 					= mix_videofmt_mp42_process_decode(mix, data, ts,
@@ -554,21 +542,11 @@ MIX_RESULT mix_videofmt_mp42_decode(MixVideoFormat *mix, MixBuffer * bufin[],
 			/* Increase the ref count of this input buffer */
 			mix_buffer_ref(bufin[i]);
 
-			/* Create a new MixInputBufferEntry
-			 * TODO make this from a pool later
-			 */
-			bufentry = g_malloc(sizeof(MixInputBufferEntry));
-			if (bufentry == NULL) {
-				ret = MIX_RESULT_FAIL;
+			/* Enqueue this input buffer */
+			ret = mix_videofmt_queue_inputbuf(parent, bufin[i], ts);
+			if (ret != MIX_RESULT_SUCCESS) {
 				goto cleanup;
 			}
-
-			bufentry->buf = bufin[i];
-			bufentry->timestamp = ts;
-			LOG_I("bufentry->buf = %x bufentry->timestamp FOR VBP_OK = %"G_GINT64_FORMAT"\n", bufentry->buf, bufentry->timestamp);
-
-			/* Enqueue this input buffer */
-			g_queue_push_tail(parent->inputbufqueue, (gpointer) bufentry);
 			parent->parse_in_progress = TRUE;
 		}
 #endif
@@ -873,7 +851,7 @@ MIX_RESULT mix_videofmt_mp42_process_decode(MixVideoFormat *mix,
 		}
 	}
 
-	buffer_ids = g_malloc(sizeof(VABufferID) * buffer_id_number);
+	buffer_ids = mix_videofmt_get_buffer_ids(mix, buffer_id_number);
 	if (buffer_ids == NULL) {
 		ret = MIX_RESULT_NO_MEMORY;
 		LOG_E("Failed to allocate buffer_ids!\n");
@@ -1102,7 +1080,6 @@ MIX_RESULT mix_videofmt_mp42_process_decode(MixVideoFormat *mix,
 				self->packed_stream_queue);
 	}
 
-	g_free(buffer_ids);
 	mix_videofmt_mp42_release_input_buffers(mix, timestamp);
 
 	if (is_from_queued_data) {
@@ -1133,13 +1110,13 @@ MIX_RESULT mix_videofmt_mp42_flush(MixVideoFormat *mix) {
 	 * Clear the contents of inputbufqueue
 	 */
 	while (!g_queue_is_empty(mix->inputbufqueue)) {
-		bufentry = (MixInputBufferEntry *) g_queue_pop_head(mix->inputbufqueue);
+		bufentry = mix_videofmt_dequeue_inputbuf(mix);
 		if (bufentry == NULL) {
 			continue;
 		}
 
 		mix_buffer_unref(bufentry->buf);
-		g_free(bufentry);
+		mix_videofmt_release_inputbufentry(mix, bufentry);
 	}
 
 	/*
@@ -1327,11 +1304,11 @@ MIX_RESULT mix_videofmt_mp42_release_input_buffers(MixVideoFormat *mix,
 			break;
 		}
 
-		bufentry = (MixInputBufferEntry *) g_queue_pop_head(mix->inputbufqueue);
+		bufentry = mix_videofmt_dequeue_inputbuf(mix);
 		LOG_V("Unref this MixBuffers %x\n", (guint) bufentry->buf);
 
 		mix_buffer_unref(bufentry->buf);
-		g_free(bufentry);
+		mix_videofmt_release_inputbufentry(mix, bufentry);
 	}
 
 	LOG_V("End\n");
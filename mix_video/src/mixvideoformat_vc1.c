@@ -14,6 +14,7 @@
 #ifdef YUVDUMP
 //TODO Complete YUVDUMP code and move into base class
 #include <stdio.h>
+#include "PlaneConvert.h"
 #endif /* YUVDUMP */
 
 #include <string.h>
@@ -626,7 +627,6 @@ MIX_RESULT mix_videofmt_vc1_decode(MixVideoFormat *mix,
 	guint64 ts = 0;
 	vbp_data_vc1 *data = NULL;
 	gboolean discontinuity = FALSE;
-	MixInputBufferEntry *bufentry = NULL;
 
         if (mix == NULL || bufin == NULL || decode_params == NULL )
 	{
@@ -745,27 +745,12 @@ MIX_RESULT mix_videofmt_vc1_decode(MixVideoFormat *mix,
 			//Increase the ref count of this input buffer
 			mix_buffer_ref(bufin[i]);
 
-			//Create a new MixInputBufferEntry
-			//TODO make this from a pool to optimize
-			bufentry = g_malloc(sizeof(
-				MixInputBufferEntry));
-			if (bufentry == NULL)
-        		{
-				ret = MIX_RESULT_NO_MEMORY;
-				LOG_E( "Error allocating bufentry\n");
-               			goto cleanup;
-        		}
-
-			bufentry->buf = bufin[i];
-			LOG_V( "Setting bufentry %x for mixbuffer %x ts to %"G_GINT64_FORMAT"\n", (guint)bufentry, (guint)bufentry->buf, ts);
-			bufentry->timestamp = ts;
-
-			LOG_V( "Enqueue this input buffer for current frame\n");
-			LOG_V( "bufentry->timestamp %"G_GINT64_FORMAT"\n", bufentry->timestamp);
-
 			//Enqueue this input buffer
-			g_queue_push_tail(parent->inputbufqueue, 
-				(gpointer)bufentry);
+			ret = mix_videofmt_queue_inputbuf(parent, bufin[i], ts);
+			if (ret != MIX_RESULT_SUCCESS)
+			{
+				goto cleanup;
+			}
 
 			//process and decode data
 			ret = mix_videofmt_vc1_process_decode(mix,
@@ -795,22 +780,12 @@ MIX_RESULT mix_videofmt_vc1_decode(MixVideoFormat *mix,
 			//Increase the ref count of this input buffer
 			mix_buffer_ref(bufin[i]);
 
-			//Create a new MixInputBufferEntry
-			//TODO make this from a pool to optimize
-			bufentry = g_malloc(sizeof
-				(MixInputBufferEntry));
-			if (bufentry == NULL)
-        		{
-				ret = MIX_RESULT_NO_MEMORY;
-				LOG_E( "Error allocating bufentry\n");
-               			goto cleanup;
-        		}
-			bufentry->buf = bufin[i];
-			bufentry->timestamp = ts;
-
 			//Enqueue this input buffer
-			g_queue_push_tail(parent->inputbufqueue, 
-				(gpointer)bufentry);
+			ret = mix_videofmt_queue_inputbuf(parent, bufin[i], ts);
+			if (ret != MIX_RESULT_SUCCESS)
+			{
+				goto cleanup;
+			}
 			parent->parse_in_progress = TRUE;
 		}
 
@@ -847,7 +822,6 @@ MIX_RESULT GetImageFromSurface (MixVideoFormat *mix, MixVideoFrame * frame)
 	FILE *fp = NULL;
 	int r = 0;
  
-       int i;
 
        g_print ("GetImageFromSurface   \n");
 
@@ -896,11 +870,19 @@ MIX_RESULT GetImageFromSurface (MixVideoFormat *mix, MixVideoFrame * frame)
 
       r = fwrite (pBuffer, va_image.offsets[1], 1, fp);
 
-         for (i = 0; i < ui32SrcWidth * ui32SrcHeight / 2; i +=2)
-              r = fwrite (pBuffer + va_image.offsets[1] + i / 2, 1, 1, fp);
-
-        for (i = 0; i < ui32SrcWidth * ui32SrcHeight / 2; i +=2)
-              r = fwrite (pBuffer + va_image.offsets[1] +  i / 2 + 1, 1, 1, fp);   
+        /* de-interleave the NV12 chroma plane into planar U then V */
+        {
+            guint32 chroma_width = ui32SrcWidth / 2;
+            guint32 chroma_rows = ui32SrcHeight / 2;
+            guchar *u = g_malloc (chroma_width * chroma_rows);
+            guchar *v = g_malloc (chroma_width * chroma_rows);
+            deinterleaveUV (u, v, chroma_width, pBuffer + va_image.offsets[1],
+                    va_image.pitches[1], chroma_width, chroma_rows);
+            r = fwrite (u, chroma_width * chroma_rows, 1, fp);
+            r = fwrite (v, chroma_width * chroma_rows, 1, fp);
+            g_free (u);
+            g_free (v);
+        }
 
         g_print ("ui32ChromaOffset = %d, ui32Stride = %d\n", ui32ChromaOffset, ui32Stride);       
 
@@ -961,7 +943,7 @@ MIX_RESULT mix_videofmt_vc1_decode_a_picture(
 		}
 	}
 
-	buffer_ids = g_malloc(sizeof(VABufferID) * ((pic_data->num_slices * 2) + 2));
+	buffer_ids = mix_videofmt_get_buffer_ids(mix, (pic_data->num_slices * 2) + 2);
 	if (buffer_ids == NULL) 
 	{
 		LOG_E( "Cannot allocate buffer IDs\n");
@@ -1287,8 +1269,7 @@ MIX_RESULT mix_videofmt_vc1_decode_a_picture(
 	}
 
 cleanup:
-	if (NULL != buffer_ids)
-		g_free(buffer_ids);
+	//buffer_ids belongs to mix and is reused for the next picture
 
 	return ret;
 }
@@ -1506,12 +1487,12 @@ MIX_RESULT mix_videofmt_vc1_flush(MixVideoFormat *mix)
 	//Clear the contents of inputbufqueue
 	while (!g_queue_is_empty(mix->inputbufqueue))
 	{
-		bufentry = (MixInputBufferEntry *) g_queue_pop_head(mix->inputbufqueue);
+		bufentry = mix_videofmt_dequeue_inputbuf(mix);
 		if (bufentry == NULL) 
 			continue;
 
 		mix_buffer_unref(bufentry->buf);
-		g_free(bufentry);
+		mix_videofmt_release_inputbufentry(mix, bufentry);
 	}
 
 	//Clear parse_in_progress flag and current timestamp
@@ -1733,11 +1714,11 @@ MIX_RESULT mix_videofmt_vc1_release_input_buffers(
 			break;
 		}
 
-		bufentry = (MixInputBufferEntry *) g_queue_pop_head(mix->inputbufqueue);
+		bufentry = mix_videofmt_dequeue_inputbuf(mix);
 
 		LOG_V( "Unref this MixBuffers %x\n", (guint)bufentry->buf);
 		mix_buffer_unref(bufentry->buf);
-		g_free(bufentry);
+		mix_videofmt_release_inputbufentry(mix, bufentry);
 	}
 	
 
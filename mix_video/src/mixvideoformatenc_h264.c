@@ -10,6 +10,7 @@
 #include <stdlib.h>
 
 #include "mixvideolog.h"
+#include "PlaneConvert.h"
 
 #include "mixvideoformatenc_h264.h"
 #include "mixvideoconfigparamsenc_h264.h"
@@ -1364,7 +1365,7 @@ MIX_RESULT mix_videofmtenc_h264_process_encode (MixVideoFormatEnc_H264 *mix,
             guint8 *pvbuf;
             guint8 *dst_y;
             guint8 *dst_uv;	
-            int i,j;
+            int i;
             
             LOG_V( 
                     "map source data to surface\n");	
@@ -1435,14 +1436,9 @@ MIX_RESULT mix_videofmtenc_h264_process_encode (MixVideoFormatEnc_H264 *mix,
             
             dst_uv = pvbuf + image->offsets[1];
             
-            for (i = 0; i < height / 2; i ++) {
-                for (j = 0; j < width; j+=2) {
-                    dst_uv [j] = inbuf [width * height + i * width / 2 + j / 2];
-                    dst_uv [j + 1] = 
-                        inbuf [width * height * 5 / 4 + i * width / 2 + j / 2];
-                }
-                dst_uv += image->pitches[1];
-            }
+            interleaveUV(dst_uv, image->pitches[1],
+                    inbuf + width * height, inbuf + width * height * 5 / 4,
+                    width / 2, width / 2, height / 2);
             
             vaUnmapBuffer(va_display, image->buf);	
             if (va_status != VA_STATUS_SUCCESS)	 
@@ -1614,62 +1610,44 @@ MIX_RESULT mix_videofmtenc_h264_process_encode (MixVideoFormatEnc_H264 *mix,
         memcpy (&(iovout->data_size), (void*)buf, 4); 
         //size = (guint*) buf;
 
-        guint size = iovout->data_size + 100;
-
-        iovout->buffer_size = size;
-
         //We will support two buffer mode, one is application allocates the buffer and passes to encode, 
         //the other is encode allocate memory
+        //Either way the payload is written once, straight from the mapped coded buffer
         
+        guint size = 0;
+
         if (iovout->data == NULL) { //means  app doesn't allocate the buffer, so _encode will allocate it.
-            iovout->data = g_malloc (size);  // In case we have lots of 0x000001 start code, and we replace them with 4 bytes length prefixed
+            size = iovout->data_size + 100;  // In case we have lots of 0x000001 start code, and we replace them with 4 bytes length prefixed
+            iovout->data = g_malloc (size);
             if (iovout->data == NULL) {
+                vaUnmapBuffer (va_display, mix->coded_buf);
                 return MIX_RESULT_NO_MEMORY;
             }
+            iovout->buffer_size = size;
+        } else if (iovout->buffer_size > 0) {
+            size = iovout->buffer_size;
+        } else {
+            //buffer size not given, assume the buffer has the room we would allocate
+            size = iovout->data_size + 100;
         }
 
         if (mix->delimiter_type == MIX_DELIMITER_ANNEXB) {
+            if (size < iovout->data_size) {
+                LOG_E ("The length of destination buffer is too small\n");
+                vaUnmapBuffer (va_display, mix->coded_buf);
+                return MIX_RESULT_FAIL;
+            }
             memcpy (iovout->data, buf + 16, iovout->data_size); //parload is started from 17th byte
             size = iovout->data_size;
         } else {
-
-            guint pos = 0;
-            guint zero_byte_count = 0;	
-            guint prefix_length = 0;				
-            guint8 nal_unit_type = 0; 
-	     guint8 * payload = buf + 16;
-
-            while ((payload[pos++] == 0x00)) {                
-                zero_byte_count ++;
-                if (pos >= iovout->data_size)  //to make sure the buffer to be accessed is valid
-                    break;
-            }			 
-			
-	     nal_unit_type = (guint8)(payload[pos] & 0x1f);
-            prefix_length = zero_byte_count + 1;		 
-
-            LOG_I ("nal_unit_type = %d\n", nal_unit_type);		 
-            LOG_I ("zero_byte_count = %d\n", zero_byte_count);					
-
-            if ((payload [pos - 1] & 0x01) && mix->slice_num == 1 && nal_unit_type == 1) {
-                size =  iovout->data_size;
-                iovout->data[0] = ((size - prefix_length) >> 24) & 0xff;
-                iovout->data[1] = ((size - prefix_length) >> 16) & 0xff;
-                iovout->data[2] = ((size - prefix_length) >> 8)  & 0xff;
-                iovout->data[3] = (size - prefix_length)   & 0xff;      
-                // use 4 bytes to indicate the NALU length
-                memcpy (iovout->data + 4, buf + 16 + prefix_length, size - prefix_length);				
-                LOG_V ("We only have one start code, copy directly\n");				
-            } 
-            else {  
-                ret = mix_videofmtenc_h264_AnnexB_to_length_prefixed (buf + 16, iovout->data_size, iovout->data, &size);
-                if (ret != MIX_RESULT_SUCCESS)
-                {
-                    LOG_E ( 
-                            "Failed mix_videofmtenc_h264_AnnexB_to_length_prefixed\n");	
-                    return MIX_RESULT_FAIL;
-                }		
-            }
+            ret = mix_videofmtenc_h264_AnnexB_to_length_prefixed (buf + 16, iovout->data_size, iovout->data, &size);
+            if (ret != MIX_RESULT_SUCCESS)
+            {
+                LOG_E ( 
+                        "Failed mix_videofmtenc_h264_AnnexB_to_length_prefixed\n");	
+                vaUnmapBuffer (va_display, mix->coded_buf);
+                return MIX_RESULT_FAIL;
+            }		
         }
         
         iovout->data_size = size;
@@ -1819,18 +1797,39 @@ MIX_RESULT mix_videofmtenc_h264_get_max_encoded_buf_size (
     return MIX_RESULT_SUCCESS;    
 }
 
+/*
+ * Find the 0x01 byte of the next 00 00 01 start code at or after pos.
+ * memchr is used to skip to candidate 0x01 bytes, it scans a word or a
+ * vector at a time instead of testing every byte.
+ */
+static guint8 * mix_videofmtenc_h264_next_start_code (guint8 * pos, guint8 * end)
+{
+    guint8 * one = NULL;
+
+    while (end - pos > 2) {
+        one = memchr (pos + 2, 0x01, end - pos - 2);
+        if (one == NULL)
+            return NULL;
+        if (one[-1] == 0x00 && one[-2] == 0x00)
+            return one;
+        pos = one - 1;
+    }
+
+    return NULL;
+}
+
 MIX_RESULT mix_videofmtenc_h264_AnnexB_to_length_prefixed (
         guint8 * bufin, guint bufin_len, guint8* bufout, guint * bufout_len)
 {
     
-    guint pos = 0;
-    guint last_pos = 0;
+    guint8 * end = NULL;
+    guint8 * nal = NULL;
+    guint8 * nal_end = NULL;
+    guint8 * next = NULL;
     
     guint zero_byte_count = 0;	
     guint nal_size = 0;
-    guint prefix_length = 0;	
     guint size_copied = 0;	
-    guint leading_zero_count = 0;	
     
     if (bufin == NULL || bufout == NULL || bufout_len == NULL) {
         
@@ -1847,104 +1846,65 @@ MIX_RESULT mix_videofmtenc_h264_AnnexB_to_length_prefixed (
     
     LOG_V ("Begin\n");		
     
-    while ((bufin[pos++] == 0x00)) {                
+    end = bufin + bufin_len;
+
+    while (zero_byte_count < bufin_len && bufin[zero_byte_count] == 0x00) {
         zero_byte_count ++;
-        if (pos >= bufin_len)  //to make sure the buffer to be accessed is valid
-            break;
-    }	
+    }
     
-    if (bufin[pos - 1] != 0x01 || zero_byte_count < 2)
+    if (zero_byte_count == bufin_len || bufin[zero_byte_count] != 0x01 || zero_byte_count < 2)
     {
         LOG_E("The stream is not AnnexB format \n");
         return MIX_RESULT_FAIL;	;  //not AnnexB, we won't process it
     }			
     
-    zero_byte_count = 0;	
-    last_pos = pos;	            
+    nal = bufin + zero_byte_count + 1;
     
-    while (pos < bufin_len) {
-        
-        while (bufin[pos++] == 0) {
-            zero_byte_count ++;
-            if (pos >= bufin_len) //to make sure the buffer to be accessed is valid
-                break;			
-        }
+    /*
+     * Each NALU is copied straight from the coded buffer behind its 4 bytes
+     * length prefix, the zero bytes before the next start code are dropped.
+     */
+    while (nal < end) {
         
-        if (bufin[pos - 1] == 0x01 && zero_byte_count >= 2) {
-            if (zero_byte_count == 2) {
-                prefix_length = 3;
-            }
-            else {
-                prefix_length = 4;
-                leading_zero_count = zero_byte_count - 3;
-            }
-            
-            LOG_I("leading_zero_count = %d\n", leading_zero_count);						
-            
-            nal_size = pos - last_pos - prefix_length - leading_zero_count;	
-            if (nal_size < 0) {
-                LOG_E ("something wrong in the stream\n");	      
-                return MIX_RESULT_FAIL;	  //not AnnexB, we won't process it						
-            }
-            
-            if (*bufout_len < (size_copied + nal_size + 4)) {
-                LOG_E ("The length of destination buffer is too small\n");	      
-                return MIX_RESULT_FAIL;						
+        next = mix_videofmtenc_h264_next_start_code (nal, end);
+        if (next != NULL) {
+            nal_end = next - 2;
+            while (nal_end > nal && nal_end[-1] == 0x00) {
+                nal_end --;
             }
-            
-            LOG_I ("nal_size = %d\n", nal_size);											
-            
-            /*We use 4 bytes length prefix*/            
-            bufout [size_copied] = nal_size >> 24 & 0xff;
-            bufout [size_copied + 1] = nal_size >> 16 & 0xff;
-            bufout [size_copied + 2] = nal_size >> 8 & 0xff;
-            bufout [size_copied + 3] = nal_size  & 0xff;	
-            
-            size_copied += 4;	//4 bytes length prefix								
-            memcpy (bufout + size_copied, bufin + last_pos, nal_size);
-            size_copied += nal_size;			
-			
-            LOG_I ("size_copied = %d\n", size_copied);							
-            
-            zero_byte_count = 0;	
-            leading_zero_count = 0;
-            last_pos = pos;					
-        }
-        
-        else if (pos == bufin_len) {
-            
+        } else {
             LOG_V ("Last NALU in this frame\n");            
-            
-            nal_size = pos - last_pos;		
-            
-            if (*bufout_len < (size_copied + nal_size + 4)) {
-                LOG_E ("The length of destination buffer is too small\n");	      
-                return MIX_RESULT_FAIL;						
-            }
-            
-            /*We use 4 bytes length prefix*/            
-            bufout [size_copied] = nal_size >> 24 & 0xff;
-            bufout [size_copied + 1] = nal_size >> 16 & 0xff;
-            bufout [size_copied + 2] = nal_size >> 8 & 0xff;
-            bufout [size_copied + 3] = nal_size  & 0xff;               
-            
-            size_copied += 4;	//4 bytes length prefix		
-            memcpy (bufout + size_copied, bufin + last_pos, nal_size);
-            size_copied += nal_size;				
-			
-            LOG_I ("size_copied = %d\n", size_copied);							
+            nal_end = end;
         }
         
-        else {
-            zero_byte_count = 0;
-            leading_zero_count = 0;
+        nal_size = nal_end - nal;
+        
+        if (*bufout_len < (size_copied + nal_size + 4)) {
+            LOG_E ("The length of destination buffer is too small\n");	      
+            return MIX_RESULT_FAIL;						
         }
         
+        LOG_I ("nal_size = %d\n", nal_size);											
+        
+        /*We use 4 bytes length prefix*/            
+        bufout [size_copied] = nal_size >> 24 & 0xff;
+        bufout [size_copied + 1] = nal_size >> 16 & 0xff;
+        bufout [size_copied + 2] = nal_size >> 8 & 0xff;
+        bufout [size_copied + 3] = nal_size  & 0xff;	
+        
+        size_copied += 4;	//4 bytes length prefix								
+        memcpy (bufout + size_copied, nal, nal_size);
+        size_copied += nal_size;			
+        
+        LOG_I ("size_copied = %d\n", size_copied);							
+        
+        if (next == NULL)
+            break;
+        
+        nal = next + 1;
     }
     
-    if (size_copied != *bufout_len) {
-        *bufout_len = size_copied;
-    }
+    *bufout_len = size_copied;
     
     LOG_V ("End\n");		    
     
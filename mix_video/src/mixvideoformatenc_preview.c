@@ -10,6 +10,7 @@
 #include <stdlib.h>
 
 #include "mixvideolog.h"
+#include "PlaneConvert.h"
 
 #include "mixvideoformatenc_preview.h"
 #include "mixvideoconfigparamsenc_preview.h"
@@ -965,7 +966,7 @@ MIX_RESULT mix_videofmtenc_preview_process_encode (MixVideoFormatEnc_Preview *mi
             guint8 *pvbuf;
             guint8 *dst_y;
             guint8 *dst_uv;	
-            int i,j;
+            int i;
             
             LOG_V( 
                     "map source data to surface\n");	
@@ -1036,14 +1037,9 @@ MIX_RESULT mix_videofmtenc_preview_process_encode (MixVideoFormatEnc_Preview *mi
             
             dst_uv = pvbuf + image->offsets[1];
             
-            for (i = 0; i < height / 2; i ++) {
-                for (j = 0; j < width; j+=2) {
-                    dst_uv [j] = inbuf [width * height + i * width / 2 + j / 2];
-                    dst_uv [j + 1] = 
-                        inbuf [width * height * 5 / 4 + i * width / 2 + j / 2];
-                }
-                dst_uv += image->pitches[1];
-            }
+            interleaveUV(dst_uv, image->pitches[1],
+                    inbuf + width * height, inbuf + width * height * 5 / 4,
+                    width / 2, width / 2, height / 2);
             
             vaUnmapBuffer(va_display, image->buf);	
             if (va_status != VA_STATUS_SUCCESS)	 
@@ -18,6 +18,7 @@ struct _MixInputBufferEntry
   /*< private > */
   MixBuffer *buf;
   guint64 timestamp;
+  GList link;		/* node in inputbufqueue, data points to the entry */
 
 };
 
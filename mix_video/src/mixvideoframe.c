@@ -55,6 +55,10 @@ static void mix_videoframe_init(MixVideoFrame * self) {
 	/* set stuff for skipped frames */
 	priv -> is_skipped = FALSE;
 	priv -> real_frame = NULL;
+	priv -> pool_link.data = self;
+	priv -> pool_link.next = NULL;
+	priv -> pool_link.prev = NULL;
+	priv -> in_use = FALSE;
 
 	g_static_rec_mutex_init (&priv -> lock);
 
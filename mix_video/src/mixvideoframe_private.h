@@ -30,6 +30,8 @@ struct _MixVideoFramePrivate
   gboolean is_skipped;
   MixVideoFrame *real_frame;
   GStaticRecMutex lock;
+  GList pool_link;	/* node in the free or in use queue of the pool */
+  gboolean in_use;	/* pool_link is in the in use queue */
 };
 
 /**
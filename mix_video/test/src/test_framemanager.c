@@ -43,6 +43,142 @@ void shuffle(GPtrArray *list) {
 	}
 }
 
+/*
+ * Append the decode order of the hierarchical B frames between lo and hi,
+ * both of which are already decoded.
+ */
+void add_b_pyramid(GPtrArray *order, GPtrArray *frames, guint lo, guint hi) {
+	guint mid = (lo + hi) / 2;
+	if (hi - lo < 2) {
+		return;
+	}
+	g_ptr_array_add(order, g_ptr_array_index(frames, mid));
+	add_b_pyramid(order, frames, lo, mid);
+	add_b_pyramid(order, frames, mid, hi);
+}
+
+/*
+ * Enqueue num_gops * gop_size + 1 frames in the decode order of a stream
+ * with hierarchical B frames, so each anchor frame waits for up to gop_size
+ * frames, and drain them with batched dequeues. Checks that frames come out
+ * in timestamp order and reports the time taken.
+ */
+gboolean heap_benchmark(gint fps_n, gint fps_d, guint num_gops,
+		guint gop_size) {
+
+	MIX_RESULT mixresult;
+	MixFrameManager *fm = NULL;
+	MixVideoFrame *mvf = NULL;
+	MixVideoFrame *out[64];
+	GPtrArray *frames = NULL;
+	GPtrArray *fa = NULL;
+	GTimer *timer = NULL;
+	gboolean passed = FALSE;
+	guint64 pts = 0;
+	guint64 last_pts = 0;
+	guint num_out = 0;
+	guint num_batch = 0;
+	guint num_frames = num_gops * gop_size + 1;
+	guint idx, jdx;
+
+	fm = mix_framemanager_new();
+	if (!fm) {
+		goto cleanup;
+	}
+
+	mixresult = mix_framemanager_initialize(fm,
+			MIX_FRAMEORDER_MODE_DISPLAYORDER, fps_n, fps_d, TRUE);
+	if (mixresult != MIX_RESULT_SUCCESS) {
+		goto cleanup;
+	}
+
+	frames = g_ptr_array_sized_new(num_frames);
+	fa = g_ptr_array_sized_new(num_frames);
+	if (!frames || !fa) {
+		goto cleanup;
+	}
+
+	for (idx = 0; idx < num_frames; idx++) {
+		mvf = mix_videoframe_new();
+		if (!mvf) {
+			goto cleanup;
+		}
+
+		/* start at one frame duration, a zero timestamp is never expected */
+		pts = (idx + 1) * G_USEC_PER_SEC * G_GINT64_CONSTANT(1000) * fps_d / fps_n;
+		mix_videoframe_set_timestamp(mvf, pts);
+		g_ptr_array_add(frames, (gpointer) mvf);
+	}
+
+	/* I frame, then per GOP the anchor frame followed by its B frames */
+	g_ptr_array_add(fa, g_ptr_array_index(frames, 0));
+	for (idx = 0; idx < num_gops; idx++) {
+		guint lo = idx * gop_size;
+		g_ptr_array_add(fa, g_ptr_array_index(frames, lo + gop_size));
+		add_b_pyramid(fa, frames, lo, lo + gop_size);
+	}
+
+	timer = g_timer_new();
+
+	for (idx = 0; idx < num_frames; idx++) {
+		mixresult = mix_framemanager_enqueue(fm,
+				(MixVideoFrame *) g_ptr_array_index(fa, idx));
+		if (mixresult != MIX_RESULT_SUCCESS) {
+			goto cleanup;
+		}
+		g_ptr_array_index(fa, idx) = NULL;
+
+		while (mix_framemanager_dequeue_batch(fm, out, G_N_ELEMENTS(out),
+				&num_batch) == MIX_RESULT_SUCCESS) {
+			for (jdx = 0; jdx < num_batch; jdx++) {
+				mix_videoframe_get_timestamp(out[jdx], &pts);
+				if (pts < last_pts) {
+					g_print("out of order: %"G_GINT64_FORMAT" after %"G_GINT64_FORMAT"\n",
+							pts, last_pts);
+					goto cleanup;
+				}
+				last_pts = pts;
+				mix_videoframe_unref(out[jdx]);
+			}
+			num_out += num_batch;
+		}
+	}
+
+	g_timer_stop(timer);
+
+	g_print("%u frames, gop size %u: %u dequeued in order, %.3f ms\n",
+			num_frames, gop_size, num_out,
+			g_timer_elapsed(timer, NULL) * 1000);
+
+	passed = (num_out == num_frames);
+
+cleanup:
+
+	if (timer) {
+		g_timer_destroy(timer);
+	}
+
+	if (fa) {
+		for (idx = 0; idx < fa->len; idx++) {
+			mvf = (MixVideoFrame *) g_ptr_array_index(fa, idx);
+			if (mvf) {
+				mix_videoframe_unref(mvf);
+			}
+		}
+		g_ptr_array_free(fa, TRUE);
+	}
+
+	if (frames) {
+		g_ptr_array_free(frames, TRUE);
+	}
+
+	if (fm) {
+		mix_framemanager_unref(fm);
+	}
+
+	return passed;
+}
+
 int main() {
 	MIX_RESULT mixresult;
 
@@ -67,6 +203,13 @@ int main() {
 	/* first ting first */
 	g_type_init();
 
+	if (!heap_benchmark(fps_n, fps_d, 1024, 4)
+			|| !heap_benchmark(fps_n, fps_d, 512, 16)
+			|| !heap_benchmark(fps_n, fps_d, 256, 64)) {
+		g_print("frame manager benchmark failed\n");
+		return 1;
+	}
+
 	/* create frame manager */
 	fm = mix_framemanager_new();
 	if (!fm) {
@@ -75,7 +218,7 @@ int main() {
 
 	/* initialize frame manager */
 	mixresult = mix_framemanager_initialize(fm,
-			MIX_FRAMEORDER_MODE_DISPLAYORDER, fps_n, fps_d);
+			MIX_FRAMEORDER_MODE_DISPLAYORDER, fps_n, fps_d, TRUE);
 	if (mixresult != MIX_RESULT_SUCCESS) {
 		goto cleanup;
 	}
@@ -0,0 +1,16 @@
+LOCAL_PATH := $(call my-dir)
+
+# NV12 plane copy and chroma conversion, linked into libva_videodecoder and libva_videoencoder
+# =====================================================
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+    PlaneCopy.cpp \
+    PlaneConvert.c
+
+LOCAL_CFLAGS += -Werror
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libmix_planecopy
+
+include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,80 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "PlaneConvert.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static void interleaveRow(uint8_t *uv, const uint8_t *u, const uint8_t *v, uint32_t width) {
+    uint32_t i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= width; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(u + i));
+        __m128i y = _mm_loadu_si128((const __m128i *)(v + i));
+        _mm_storeu_si128((__m128i *)(uv + 2 * i), _mm_unpacklo_epi8(x, y));
+        _mm_storeu_si128((__m128i *)(uv + 2 * i + 16), _mm_unpackhi_epi8(x, y));
+    }
+#endif
+    for (; i < width; i++) {
+        uv[2 * i] = u[i];
+        uv[2 * i + 1] = v[i];
+    }
+}
+
+static void deinterleaveRow(uint8_t *u, uint8_t *v, const uint8_t *uv, uint32_t width) {
+    uint32_t i = 0;
+#ifdef __SSE2__
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    for (; i + 16 <= width; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(uv + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(uv + 2 * i + 16));
+        // even bytes are U, odd bytes are V; both fit in 8 bits so packus doesn't saturate
+        __m128i x = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+        __m128i y = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128((__m128i *)(u + i), x);
+        _mm_storeu_si128((__m128i *)(v + i), y);
+    }
+#endif
+    for (; i < width; i++) {
+        u[i] = uv[2 * i];
+        v[i] = uv[2 * i + 1];
+    }
+}
+
+void interleaveUV(uint8_t *dstUV, uint32_t dstPitch,
+                  const uint8_t *srcU, const uint8_t *srcV, uint32_t srcPitch,
+                  uint32_t width, uint32_t rows) {
+    uint32_t row;
+    for (row = 0; row < rows; row++) {
+        interleaveRow(dstUV, srcU, srcV, width);
+        dstUV += dstPitch;
+        srcU += srcPitch;
+        srcV += srcPitch;
+    }
+}
+
+void deinterleaveUV(uint8_t *dstU, uint8_t *dstV, uint32_t dstPitch,
+                    const uint8_t *srcUV, uint32_t srcPitch,
+                    uint32_t width, uint32_t rows) {
+    uint32_t row;
+    for (row = 0; row < rows; row++) {
+        deinterleaveRow(dstU, dstV, srcUV, width);
+        dstU += dstPitch;
+        dstV += dstPitch;
+        srcUV += srcPitch;
+    }
+}
@@ -0,0 +1,44 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef PLANE_CONVERT_H_
+#define PLANE_CONVERT_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Chroma conversion between planar (I420/YV12) and interleaved (NV12) layouts.
+// width is the number of chroma samples per row, pitches are in bytes. Plain C so
+// that the C libraries (mix_video) can build it too.
+
+// U and V planes to an interleaved UV plane (I420 to NV12)
+void interleaveUV(uint8_t *dstUV, uint32_t dstPitch,
+                  const uint8_t *srcU, const uint8_t *srcV, uint32_t srcPitch,
+                  uint32_t width, uint32_t rows);
+
+// interleaved UV plane to U and V planes (NV12 to I420)
+void deinterleaveUV(uint8_t *dstU, uint8_t *dstV, uint32_t dstPitch,
+                    const uint8_t *srcUV, uint32_t srcPitch,
+                    uint32_t width, uint32_t rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PLANE_CONVERT_H_
@@ -0,0 +1,267 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "PlaneCopy.h"
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+// number of row bands a large frame is split into, including the calling thread
+#define PLANE_COPY_MAX_BANDS    4
+// frames smaller than this (in luma pixels) are copied on the calling thread
+#define PLANE_COPY_BAND_THRESHOLD   (2560 * 1440)
+
+static void copyRow(uint8_t *dst, const uint8_t *src, uint32_t size) {
+#ifdef __SSE4_1__
+    // streaming loads need an aligned source; destination is stored unaligned
+    uint32_t head = (16 - ((uintptr_t)src & 15)) & 15;
+    if (head > size) {
+        head = size;
+    }
+    if (head) {
+        memcpy(dst, src, head);
+        dst += head;
+        src += head;
+        size -= head;
+    }
+
+    __m128i *s = (__m128i *)src;
+    __m128i *d = (__m128i *)dst;
+    uint32_t blocks = size >> 6;
+    for (uint32_t i = 0; i < blocks; i++) {
+        __m128i x0 = _mm_stream_load_si128(s);
+        __m128i x1 = _mm_stream_load_si128(s + 1);
+        __m128i x2 = _mm_stream_load_si128(s + 2);
+        __m128i x3 = _mm_stream_load_si128(s + 3);
+        _mm_storeu_si128(d, x0);
+        _mm_storeu_si128(d + 1, x1);
+        _mm_storeu_si128(d + 2, x2);
+        _mm_storeu_si128(d + 3, x3);
+        s += 4;
+        d += 4;
+    }
+    size &= 63;
+    while (size >= 16) {
+        _mm_storeu_si128(d++, _mm_stream_load_si128(s++));
+        size -= 16;
+    }
+    if (size) {
+        memcpy(d, s, size);
+    }
+#else
+    memcpy(dst, src, size);
+#endif
+}
+
+void copyPlane(uint8_t *dst, uint32_t dstPitch,
+               const uint8_t *src, uint32_t srcPitch,
+               uint32_t width, uint32_t rows) {
+#ifdef __SSE4_1__
+    // sync the wc memory data
+    _mm_mfence();
+#endif
+    if (srcPitch == width && dstPitch == width) {
+        copyRow(dst, src, width * rows);
+        return;
+    }
+    for (uint32_t row = 0; row < rows; row++) {
+        copyRow(dst, src, width);
+        dst += dstPitch;
+        src += srcPitch;
+    }
+}
+
+struct PlaneCopyJob {
+    uint8_t *dst[2];
+    const uint8_t *src[2];
+    uint32_t dstPitch[2];
+    uint32_t srcPitch[2];
+    uint32_t rows[2];
+    uint32_t width;
+};
+
+static void runJob(const PlaneCopyJob &job) {
+    for (int i = 0; i < 2; i++) {
+        if (job.rows[i]) {
+            copyPlane(job.dst[i], job.dstPitch[i], job.src[i], job.srcPitch[i], job.width, job.rows[i]);
+        }
+    }
+}
+
+// Worker threads live for the life of the process. One frame is copied at a time;
+// a caller finding the pool busy copies on its own thread instead of waiting.
+class PlaneCopyPool {
+public:
+    static PlaneCopyPool* getInstance(void);
+    int getBands(void) {return mNumWorkers + 1;}
+    bool run(const PlaneCopyJob *jobs, int count);
+
+private:
+    PlaneCopyPool();
+    static void* workerEntry(void *arg);
+    void workerLoop(int index);
+    static void createInstance(void);
+
+    static PlaneCopyPool *sInstance;
+    static pthread_once_t sOnce;
+
+    pthread_mutex_t mRunLock;   // held by the caller of run()
+    pthread_mutex_t mLock;
+    pthread_cond_t mWorkCond;
+    pthread_cond_t mDoneCond;
+    PlaneCopyJob mJobs[PLANE_COPY_MAX_BANDS - 1];
+    bool mHasJob[PLANE_COPY_MAX_BANDS - 1];
+    int mPending;
+    int mNumWorkers;
+};
+
+PlaneCopyPool *PlaneCopyPool::sInstance = NULL;
+pthread_once_t PlaneCopyPool::sOnce = PTHREAD_ONCE_INIT;
+
+PlaneCopyPool::PlaneCopyPool()
+    : mPending(0),
+      mNumWorkers(0) {
+    pthread_mutex_init(&mRunLock, NULL);
+    pthread_mutex_init(&mLock, NULL);
+    pthread_cond_init(&mWorkCond, NULL);
+    pthread_cond_init(&mDoneCond, NULL);
+    memset(mHasJob, 0, sizeof(mHasJob));
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = (cpus > PLANE_COPY_MAX_BANDS) ? PLANE_COPY_MAX_BANDS - 1 : (int)cpus - 1;
+    for (int i = 0; i < workers; i++) {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        // worker index is passed through the argument, the pool is a singleton
+        if (pthread_create(&thread, &attr, workerEntry, (void *)(intptr_t)i) == 0) {
+            mNumWorkers++;
+        }
+        pthread_attr_destroy(&attr);
+        if (mNumWorkers != i + 1) {
+            break;
+        }
+    }
+}
+
+void PlaneCopyPool::createInstance(void) {
+    sInstance = new PlaneCopyPool();
+}
+
+PlaneCopyPool* PlaneCopyPool::getInstance(void) {
+    pthread_once(&sOnce, createInstance);
+    return sInstance;
+}
+
+void* PlaneCopyPool::workerEntry(void *arg) {
+    // blocks in pthread_once until the constructor has returned
+    getInstance()->workerLoop((int)(intptr_t)arg);
+    return NULL;
+}
+
+void PlaneCopyPool::workerLoop(int index) {
+    while (true) {
+        pthread_mutex_lock(&mLock);
+        while (!mHasJob[index]) {
+            pthread_cond_wait(&mWorkCond, &mLock);
+        }
+        PlaneCopyJob job = mJobs[index];
+        pthread_mutex_unlock(&mLock);
+
+        runJob(job);
+
+        pthread_mutex_lock(&mLock);
+        mHasJob[index] = false;
+        if (--mPending == 0) {
+            pthread_cond_signal(&mDoneCond);
+        }
+        pthread_mutex_unlock(&mLock);
+    }
+}
+
+bool PlaneCopyPool::run(const PlaneCopyJob *jobs, int count) {
+    if (count - 1 > mNumWorkers || pthread_mutex_trylock(&mRunLock) != 0) {
+        return false;
+    }
+
+    pthread_mutex_lock(&mLock);
+    for (int i = 1; i < count; i++) {
+        mJobs[i - 1] = jobs[i];
+        mHasJob[i - 1] = true;
+    }
+    mPending = count - 1;
+    pthread_cond_broadcast(&mWorkCond);
+    pthread_mutex_unlock(&mLock);
+
+    runJob(jobs[0]);
+
+    pthread_mutex_lock(&mLock);
+    while (mPending) {
+        pthread_cond_wait(&mDoneCond, &mLock);
+    }
+    pthread_mutex_unlock(&mLock);
+
+    pthread_mutex_unlock(&mRunLock);
+    return true;
+}
+
+void copyNV12(const NV12Planes &dst, const NV12Planes &src, uint32_t width, uint32_t height) {
+    PlaneCopyJob jobs[PLANE_COPY_MAX_BANDS];
+    int bands = 1;
+    if (width * height >= PLANE_COPY_BAND_THRESHOLD) {
+        bands = PlaneCopyPool::getInstance()->getBands();
+    }
+
+    // split both planes into bands of even luma rows, so band i of Y and UV cover the same picture area
+    uint32_t uvRows = height / 2;
+    uint32_t bandUVRows = (uvRows + bands - 1) / bands;
+    for (int i = 0; i < bands; i++) {
+        uint32_t uvStart = i * bandUVRows;
+        uint32_t uvEnd = uvStart + bandUVRows;
+        if (uvStart > uvRows) {
+            uvStart = uvRows;
+        }
+        if (uvEnd > uvRows || i == bands - 1) {
+            uvEnd = uvRows;
+        }
+        uint32_t yStart = uvStart * 2;
+        uint32_t yEnd = (i == bands - 1) ? height : uvEnd * 2;
+
+        PlaneCopyJob &job = jobs[i];
+        job.width = width;
+        job.dst[0] = dst.y + yStart * dst.pitchY;
+        job.src[0] = src.y + yStart * src.pitchY;
+        job.dstPitch[0] = dst.pitchY;
+        job.srcPitch[0] = src.pitchY;
+        job.rows[0] = yEnd - yStart;
+        job.dst[1] = dst.uv + uvStart * dst.pitchUV;
+        job.src[1] = src.uv + uvStart * src.pitchUV;
+        job.dstPitch[1] = dst.pitchUV;
+        job.srcPitch[1] = src.pitchUV;
+        job.rows[1] = uvEnd - uvStart;
+    }
+
+    if (bands > 1 && PlaneCopyPool::getInstance()->run(jobs, bands)) {
+        return;
+    }
+    for (int i = 0; i < bands; i++) {
+        runJob(jobs[i]);
+    }
+}
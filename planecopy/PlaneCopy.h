@@ -0,0 +1,40 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef PLANE_COPY_H_
+#define PLANE_COPY_H_
+
+#include <stdint.h>
+
+// Y and interleaved UV plane of a NV12 frame
+struct NV12Planes {
+    uint8_t *y;
+    uint8_t *uv;
+    uint32_t pitchY;
+    uint32_t pitchUV;
+};
+
+// Copy rows of width bytes between two pitched planes. Source may be uncached
+// (write-combined) surface memory, it is read with streaming loads where available.
+void copyPlane(uint8_t *dst, uint32_t dstPitch,
+               const uint8_t *src, uint32_t srcPitch,
+               uint32_t width, uint32_t rows);
+
+// Copy width x height of a NV12 frame, cropping and converting pitch in one pass.
+// Large frames are split into row bands across a small worker pool.
+void copyNV12(const NV12Planes &dst, const NV12Planes &src, uint32_t width, uint32_t height);
+
+#endif  // PLANE_COPY_H_
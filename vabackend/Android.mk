@@ -0,0 +1,43 @@
+LOCAL_PATH := $(call my-dir)
+
+# libva or null VA backend, linked into libva_videodecoder and libva_videoencoder
+# =====================================================
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+    VABackend.cpp \
+    VABackendLibVA.cpp \
+    VABackendNull.cpp
+
+LOCAL_C_INCLUDES := \
+    $(TARGET_OUT_HEADERS)/libva
+
+LOCAL_COPY_HEADERS_TO  := libmix_vabackend
+
+LOCAL_COPY_HEADERS := \
+    VABackend.h
+
+LOCAL_CFLAGS += -Werror
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libva_backend
+
+include $(BUILD_STATIC_LIBRARY)
+
+# Null VA only, for host builds without libva/GPU
+# =====================================================
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+    VABackend.cpp \
+    VABackendNull.cpp
+
+LOCAL_C_INCLUDES := \
+    $(TARGET_OUT_HEADERS)/libva
+
+LOCAL_CFLAGS += -DVA_BACKEND_NULL_ONLY -Werror
+LOCAL_MODULE_TAGS := optional
+LOCAL_MODULE := libva_backend_null
+
+include $(BUILD_HOST_STATIC_LIBRARY)
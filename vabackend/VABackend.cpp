@@ -0,0 +1,68 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "VABackend.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef ANDROID
+#include <cutils/properties.h>
+#endif
+
+static bool readSetting(const char *property, const char *env, char *value, size_t size) {
+#ifdef ANDROID
+    char prop[PROPERTY_VALUE_MAX];
+    if (property_get(property, prop, NULL) > 0) {
+        strncpy(value, prop, size - 1);
+        value[size - 1] = '\0';
+        return true;
+    }
+#endif
+    const char *str = getenv(env);
+    if (str && str[0]) {
+        strncpy(value, str, size - 1);
+        value[size - 1] = '\0';
+        return true;
+    }
+    return false;
+}
+
+static const VABackend* selectBackend(void) {
+    char value[92];
+
+#ifndef VA_BACKEND_NULL_ONLY
+    bool useNull = false;
+    if (readSetting("libmix.va.backend", "LIBMIX_VA_BACKEND", value, sizeof(value))) {
+        useNull = (strcmp(value, "null") == 0);
+    }
+    if (!useNull) {
+        return getLibVABackend();
+    }
+#endif
+
+    if (readSetting("libmix.va.null.latency", "LIBMIX_NULLVA_LATENCY_US", value, sizeof(value))) {
+        setNullVALatency(atoi(value));
+    }
+    return getNullVABackend();
+}
+
+const VABackend* getVABackend(void) {
+    // selected once per process; concurrent first calls pick the same table
+    static const VABackend *sBackend = NULL;
+    if (sBackend == NULL) {
+        sBackend = selectBackend();
+    }
+    return sBackend;
+}
@@ -0,0 +1,111 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VA_BACKEND_H_
+#define VA_BACKEND_H_
+
+#include <va/va.h>
+#include <stdint.h>
+
+// Per-display counters collected by backends that can measure themselves.
+// The libva backend does not report statistics (QueryStats is NULL).
+struct VABackendStats {
+    uint32_t frames;          // number of vaEndPicture calls
+    uint32_t callsLastFrame;  // backend calls issued for the last frame
+    uint64_t calls;           // backend calls issued since vaInitialize
+    uint64_t buffersCreated;
+    uint64_t bytesCreated;
+    uint64_t hostTimeUs;      // caller time between frames, fake latency excluded
+    uint64_t lastFrameHostUs;
+    uint64_t maxFrameHostUs;
+};
+
+// Function table mirroring the subset of libva used by the video decoder and encoder.
+// Decoder and encoder call VA only through this table so that libva can be replaced
+// by an in-process implementation on hosts without a GPU.
+struct VABackend {
+    const char *name;
+
+    VADisplay (*GetDisplay)(void *nativeDisplay);
+    VAStatus (*Initialize)(VADisplay dpy, int *majorVersion, int *minorVersion);
+    VAStatus (*Terminate)(VADisplay dpy);
+
+    VAStatus (*QueryConfigEntrypoints)(VADisplay dpy, VAProfile profile,
+            VAEntrypoint *entrypoints, int *numEntrypoints);
+    VAStatus (*GetConfigAttributes)(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint,
+            VAConfigAttrib *attribList, int numAttribs);
+    VAStatus (*CreateConfig)(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint,
+            VAConfigAttrib *attribList, int numAttribs, VAConfigID *config);
+    VAStatus (*DestroyConfig)(VADisplay dpy, VAConfigID config);
+    VAStatus (*QuerySurfaceAttributes)(VADisplay dpy, VAConfigID config,
+            VASurfaceAttrib *attribList, unsigned int *numAttribs);
+
+    VAStatus (*CreateSurfaces)(VADisplay dpy, unsigned int format, unsigned int width,
+            unsigned int height, VASurfaceID *surfaces, unsigned int numSurfaces,
+            VASurfaceAttrib *attribList, unsigned int numAttribs);
+    VAStatus (*DestroySurfaces)(VADisplay dpy, VASurfaceID *surfaces, int numSurfaces);
+    VAStatus (*CreateContext)(VADisplay dpy, VAConfigID config, int pictureWidth,
+            int pictureHeight, int flag, VASurfaceID *renderTargets, int numRenderTargets,
+            VAContextID *context);
+    VAStatus (*DestroyContext)(VADisplay dpy, VAContextID context);
+
+    VAStatus (*CreateBuffer)(VADisplay dpy, VAContextID context, VABufferType type,
+            unsigned int size, unsigned int numElements, void *data, VABufferID *bufId);
+    VAStatus (*DestroyBuffer)(VADisplay dpy, VABufferID bufId);
+    VAStatus (*MapBuffer)(VADisplay dpy, VABufferID bufId, void **pbuf);
+    VAStatus (*UnmapBuffer)(VADisplay dpy, VABufferID bufId);
+
+    VAStatus (*BeginPicture)(VADisplay dpy, VAContextID context, VASurfaceID renderTarget);
+    VAStatus (*RenderPicture)(VADisplay dpy, VAContextID context, VABufferID *buffers,
+            int numBuffers);
+    VAStatus (*EndPicture)(VADisplay dpy, VAContextID context);
+
+    VAStatus (*SyncSurface)(VADisplay dpy, VASurfaceID renderTarget);
+    VAStatus (*QuerySurfaceStatus)(VADisplay dpy, VASurfaceID renderTarget,
+            VASurfaceStatus *status);
+    VAStatus (*QuerySurfaceError)(VADisplay dpy, VASurfaceID surface, VAStatus errorStatus,
+            void **errorInfo);
+    VAStatus (*DeriveImage)(VADisplay dpy, VASurfaceID surface, VAImage *image);
+    VAStatus (*DestroyImage)(VADisplay dpy, VAImageID image);
+    VAStatus (*SetDisplayAttributes)(VADisplay dpy, VADisplayAttribute *attrList,
+            int numAttributes);
+
+    // va_tpi / driver private extensions
+    VAStatus (*SetTimestampForSurface)(VADisplay dpy, VASurfaceID surface,
+            long long timestamp);
+    VAStatus (*LockSurface)(VADisplay dpy, VASurfaceID surface, unsigned int *fourcc,
+            unsigned int *lumaStride, unsigned int *chromaUStride, unsigned int *chromaVStride,
+            unsigned int *lumaOffset, unsigned int *chromaUOffset, unsigned int *chromaVOffset,
+            unsigned int *bufferName, void **buffer);
+    VAStatus (*UnlockSurface)(VADisplay dpy, VASurfaceID surface);
+
+    // optional, may be NULL
+    VAStatus (*QueryStats)(VADisplay dpy, VABackendStats *stats);
+};
+
+// Backend talking to the real libva driver. Not available in host-only builds.
+const VABackend* getLibVABackend(void);
+
+// In-process software stand-in: surfaces are malloc'd NV12 planes and buffers are heap
+// blobs. Every surface completes "latencyUs" microseconds after vaEndPicture.
+const VABackend* getNullVABackend(void);
+void setNullVALatency(uint32_t latencyUs);
+
+// Backend selected for this process. "libmix.va.backend" property (Android) or
+// LIBMIX_VA_BACKEND environment variable set to "null" selects the null backend.
+const VABackend* getVABackend(void);
+
+#endif  // VA_BACKEND_H_
@@ -0,0 +1,84 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "VABackend.h"
+#include <va/va_android.h>
+#include <va/va_tpi.h>
+
+extern "C" {
+VAStatus vaLockSurface(VADisplay dpy,
+    VASurfaceID surface,
+    unsigned int *fourcc,
+    unsigned int *luma_stride,
+    unsigned int *chroma_u_stride,
+    unsigned int *chroma_v_stride,
+    unsigned int *luma_offset,
+    unsigned int *chroma_u_offset,
+    unsigned int *chroma_v_offset,
+    unsigned int *buffer_name,
+    void **buffer
+);
+
+VAStatus vaUnlockSurface(VADisplay dpy,
+    VASurfaceID surface
+);
+}
+
+// vaGetDisplay takes the platform specific native display type
+static VADisplay libvaGetDisplay(void *nativeDisplay) {
+    return vaGetDisplay((Display *)nativeDisplay);
+}
+
+static VAStatus libvaSetTimestampForSurface(VADisplay dpy, VASurfaceID surface, long long timestamp) {
+    return vaSetTimestampForSurface(dpy, surface, timestamp);
+}
+
+static const VABackend sLibVABackend = {
+    "libva",
+    libvaGetDisplay,
+    vaInitialize,
+    vaTerminate,
+    vaQueryConfigEntrypoints,
+    vaGetConfigAttributes,
+    vaCreateConfig,
+    vaDestroyConfig,
+    vaQuerySurfaceAttributes,
+    vaCreateSurfaces,
+    vaDestroySurfaces,
+    vaCreateContext,
+    vaDestroyContext,
+    vaCreateBuffer,
+    vaDestroyBuffer,
+    vaMapBuffer,
+    vaUnmapBuffer,
+    vaBeginPicture,
+    vaRenderPicture,
+    vaEndPicture,
+    vaSyncSurface,
+    vaQuerySurfaceStatus,
+    vaQuerySurfaceError,
+    vaDeriveImage,
+    vaDestroyImage,
+    vaSetDisplayAttributes,
+    libvaSetTimestampForSurface,
+    vaLockSurface,
+    vaUnlockSurface,
+    NULL,
+};
+
+const VABackend* getLibVABackend(void) {
+    return &sLibVABackend;
+}
@@ -0,0 +1,662 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+// Null VA: an in-process stand-in for libva used to measure the CPU-side cost of the
+// decoder/encoder on machines without a GPU. No pixel is ever decoded or encoded; the
+// backend only keeps enough state for the callers to run their normal code paths.
+
+#define LOG_TAG "NullVA"
+
+#include "VABackend.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#ifdef ANDROID
+#include <cutils/log.h>
+#else
+#include <stdio.h>
+#define ALOGI(format, ...) fprintf(stderr, LOG_TAG ": " format "\n", ##__VA_ARGS__)
+#define ALOGV(format, ...)
+#endif
+
+#define NULL_VA_MAGIC           0x4E554C4C
+#define NULL_VA_MAX_OBJECTS     4096
+#define NULL_VA_MAX_RENDER      256
+#define NULL_VA_CODED_PAYLOAD   64
+
+enum NullObjectType {
+    NULL_OBJECT_FREE = 0,
+    NULL_OBJECT_CONFIG,
+    NULL_OBJECT_CONTEXT,
+    NULL_OBJECT_SURFACE,
+    NULL_OBJECT_BUFFER,
+    NULL_OBJECT_IMAGE,
+};
+
+struct NullSurface {
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t size;
+    uint8_t *data;      // NV12, Y plane followed by interleaved UV plane
+    uint64_t readyTime; // time (us) at which the pending picture completes
+    int32_t locked;
+};
+
+struct NullBuffer {
+    VABufferType type;
+    uint32_t size;
+    uint32_t numElements;
+    uint8_t *data;
+    bool external;      // data is owned by a surface (derived image)
+    bool rendered;      // consumed by vaRenderPicture, released at vaEndPicture
+};
+
+struct NullObject {
+    NullObjectType type;
+    union {
+        struct {
+            VAProfile profile;
+            VAEntrypoint entrypoint;
+        } config;
+        struct {
+            VASurfaceID target;
+        } context;
+        NullSurface surface;
+        NullBuffer buffer;
+        struct {
+            VABufferID buf;
+        } image;
+    } u;
+};
+
+struct NullDisplay {
+    uint32_t magic;
+    pthread_mutex_t lock;
+    NullObject objects[NULL_VA_MAX_OBJECTS];
+    uint32_t nextFree; // search hint
+    VABufferID rendered[NULL_VA_MAX_RENDER];
+    int32_t numRendered;
+    uint64_t frameStart;
+    uint64_t sleptUs;  // fake latency spent inside the backend during this frame
+    VABackendStats stats;
+};
+
+static uint32_t sNullLatencyUs = 0;
+
+static uint64_t nowUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static NullDisplay* toDisplay(VADisplay dpy) {
+    NullDisplay *d = (NullDisplay *)dpy;
+    if (d == NULL || d->magic != NULL_VA_MAGIC) {
+        return NULL;
+    }
+    return d;
+}
+
+// object IDs are index + 1 so that 0 never aliases a valid object
+static uint32_t allocObject(NullDisplay *d, NullObjectType type) {
+    for (uint32_t n = 0; n < NULL_VA_MAX_OBJECTS; n++) {
+        uint32_t i = (d->nextFree + n) % NULL_VA_MAX_OBJECTS;
+        if (d->objects[i].type == NULL_OBJECT_FREE) {
+            memset(&d->objects[i], 0, sizeof(NullObject));
+            d->objects[i].type = type;
+            d->nextFree = (i + 1) % NULL_VA_MAX_OBJECTS;
+            return i + 1;
+        }
+    }
+    return VA_INVALID_ID;
+}
+
+static NullObject* getObject(NullDisplay *d, uint32_t id, NullObjectType type) {
+    if (id == 0 || id > NULL_VA_MAX_OBJECTS) {
+        return NULL;
+    }
+    NullObject *obj = &d->objects[id - 1];
+    return obj->type == type ? obj : NULL;
+}
+
+static void freeObject(NullDisplay *d, uint32_t id) {
+    NullObject *obj = &d->objects[id - 1];
+    if (obj->type == NULL_OBJECT_SURFACE) {
+        free(obj->u.surface.data);
+    } else if (obj->type == NULL_OBJECT_BUFFER && !obj->u.buffer.external) {
+        free(obj->u.buffer.data);
+    }
+    obj->type = NULL_OBJECT_FREE;
+}
+
+// undoes a partly done create call, whose caller never gets the IDs
+static void freeObjects(NullDisplay *d, const uint32_t *ids, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        freeObject(d, ids[i]);
+    }
+}
+
+#define NULL_VA_ENTER(dpy) \
+    NullDisplay *d = toDisplay(dpy); \
+    if (d == NULL) { \
+        return VA_STATUS_ERROR_INVALID_DISPLAY; \
+    } \
+    pthread_mutex_lock(&d->lock); \
+    d->stats.calls++; \
+    d->stats.callsLastFrame++
+
+#define NULL_VA_LEAVE(status) \
+    pthread_mutex_unlock(&d->lock); \
+    return status
+
+static VADisplay nullGetDisplay(void *nativeDisplay) {
+    NullDisplay *d = (NullDisplay *)calloc(1, sizeof(NullDisplay));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->magic = NULL_VA_MAGIC;
+    pthread_mutex_init(&d->lock, NULL);
+    return (VADisplay)d;
+}
+
+static VAStatus nullInitialize(VADisplay dpy, int *majorVersion, int *minorVersion) {
+    NULL_VA_ENTER(dpy);
+    *majorVersion = VA_MAJOR_VERSION;
+    *minorVersion = VA_MINOR_VERSION;
+    memset(&d->stats, 0, sizeof(d->stats));
+    d->frameStart = nowUs();
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullTerminate(VADisplay dpy) {
+    NullDisplay *d = toDisplay(dpy);
+    if (d == NULL) {
+        return VA_STATUS_ERROR_INVALID_DISPLAY;
+    }
+    if (d->stats.frames) {
+        ALOGI("%u frames, %llu calls, %llu buffers (%llu bytes), host overhead avg %llu us max %llu us per frame",
+            d->stats.frames, (unsigned long long)d->stats.calls,
+            (unsigned long long)d->stats.buffersCreated, (unsigned long long)d->stats.bytesCreated,
+            (unsigned long long)(d->stats.hostTimeUs / d->stats.frames),
+            (unsigned long long)d->stats.maxFrameHostUs);
+    }
+    for (uint32_t i = 0; i < NULL_VA_MAX_OBJECTS; i++) {
+        if (d->objects[i].type != NULL_OBJECT_FREE) {
+            freeObject(d, i + 1);
+        }
+    }
+    d->magic = 0;
+    pthread_mutex_destroy(&d->lock);
+    free(d);
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQueryConfigEntrypoints(VADisplay dpy, VAProfile profile,
+        VAEntrypoint *entrypoints, int *numEntrypoints) {
+    NULL_VA_ENTER(dpy);
+    entrypoints[0] = VAEntrypointVLD;
+    entrypoints[1] = VAEntrypointEncSlice;
+    *numEntrypoints = 2;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullGetConfigAttributes(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint,
+        VAConfigAttrib *attribList, int numAttribs) {
+    NULL_VA_ENTER(dpy);
+    for (int i = 0; i < numAttribs; i++) {
+        switch (attribList[i].type) {
+            case VAConfigAttribRTFormat:
+                attribList[i].value = VA_RT_FORMAT_YUV420;
+                break;
+            case VAConfigAttribRateControl:
+                attribList[i].value = VA_RC_NONE | VA_RC_CBR | VA_RC_VBR;
+                break;
+            default:
+                attribList[i].value = VA_ATTRIB_NOT_SUPPORTED;
+                break;
+        }
+    }
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullCreateConfig(VADisplay dpy, VAProfile profile, VAEntrypoint entrypoint,
+        VAConfigAttrib *attribList, int numAttribs, VAConfigID *config) {
+    NULL_VA_ENTER(dpy);
+    uint32_t id = allocObject(d, NULL_OBJECT_CONFIG);
+    if (id == VA_INVALID_ID) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+    }
+    d->objects[id - 1].u.config.profile = profile;
+    d->objects[id - 1].u.config.entrypoint = entrypoint;
+    *config = id;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullDestroyConfig(VADisplay dpy, VAConfigID config) {
+    NULL_VA_ENTER(dpy);
+    if (getObject(d, config, NULL_OBJECT_CONFIG) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_CONFIG);
+    }
+    freeObject(d, config);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullQuerySurfaceAttributes(VADisplay dpy, VAConfigID config,
+        VASurfaceAttrib *attribList, unsigned int *numAttribs) {
+    NULL_VA_ENTER(dpy);
+    // only plain VA memory is supported
+    *numAttribs = 0;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullCreateSurfaces(VADisplay dpy, unsigned int format, unsigned int width,
+        unsigned int height, VASurfaceID *surfaces, unsigned int numSurfaces,
+        VASurfaceAttrib *attribList, unsigned int numAttribs) {
+    NULL_VA_ENTER(dpy);
+    uint32_t pitch = (width + 63) & ~63;
+    uint32_t alignedHeight = (height + 31) & ~31;
+    for (unsigned int i = 0; i < numSurfaces; i++) {
+        uint32_t id = allocObject(d, NULL_OBJECT_SURFACE);
+        if (id == VA_INVALID_ID) {
+            freeObjects(d, surfaces, i);
+            NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+        }
+        NullSurface *s = &d->objects[id - 1].u.surface;
+        s->width = width;
+        s->height = height;
+        s->pitch = pitch;
+        s->size = pitch * alignedHeight * 3 / 2;
+        s->data = (uint8_t *)malloc(s->size);
+        if (s->data == NULL) {
+            freeObject(d, id);
+            freeObjects(d, surfaces, i);
+            NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+        }
+        // black NV12 frame
+        memset(s->data, 0x10, pitch * alignedHeight);
+        memset(s->data + pitch * alignedHeight, 0x80, pitch * alignedHeight / 2);
+        surfaces[i] = id;
+    }
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullDestroySurfaces(VADisplay dpy, VASurfaceID *surfaces, int numSurfaces) {
+    NULL_VA_ENTER(dpy);
+    for (int i = 0; i < numSurfaces; i++) {
+        if (getObject(d, surfaces[i], NULL_OBJECT_SURFACE)) {
+            freeObject(d, surfaces[i]);
+        }
+    }
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullCreateContext(VADisplay dpy, VAConfigID config, int pictureWidth,
+        int pictureHeight, int flag, VASurfaceID *renderTargets, int numRenderTargets,
+        VAContextID *context) {
+    NULL_VA_ENTER(dpy);
+    if (getObject(d, config, NULL_OBJECT_CONFIG) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_CONFIG);
+    }
+    uint32_t id = allocObject(d, NULL_OBJECT_CONTEXT);
+    if (id == VA_INVALID_ID) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+    }
+    d->objects[id - 1].u.context.target = VA_INVALID_SURFACE;
+    *context = id;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullDestroyContext(VADisplay dpy, VAContextID context) {
+    NULL_VA_ENTER(dpy);
+    if (getObject(d, context, NULL_OBJECT_CONTEXT) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_CONTEXT);
+    }
+    freeObject(d, context);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullCreateBuffer(VADisplay dpy, VAContextID context, VABufferType type,
+        unsigned int size, unsigned int numElements, void *data, VABufferID *bufId) {
+    NULL_VA_ENTER(dpy);
+    uint32_t total = size * numElements;
+    if (type == VAEncCodedBufferType) {
+        // room for the segment header returned by vaMapBuffer
+        total += sizeof(VACodedBufferSegment);
+    }
+    uint32_t id = allocObject(d, NULL_OBJECT_BUFFER);
+    if (id == VA_INVALID_ID) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+    }
+    NullBuffer *b = &d->objects[id - 1].u.buffer;
+    b->type = type;
+    b->size = size;
+    b->numElements = numElements;
+    b->data = (uint8_t *)malloc(total ? total : 1);
+    if (b->data == NULL) {
+        freeObject(d, id);
+        NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+    }
+    if (data) {
+        memcpy(b->data, data, size * numElements);
+    }
+    d->stats.buffersCreated++;
+    d->stats.bytesCreated += total;
+    *bufId = id;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullDestroyBuffer(VADisplay dpy, VABufferID bufId) {
+    NULL_VA_ENTER(dpy);
+    if (getObject(d, bufId, NULL_OBJECT_BUFFER) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_BUFFER);
+    }
+    freeObject(d, bufId);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullMapBuffer(VADisplay dpy, VABufferID bufId, void **pbuf) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, bufId, NULL_OBJECT_BUFFER);
+    if (obj == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_BUFFER);
+    }
+    NullBuffer *b = &obj->u.buffer;
+    if (b->type == VAEncCodedBufferType) {
+        // a single segment holding an IDR slice NAL with a filler payload
+        VACodedBufferSegment *seg = (VACodedBufferSegment *)b->data;
+        uint8_t *payload = b->data + sizeof(VACodedBufferSegment);
+        uint32_t size = b->size < NULL_VA_CODED_PAYLOAD ? b->size : NULL_VA_CODED_PAYLOAD;
+        memset(seg, 0, sizeof(VACodedBufferSegment));
+        memset(payload, 0xAA, size);
+        if (size >= 5) {
+            payload[0] = payload[1] = payload[2] = 0;
+            payload[3] = 1;
+            payload[4] = 0x65;
+        }
+        seg->size = size;
+        seg->buf = payload;
+        seg->next = NULL;
+    }
+    *pbuf = b->data;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullUnmapBuffer(VADisplay dpy, VABufferID bufId) {
+    NULL_VA_ENTER(dpy);
+    if (getObject(d, bufId, NULL_OBJECT_BUFFER) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_BUFFER);
+    }
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullBeginPicture(VADisplay dpy, VAContextID context, VASurfaceID renderTarget) {
+    NULL_VA_ENTER(dpy);
+    NullObject *ctx = getObject(d, context, NULL_OBJECT_CONTEXT);
+    if (ctx == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_CONTEXT);
+    }
+    if (getObject(d, renderTarget, NULL_OBJECT_SURFACE) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_SURFACE);
+    }
+    ctx->u.context.target = renderTarget;
+    d->numRendered = 0;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullRenderPicture(VADisplay dpy, VAContextID context, VABufferID *buffers,
+        int numBuffers) {
+    NULL_VA_ENTER(dpy);
+    if (getObject(d, context, NULL_OBJECT_CONTEXT) == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_CONTEXT);
+    }
+    for (int i = 0; i < numBuffers; i++) {
+        NullObject *obj = getObject(d, buffers[i], NULL_OBJECT_BUFFER);
+        if (obj == NULL) {
+            NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_BUFFER);
+        }
+        if (obj->u.buffer.rendered || d->numRendered >= NULL_VA_MAX_RENDER) {
+            continue;
+        }
+        obj->u.buffer.rendered = true;
+        d->rendered[d->numRendered++] = buffers[i];
+    }
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullEndPicture(VADisplay dpy, VAContextID context) {
+    NULL_VA_ENTER(dpy);
+    NullObject *ctx = getObject(d, context, NULL_OBJECT_CONTEXT);
+    if (ctx == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_CONTEXT);
+    }
+    // like the hardware drivers, parameter and slice buffers are consumed by the picture
+    for (int32_t i = 0; i < d->numRendered; i++) {
+        NullObject *obj = getObject(d, d->rendered[i], NULL_OBJECT_BUFFER);
+        if (obj && obj->u.buffer.type != VAEncCodedBufferType) {
+            freeObject(d, d->rendered[i]);
+        } else if (obj) {
+            obj->u.buffer.rendered = false;
+        }
+    }
+    d->numRendered = 0;
+
+    NullObject *target = getObject(d, ctx->u.context.target, NULL_OBJECT_SURFACE);
+    uint64_t now = nowUs();
+    if (target) {
+        target->u.surface.readyTime = now + sNullLatencyUs;
+    }
+
+    uint64_t hostUs = now - d->frameStart;
+    hostUs = hostUs > d->sleptUs ? hostUs - d->sleptUs : 0;
+    d->stats.frames++;
+    d->stats.hostTimeUs += hostUs;
+    d->stats.lastFrameHostUs = hostUs;
+    if (hostUs > d->stats.maxFrameHostUs) {
+        d->stats.maxFrameHostUs = hostUs;
+    }
+    ALOGV("frame %u: %u calls, host overhead %llu us", d->stats.frames,
+        d->stats.callsLastFrame, (unsigned long long)hostUs);
+    d->stats.callsLastFrame = 0;
+    d->frameStart = now;
+    d->sleptUs = 0;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullSyncSurface(VADisplay dpy, VASurfaceID renderTarget) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, renderTarget, NULL_OBJECT_SURFACE);
+    if (obj == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_SURFACE);
+    }
+    uint64_t now = nowUs();
+    uint64_t ready = obj->u.surface.readyTime;
+    pthread_mutex_unlock(&d->lock);
+
+    // simulated hardware latency, excluded from the host overhead
+    if (ready > now) {
+        usleep(ready - now);
+        pthread_mutex_lock(&d->lock);
+        d->sleptUs += ready - now;
+        pthread_mutex_unlock(&d->lock);
+    }
+    return VA_STATUS_SUCCESS;
+}
+
+static VAStatus nullQuerySurfaceStatus(VADisplay dpy, VASurfaceID renderTarget,
+        VASurfaceStatus *status) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, renderTarget, NULL_OBJECT_SURFACE);
+    if (obj == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_SURFACE);
+    }
+    *status = (nowUs() >= obj->u.surface.readyTime) ? VASurfaceReady : VASurfaceRendering;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullQuerySurfaceError(VADisplay dpy, VASurfaceID surface, VAStatus errorStatus,
+        void **errorInfo) {
+    NULL_VA_ENTER(dpy);
+    // the null backend never produces decoding errors
+    *errorInfo = NULL;
+    NULL_VA_LEAVE(VA_STATUS_ERROR_UNIMPLEMENTED);
+}
+
+static VAStatus nullDeriveImage(VADisplay dpy, VASurfaceID surface, VAImage *image) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, surface, NULL_OBJECT_SURFACE);
+    if (obj == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_SURFACE);
+    }
+    NullSurface *s = &obj->u.surface;
+    uint32_t imageId = allocObject(d, NULL_OBJECT_IMAGE);
+    uint32_t bufId = allocObject(d, NULL_OBJECT_BUFFER);
+    if (imageId == VA_INVALID_ID || bufId == VA_INVALID_ID) {
+        if (imageId != VA_INVALID_ID) freeObject(d, imageId);
+        if (bufId != VA_INVALID_ID) freeObject(d, bufId);
+        NULL_VA_LEAVE(VA_STATUS_ERROR_ALLOCATION_FAILED);
+    }
+    NullBuffer *b = &d->objects[bufId - 1].u.buffer;
+    b->type = VAImageBufferType;
+    b->size = s->size;
+    b->numElements = 1;
+    b->data = s->data;
+    b->external = true;
+    d->objects[imageId - 1].u.image.buf = bufId;
+
+    memset(image, 0, sizeof(VAImage));
+    image->image_id = imageId;
+    image->buf = bufId;
+    image->format.fourcc = VA_FOURCC_NV12;
+    image->format.byte_order = VA_LSB_FIRST;
+    image->format.bits_per_pixel = 12;
+    image->width = s->width;
+    image->height = s->height;
+    image->data_size = s->size;
+    image->num_planes = 2;
+    image->pitches[0] = s->pitch;
+    image->pitches[1] = s->pitch;
+    image->offsets[0] = 0;
+    image->offsets[1] = s->pitch * ((s->height + 31) & ~31);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullDestroyImage(VADisplay dpy, VAImageID image) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, image, NULL_OBJECT_IMAGE);
+    if (obj == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_IMAGE);
+    }
+    if (getObject(d, obj->u.image.buf, NULL_OBJECT_BUFFER)) {
+        freeObject(d, obj->u.image.buf);
+    }
+    freeObject(d, image);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullSetDisplayAttributes(VADisplay dpy, VADisplayAttribute *attrList,
+        int numAttributes) {
+    NULL_VA_ENTER(dpy);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullSetTimestampForSurface(VADisplay dpy, VASurfaceID surface,
+        long long timestamp) {
+    NULL_VA_ENTER(dpy);
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullLockSurface(VADisplay dpy, VASurfaceID surface, unsigned int *fourcc,
+        unsigned int *lumaStride, unsigned int *chromaUStride, unsigned int *chromaVStride,
+        unsigned int *lumaOffset, unsigned int *chromaUOffset, unsigned int *chromaVOffset,
+        unsigned int *bufferName, void **buffer) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, surface, NULL_OBJECT_SURFACE);
+    if (obj == NULL) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_SURFACE);
+    }
+    NullSurface *s = &obj->u.surface;
+    s->locked++;
+    *fourcc = VA_FOURCC_NV12;
+    *lumaStride = s->pitch;
+    *chromaUStride = s->pitch;
+    *chromaVStride = s->pitch;
+    *lumaOffset = 0;
+    *chromaUOffset = s->pitch * ((s->height + 31) & ~31);
+    *chromaVOffset = *chromaUOffset + 1;
+    *bufferName = surface;
+    *buffer = s->data;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullUnlockSurface(VADisplay dpy, VASurfaceID surface) {
+    NULL_VA_ENTER(dpy);
+    NullObject *obj = getObject(d, surface, NULL_OBJECT_SURFACE);
+    if (obj == NULL || obj->u.surface.locked == 0) {
+        NULL_VA_LEAVE(VA_STATUS_ERROR_INVALID_SURFACE);
+    }
+    obj->u.surface.locked--;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static VAStatus nullQueryStats(VADisplay dpy, VABackendStats *stats) {
+    NULL_VA_ENTER(dpy);
+    *stats = d->stats;
+    NULL_VA_LEAVE(VA_STATUS_SUCCESS);
+}
+
+static const VABackend sNullVABackend = {
+    "null",
+    nullGetDisplay,
+    nullInitialize,
+    nullTerminate,
+    nullQueryConfigEntrypoints,
+    nullGetConfigAttributes,
+    nullCreateConfig,
+    nullDestroyConfig,
+    nullQuerySurfaceAttributes,
+    nullCreateSurfaces,
+    nullDestroySurfaces,
+    nullCreateContext,
+    nullDestroyContext,
+    nullCreateBuffer,
+    nullDestroyBuffer,
+    nullMapBuffer,
+    nullUnmapBuffer,
+    nullBeginPicture,
+    nullRenderPicture,
+    nullEndPicture,
+    nullSyncSurface,
+    nullQuerySurfaceStatus,
+    nullQuerySurfaceError,
+    nullDeriveImage,
+    nullDestroyImage,
+    nullSetDisplayAttributes,
+    nullSetTimestampForSurface,
+    nullLockSurface,
+    nullUnlockSurface,
+    nullQueryStats,
+};
+
+const VABackend* getNullVABackend(void) {
+    return &sNullVABackend;
+}
+
+void setNullVALatency(uint32_t latencyUs) {
+    sNullLatencyUs = latencyUs;
+}
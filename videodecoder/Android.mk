@@ -13,6 +13,7 @@ LOCAL_SRC_FILES := \
     VideoDecoderMPEG4.cpp \
     VideoDecoderMPEG2.cpp \
     VideoDecoderAVC.cpp \
+    VideoDecoderOutputQueue.cpp \
     VideoDecoderTrace.cpp
 
 # VideoDecoderHost.cpp includes VideoDecoderWMV.h,
@@ -21,7 +22,9 @@ LOCAL_CLANG_CFLAGS += -Wno-overloaded-virtual
 
 LOCAL_C_INCLUDES := \
     $(TARGET_OUT_HEADERS)/libva \
-    $(TARGET_OUT_HEADERS)/libmixvbp
+    $(TARGET_OUT_HEADERS)/libmixvbp \
+    $(LOCAL_PATH)/../vabackend \
+    $(LOCAL_PATH)/../planecopy
 
 ifeq ($(USE_INTEL_SECURE_AVC),true)
 LOCAL_CFLAGS += -DUSE_INTEL_SECURE_AVC
@@ -54,6 +57,10 @@ ifneq ($(filter $(TARGET_BOARD_PLATFORM),$(PLATFORM_SUPPORT_SLICE_HEADER_PARSER)
     LOCAL_CFLAGS += -DUSE_SLICE_HEADER_PARSING
 endif
 
+LOCAL_STATIC_LIBRARIES := \
+    libva_backend \
+    libmix_planecopy
+
 LOCAL_SHARED_LIBRARIES := \
     libcutils \
     libva \
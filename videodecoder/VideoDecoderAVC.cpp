@@ -17,7 +17,9 @@
 #include "VideoDecoderAVC.h"
 #include "VideoDecoderTrace.h"
 #include <string.h>
+#include <stdlib.h>
 #include <cutils/properties.h>
+#include <sys/time.h>
 
 // Macros for actual buffer needed calculation
 #define WIDI_CONSUMED   6
@@ -25,19 +27,45 @@
 #define NW_CONSUMED     2
 #define POC_DEFAULT     0x7FFFFFFF
 
+#ifndef USE_AVC_SHORT_FORMAT
+#define AVC_SLICE_PARAM_SIZE sizeof(VASliceParameterBufferH264)
+#else
+#define AVC_SLICE_PARAM_SIZE sizeof(VASliceParameterBufferH264Base)
+#endif
+
 VideoDecoderAVC::VideoDecoderAVC(const char *mimeType)
     : VideoDecoderBase(mimeType, VBP_H264),
       mToggleDPB(0),
       mErrorConcealment(false),
-      mAdaptive(false){
+      mAdaptive(false),
+      mBatchSlices(false),
+      mBatchPicBufferCount(0),
+      mBatchSliceParams(NULL),
+      mBatchSliceCount(0),
+      mBatchSliceCapacity(0),
+      mBatchSliceData(NULL),
+      mBatchSliceDataSize(0),
+      mBatchSliceDataCapacity(0),
+      mVACallsInFrame(0),
+      mVACallsLastFrame(0),
+      mDecodeAhead(false),
+      mDecodeAheadExit(false),
+      mDecodeAheadHead(0),
+      mDecodeAheadCount(0),
+      mDecodeAheadRetry(NULL),
+      mDecodeAheadStatus(DECODE_SUCCESS) {
 
     invalidateDPB(0);
     invalidateDPB(1);
     mLastPictureFlags = VA_PICTURE_H264_INVALID;
+    pthread_mutex_init(&mDecodeAheadLock, NULL);
+    pthread_cond_init(&mDecodeAheadCond, NULL);
 }
 
 VideoDecoderAVC::~VideoDecoderAVC() {
     stop();
+    pthread_mutex_destroy(&mDecodeAheadLock);
+    pthread_cond_destroy(&mDecodeAheadCond);
 }
 
 Decode_Status VideoDecoderAVC::start(VideoConfigBuffer *buffer) {
@@ -52,6 +80,14 @@ Decode_Status VideoDecoderAVC::start(VideoConfigBuffer *buffer) {
     VideoDecoderBase::setOutputMethod(OUTPUT_BY_POC);
 
     mErrorConcealment = buffer->flag & WANT_ERROR_CONCEALMENT;
+    mBatchSlices = buffer->flag & WANT_BATCHED_SLICES;
+    if (mBatchSlices) {
+        ITRACE("Slices are submitted per picture.");
+    }
+    if (buffer->flag & WANT_DECODE_AHEAD) {
+        status = startDecodeAhead();
+        CHECK_STATUS("startDecodeAhead");
+    }
     if (buffer->data == NULL || buffer->size == 0) {
         WTRACE("No config data to start VA.");
         if ((buffer->flag & HAS_SURFACE_NUMBER) && (buffer->flag & HAS_VA_PROFILE)) {
@@ -70,6 +106,8 @@ Decode_Status VideoDecoderAVC::start(VideoConfigBuffer *buffer) {
 }
 
 void VideoDecoderAVC::stop(void) {
+    // frames not submitted yet are dropped
+    stopDecodeAhead();
     // drop the last  frame and ignore return value
     endDecodingFrame(true);
     VideoDecoderBase::stop();
@@ -77,16 +115,62 @@ void VideoDecoderAVC::stop(void) {
     invalidateDPB(1);
     mToggleDPB = 0;
     mErrorConcealment = false;
+    mBatchSlices = false;
+    releaseSliceBatch();
     mLastPictureFlags = VA_PICTURE_H264_INVALID;
 }
 
 void VideoDecoderAVC::flush(void) {
+    if (mDecodeAhead) {
+        pthread_mutex_lock(&mDecodeAheadLock);
+        discardDecodeAhead();
+    }
     // drop the frame and ignore return value
     VideoDecoderBase::flush();
     invalidateDPB(0);
     invalidateDPB(1);
     mToggleDPB = 0;
     mLastPictureFlags = VA_PICTURE_H264_INVALID;
+    if (mDecodeAhead) {
+        pthread_mutex_unlock(&mDecodeAheadLock);
+    }
+}
+
+void VideoDecoderAVC::freeSurfaceBuffers(void) {
+    if (mDecodeAhead) {
+        pthread_mutex_lock(&mDecodeAheadLock);
+        discardDecodeAhead();
+    }
+    VideoDecoderBase::freeSurfaceBuffers();
+    if (mDecodeAhead) {
+        pthread_mutex_unlock(&mDecodeAheadLock);
+    }
+}
+
+const VideoRenderBuffer* VideoDecoderAVC::getOutput(bool draining, VideoErrorBuffer *outErrBuf) {
+    if (!mDecodeAhead) {
+        return VideoDecoderBase::getOutput(draining, outErrBuf);
+    }
+
+    pthread_mutex_lock(&mDecodeAheadLock);
+    // all frames must be submitted before the last one is completed. Queued frames may
+    // wait for surfaces that only output returns, so never wait for them here: output
+    // what is decoded already and let the client call again.
+    for (int32_t retry = 0; draining && !drainDecodeAhead(); retry++) {
+        const VideoRenderBuffer *output = VideoDecoderBase::getOutput(false, outErrBuf);
+        if (output != NULL || retry == DECODE_AHEAD_DRAIN_RETRIES) {
+            if (output == NULL) {
+                WTRACE("%d frames submitted ahead still wait for a surface.", mDecodeAheadCount);
+            }
+            pthread_mutex_unlock(&mDecodeAheadLock);
+            return output;
+        }
+        // nothing to output, surfaces are held by the client until it renders them
+        waitDecodeAhead(DECODE_AHEAD_SURFACE_WAIT_MS);
+    }
+    const VideoRenderBuffer *output = VideoDecoderBase::getOutput(draining, outErrBuf);
+    pthread_mutex_unlock(&mDecodeAheadLock);
+    return output;
 }
 
 Decode_Status VideoDecoderAVC::decode(VideoDecodeBuffer *buffer) {
@@ -95,6 +179,43 @@ Decode_Status VideoDecoderAVC::decode(VideoDecodeBuffer *buffer) {
     if (buffer == NULL) {
         return DECODE_INVALID_DATA;
     }
+
+    if (mDecodeAhead) {
+        pthread_mutex_lock(&mDecodeAheadLock);
+        if (mDecodeAheadStatus == DECODE_FORMAT_CHANGE) {
+            // report before this buffer is consumed, the client sends it again after reconfiguration
+            mDecodeAheadStatus = DECODE_SUCCESS;
+            pthread_mutex_unlock(&mDecodeAheadLock);
+            return DECODE_FORMAT_CHANGE;
+        }
+        if (mDecodeAheadStatus != DECODE_SUCCESS) {
+            WTRACE("Frame submitted ahead failed (status = %d).", mDecodeAheadStatus);
+            mDecodeAheadStatus = DECODE_SUCCESS;
+        }
+        if (mDecodeAheadRetry) {
+            // buffer was parsed already, retry it without parsing again
+            if (!drainDecodeAhead()) {
+                pthread_mutex_unlock(&mDecodeAheadLock);
+                return DECODE_NO_SURFACE;
+            }
+            DecodeAheadItem *item = mDecodeAheadRetry;
+            mDecodeAheadRetry = NULL;
+            status = decodeParsedBuffer(buffer, &item->data);
+            pthread_mutex_unlock(&mDecodeAheadLock);
+            freeDecodeAheadItem(item);
+            return status;
+        }
+        while (mDecodeAheadCount == DECODE_AHEAD_DEPTH) {
+            if (!checkBufferAvail()) {
+                // submit thread waits for a surface, the client retries this buffer when one is returned
+                pthread_mutex_unlock(&mDecodeAheadLock);
+                return DECODE_NO_SURFACE;
+            }
+            waitDecodeAhead(DECODE_AHEAD_SURFACE_WAIT_MS);
+        }
+        pthread_mutex_unlock(&mDecodeAheadLock);
+    }
+
     status =  VideoDecoderBase::parseBuffer(
             buffer->data,
             buffer->size,
@@ -102,6 +223,32 @@ Decode_Status VideoDecoderAVC::decode(VideoDecodeBuffer *buffer) {
             (void**)&data);
     CHECK_STATUS("VideoDecoderBase::parseBuffer");
 
+    if (mDecodeAhead) {
+        // mVAStarted and mSizeChanged are written by decodeFrame on the submit thread
+        pthread_mutex_lock(&mDecodeAheadLock);
+        if (mVAStarted && canDecodeAhead(data)) {
+            status = queueDecodeAhead(buffer, data);
+            pthread_mutex_unlock(&mDecodeAheadLock);
+            return status;
+        }
+        // new sequence, packed frame etc. are decoded on the caller's thread once the queue is empty
+        if (!drainDecodeAhead()) {
+            // same as running out of surfaces in decodeFrame, the client sends the buffer again.
+            // Keep the parsed data as parsing it twice would lose new SPS/PPS.
+            mDecodeAheadRetry = snapshotFrame(buffer, data);
+            pthread_mutex_unlock(&mDecodeAheadLock);
+            return mDecodeAheadRetry ? DECODE_NO_SURFACE : DECODE_MEMORY_FAIL;
+        }
+        status = decodeParsedBuffer(buffer, data);
+        pthread_mutex_unlock(&mDecodeAheadLock);
+        return status;
+    }
+
+    return decodeParsedBuffer(buffer, data);
+}
+
+Decode_Status VideoDecoderAVC::decodeParsedBuffer(VideoDecodeBuffer *buffer, vbp_data_h264 *data) {
+    Decode_Status status;
     if (!mVAStarted) {
          if (data->has_sps && data->has_pps) {
             status = startVA(data);
@@ -310,8 +457,13 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
         }
         if (mDecodingFrame) {
             // interlace content, complete decoding the first field
-            vaStatus = vaEndPicture(mVADisplay, mVAContext);
+            if (mBatchSlices) {
+                status = submitSliceBatch();
+                CHECK_STATUS("submitSliceBatch");
+            }
+            vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
             CHECK_VA_STATUS("vaEndPicture");
+            mVACallsInFrame++;
 
             // for interlace content, top field may be valid only after the second field is parsed
             int32_t poc = getPOC(&(picParam->CurrPic));
@@ -331,13 +483,14 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
         status = updateReferenceFrames(picData);
         CHECK_STATUS("updateReferenceFrames");
 #endif
-        vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+        vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
         CHECK_VA_STATUS("vaBeginPicture");
+        mVACallsInFrame++;
 
         // start decoding a frame
         mDecodingFrame = true;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -348,7 +501,7 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
         CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -361,11 +514,21 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
     }
 
 #ifndef USE_AVC_SHORT_FORMAT
-
     status = setReference(sliceParam);
     CHECK_STATUS("setReference");
+#endif
 
-    vaStatus = vaCreateBuffer(
+    if (mBatchSlices) {
+        // picture level buffers are rendered together with the slices at the end of the picture
+        for (uint32_t i = 0; i < bufferIDCount; i++) {
+            mBatchPicBufferIDs[mBatchPicBufferCount++] = bufferIDs[i];
+        }
+        mVACallsInFrame += bufferIDCount;
+        return queueSlice(sliceParam, sliceData->buffer_addr + sliceData->slice_offset, sliceData->slice_size);
+    }
+
+#ifndef USE_AVC_SHORT_FORMAT
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -374,7 +537,7 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
         sliceParam,
         &bufferIDs[bufferIDCount]);
 #else
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -386,7 +549,7 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
     CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceDataBufferType,
@@ -397,16 +560,137 @@ Decode_Status VideoDecoderAVC::decodeSlice(vbp_data_h264 *data, uint32_t picInde
     CHECK_VA_STATUS("vaCreateSliceDataBuffer");
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
+        mVADisplay,
+        mVAContext,
+        bufferIDs,
+        bufferIDCount);
+    CHECK_VA_STATUS("vaRenderPicture");
+    mVACallsInFrame += bufferIDCount + 1;
+
+    return DECODE_SUCCESS;
+}
+
+Decode_Status VideoDecoderAVC::queueSlice(VASliceParameterBufferH264 *sliceParam, uint8_t *sliceData, uint32_t sliceSize) {
+    if (mBatchSliceCount == mBatchSliceCapacity) {
+        uint32_t capacity = mBatchSliceCapacity ? mBatchSliceCapacity * 2 : 32;
+        uint8_t *params = (uint8_t *)realloc(mBatchSliceParams, capacity * AVC_SLICE_PARAM_SIZE);
+        if (params == NULL) {
+            return DECODE_MEMORY_FAIL;
+        }
+        mBatchSliceParams = params;
+        mBatchSliceCapacity = capacity;
+    }
+    if (mBatchSliceDataSize + sliceSize > mBatchSliceDataCapacity) {
+        uint32_t capacity = mBatchSliceDataCapacity ? mBatchSliceDataCapacity : 256 * 1024;
+        while (capacity < mBatchSliceDataSize + sliceSize) {
+            capacity *= 2;
+        }
+        uint8_t *data = (uint8_t *)realloc(mBatchSliceData, capacity);
+        if (data == NULL) {
+            return DECODE_MEMORY_FAIL;
+        }
+        mBatchSliceData = data;
+        mBatchSliceDataCapacity = capacity;
+    }
+
+    // slice data of the picture is concatenated, slice_data_offset locates each slice
+    VASliceParameterBufferH264 *param =
+        (VASliceParameterBufferH264 *)(mBatchSliceParams + mBatchSliceCount * AVC_SLICE_PARAM_SIZE);
+    memcpy(param, sliceParam, AVC_SLICE_PARAM_SIZE);
+    param->slice_data_offset = mBatchSliceDataSize;
+    memcpy(mBatchSliceData + mBatchSliceDataSize, sliceData, sliceSize);
+    mBatchSliceDataSize += sliceSize;
+    mBatchSliceCount++;
+    return DECODE_SUCCESS;
+}
+
+Decode_Status VideoDecoderAVC::submitSliceBatch(void) {
+    VAStatus vaStatus;
+    // picture parameter, IQMatrix, slice parameter array, slice data
+    VABufferID bufferIDs[4];
+    uint32_t bufferIDCount = 0;
+    uint32_t sliceCount = mBatchSliceCount;
+    uint32_t sliceDataSize = mBatchSliceDataSize;
+
+    for (uint32_t i = 0; i < mBatchPicBufferCount; i++) {
+        bufferIDs[bufferIDCount++] = mBatchPicBufferIDs[i];
+    }
+    // the batch is consumed whether or not the submission succeeds
+    mBatchPicBufferCount = 0;
+    mBatchSliceCount = 0;
+    mBatchSliceDataSize = 0;
+
+    if (sliceCount == 0) {
+        return DECODE_SUCCESS;
+    }
+
+    vaStatus = mVA->CreateBuffer(
+        mVADisplay,
+        mVAContext,
+        VASliceParameterBufferType,
+        AVC_SLICE_PARAM_SIZE,
+        sliceCount,
+        mBatchSliceParams,
+        &bufferIDs[bufferIDCount]);
+    CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
+    bufferIDCount++;
+
+    vaStatus = mVA->CreateBuffer(
+        mVADisplay,
+        mVAContext,
+        VASliceDataBufferType,
+        sliceDataSize,
+        1,
+        mBatchSliceData,
+        &bufferIDs[bufferIDCount]);
+    CHECK_VA_STATUS("vaCreateSliceDataBuffer");
+    bufferIDCount++;
+
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
         bufferIDCount);
     CHECK_VA_STATUS("vaRenderPicture");
+    mVACallsInFrame += 3;
 
     return DECODE_SUCCESS;
 }
 
+void VideoDecoderAVC::releaseSliceBatch(void) {
+    free(mBatchSliceParams);
+    free(mBatchSliceData);
+    mBatchSliceParams = NULL;
+    mBatchSliceData = NULL;
+    mBatchPicBufferCount = 0;
+    mBatchSliceCount = 0;
+    mBatchSliceCapacity = 0;
+    mBatchSliceDataSize = 0;
+    mBatchSliceDataCapacity = 0;
+}
+
+Decode_Status VideoDecoderAVC::endDecodingFrame(bool dropFrame) {
+    Decode_Status status;
+
+    if (mDecodingFrame) {
+        if (mBatchSlices) {
+            status = submitSliceBatch();
+            if (status != DECODE_SUCCESS) {
+                // picture is incomplete and can't be output
+                VideoDecoderBase::endDecodingFrame(true);
+                mVACallsInFrame = 0;
+                return status;
+            }
+        }
+        // count vaEndPicture
+        mVACallsLastFrame = mVACallsInFrame + 1;
+        mVACallsInFrame = 0;
+        VTRACE("%d VA calls issued for this frame", mVACallsLastFrame);
+    }
+    return VideoDecoderBase::endDecodingFrame(dropFrame);
+}
+
 Decode_Status VideoDecoderAVC::setReference(VASliceParameterBufferH264 *sliceParam) {
     int32_t numList = 1;
     // TODO: set numList to 0 if it is I slice
@@ -998,7 +1282,7 @@ Decode_Status VideoDecoderAVC::checkHardwareCapability() {
     VAConfigAttrib cfgAttribs[2];
     cfgAttribs[0].type = VAConfigAttribMaxPictureWidth;
     cfgAttribs[1].type = VAConfigAttribMaxPictureHeight;
-    vaStatus = vaGetConfigAttributes(mVADisplay, VAProfileH264High,
+    vaStatus = mVA->GetConfigAttributes(mVADisplay, VAProfileH264High,
             VAEntrypointVLD, cfgAttribs, 2);
     CHECK_VA_STATUS("vaGetConfigAttributes");
     if (cfgAttribs[0].value * cfgAttribs[1].value < (uint32_t)mVideoFormatInfo.width * (uint32_t)mVideoFormatInfo.height) {
@@ -1027,7 +1311,7 @@ Decode_Status VideoDecoderAVC::getCodecSpecificConfigs(
     attrib[1].type = VAConfigAttribDecSliceMode;
     attrib[1].value = VA_DEC_SLICE_MODE_NORMAL;
 
-    vaStatus = vaGetConfigAttributes(mVADisplay,profile,VAEntrypointVLD, &attrib[1], 1);
+    vaStatus = mVA->GetConfigAttributes(mVADisplay,profile,VAEntrypointVLD, &attrib[1], 1);
 
     if (attrib[1].value & VA_DEC_SLICE_MODE_BASE) {
         ITRACE("AVC short format used");
@@ -1040,7 +1324,7 @@ Decode_Status VideoDecoderAVC::getCodecSpecificConfigs(
         return DECODE_FAIL;
     }
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay,
             profile,
             VAEntrypointVLD,
@@ -1052,3 +1336,214 @@ Decode_Status VideoDecoderAVC::getCodecSpecificConfigs(
     return DECODE_SUCCESS;
 }
 #endif
+
+Decode_Status VideoDecoderAVC::startDecodeAhead(void) {
+    if (mDecodeAhead) {
+        return DECODE_SUCCESS;
+    }
+
+    mDecodeAheadExit = false;
+    mDecodeAheadHead = 0;
+    mDecodeAheadCount = 0;
+    mDecodeAheadRetry = NULL;
+    mDecodeAheadStatus = DECODE_SUCCESS;
+    if (pthread_create(&mSubmitThread, NULL, submitThreadEntry, this) != 0) {
+        ETRACE("Failed to create submit thread, frames are submitted on the caller's thread.");
+        return DECODE_SUCCESS;
+    }
+    mDecodeAhead = true;
+    ITRACE("Frames are submitted to VA ahead of parsing.");
+    return DECODE_SUCCESS;
+}
+
+void VideoDecoderAVC::stopDecodeAhead(void) {
+    if (!mDecodeAhead) {
+        return;
+    }
+
+    pthread_mutex_lock(&mDecodeAheadLock);
+    mDecodeAheadExit = true;
+    pthread_cond_broadcast(&mDecodeAheadCond);
+    pthread_mutex_unlock(&mDecodeAheadLock);
+    pthread_join(mSubmitThread, NULL);
+
+    discardDecodeAhead();
+    mDecodeAhead = false;
+}
+
+bool VideoDecoderAVC::canDecodeAhead(vbp_data_h264 *data) {
+    // called with mDecodeAheadLock held. Anything that changes the sequence or needs
+    // an answer for this buffer (format change, packed frame) is decoded synchronously
+    return data->has_sps && data->has_pps &&
+        !data->new_sps && !data->new_pps &&
+        data->num_pictures == 1 &&
+        !mSizeChanged;
+}
+
+Decode_Status VideoDecoderAVC::queueDecodeAhead(VideoDecodeBuffer *buffer, vbp_data_h264 *data) {
+    // called with mDecodeAheadLock held.
+    // parser data and input buffer are reused once decode returns, submit thread works on a copy
+    DecodeAheadItem *item = snapshotFrame(buffer, data);
+    if (item == NULL) {
+        return DECODE_MEMORY_FAIL;
+    }
+
+    uint32_t tail = (mDecodeAheadHead + mDecodeAheadCount) % DECODE_AHEAD_DEPTH;
+    mDecodeAheadQueue[tail] = item;
+    mDecodeAheadCount++;
+    pthread_cond_broadcast(&mDecodeAheadCond);
+    return DECODE_SUCCESS;
+}
+
+bool VideoDecoderAVC::drainDecodeAhead(void) {
+    // called with mDecodeAheadLock held. Gives up when the submit thread waits
+    // for a surface, as the caller may be the one to return it.
+    while (mDecodeAheadCount > 0 && !mDecodeAheadExit) {
+        if (!checkBufferAvail()) {
+            return false;
+        }
+        waitDecodeAhead(DECODE_AHEAD_SURFACE_WAIT_MS);
+    }
+    return true;
+}
+
+void VideoDecoderAVC::waitDecodeAhead(int32_t ms) {
+    struct timeval now;
+    struct timespec timeout;
+    gettimeofday(&now, NULL);
+    int64_t nsec = now.tv_usec * 1000LL + ms * 1000000LL;
+    timeout.tv_sec = now.tv_sec + nsec / 1000000000LL;
+    timeout.tv_nsec = nsec % 1000000000LL;
+    pthread_cond_timedwait(&mDecodeAheadCond, &mDecodeAheadLock, &timeout);
+}
+
+void VideoDecoderAVC::discardDecodeAhead(void) {
+    // called with mDecodeAheadLock held, or after the submit thread exited
+    while (mDecodeAheadCount > 0) {
+        freeDecodeAheadItem(mDecodeAheadQueue[mDecodeAheadHead]);
+        mDecodeAheadQueue[mDecodeAheadHead] = NULL;
+        mDecodeAheadHead = (mDecodeAheadHead + 1) % DECODE_AHEAD_DEPTH;
+        mDecodeAheadCount--;
+    }
+    freeDecodeAheadItem(mDecodeAheadRetry);
+    mDecodeAheadRetry = NULL;
+    mDecodeAheadStatus = DECODE_SUCCESS;
+    pthread_cond_broadcast(&mDecodeAheadCond);
+}
+
+void* VideoDecoderAVC::submitThreadEntry(void *arg) {
+    ((VideoDecoderAVC *)arg)->submitLoop();
+    return NULL;
+}
+
+void VideoDecoderAVC::submitLoop(void) {
+    pthread_mutex_lock(&mDecodeAheadLock);
+    while (!mDecodeAheadExit) {
+        if (mDecodeAheadCount == 0) {
+            pthread_cond_wait(&mDecodeAheadCond, &mDecodeAheadLock);
+            continue;
+        }
+
+        if (!checkBufferAvail()) {
+            // wait for the client to return a surface instead of failing the frame.
+            // renderDone may be set without a call into the decoder, so poll.
+            waitDecodeAhead(DECODE_AHEAD_SURFACE_WAIT_MS);
+            continue;
+        }
+
+        DecodeAheadItem *item = mDecodeAheadQueue[mDecodeAheadHead];
+        VideoDecoderBase::setRotationDegrees(item->buffer.rotationDegrees);
+        Decode_Status status = decodeFrame(&item->buffer, &item->data);
+        if (status != DECODE_SUCCESS && mDecodeAheadStatus == DECODE_SUCCESS) {
+            mDecodeAheadStatus = status;
+        }
+
+        freeDecodeAheadItem(item);
+        mDecodeAheadQueue[mDecodeAheadHead] = NULL;
+        mDecodeAheadHead = (mDecodeAheadHead + 1) % DECODE_AHEAD_DEPTH;
+        mDecodeAheadCount--;
+        pthread_cond_broadcast(&mDecodeAheadCond);
+    }
+    pthread_mutex_unlock(&mDecodeAheadLock);
+}
+
+VideoDecoderAVC::DecodeAheadItem* VideoDecoderAVC::snapshotFrame(VideoDecodeBuffer *buffer, vbp_data_h264 *data) {
+    DecodeAheadItem *item = new DecodeAheadItem;
+    if (item == NULL) {
+        return NULL;
+    }
+    memset(item, 0, sizeof(DecodeAheadItem));
+
+    item->bitstream = new uint8_t [buffer->size];
+    item->data.pic_data = new vbp_picture_data_h264 [data->num_pictures];
+    item->data.IQ_matrix_buf = new VAIQMatrixBufferH264;
+    item->data.codec_data = new vbp_codec_data_h264;
+    if (item->bitstream == NULL || item->data.pic_data == NULL ||
+        item->data.IQ_matrix_buf == NULL || item->data.codec_data == NULL) {
+        freeDecodeAheadItem(item);
+        return NULL;
+    }
+    memset(item->data.pic_data, 0, sizeof(vbp_picture_data_h264) * data->num_pictures);
+
+    memcpy(item->bitstream, buffer->data, buffer->size);
+    item->buffer = *buffer;
+    item->buffer.data = item->bitstream;
+    item->buffer.ext = NULL;
+
+    // keep the deep copies allocated above while copying the rest of the parser data
+    vbp_picture_data_h264 *picData = item->data.pic_data;
+    VAIQMatrixBufferH264 *iqMatrix = item->data.IQ_matrix_buf;
+    vbp_codec_data_h264 *codecData = item->data.codec_data;
+    item->data = *data;
+    item->data.pic_data = picData;
+    item->data.IQ_matrix_buf = iqMatrix;
+    item->data.codec_data = codecData;
+    *iqMatrix = *(data->IQ_matrix_buf);
+    *codecData = *(data->codec_data);
+
+    for (uint32_t i = 0; i < data->num_pictures; i++) {
+        vbp_picture_data_h264 *src = &data->pic_data[i];
+        vbp_picture_data_h264 *dst = &picData[i];
+        *dst = *src;
+        dst->pic_parms = NULL;
+        dst->slc_data = NULL;
+        dst->num_slices = 0;
+
+        dst->pic_parms = new VAPictureParameterBufferH264;
+        dst->slc_data = new vbp_slice_data_h264 [src->num_slices];
+        if (dst->pic_parms == NULL || dst->slc_data == NULL) {
+            freeDecodeAheadItem(item);
+            return NULL;
+        }
+        *(dst->pic_parms) = *(src->pic_parms);
+        dst->num_slices = src->num_slices;
+
+        for (uint32_t j = 0; j < src->num_slices; j++) {
+            dst->slc_data[j] = src->slc_data[j];
+            // slice data points into the input buffer, move it to the copy
+            uint8_t *addr = src->slc_data[j].buffer_addr;
+            if (addr >= buffer->data && addr < buffer->data + buffer->size) {
+                dst->slc_data[j].buffer_addr = item->bitstream + (addr - buffer->data);
+            }
+        }
+    }
+    return item;
+}
+
+void VideoDecoderAVC::freeDecodeAheadItem(DecodeAheadItem *item) {
+    if (item == NULL) {
+        return;
+    }
+    if (item->data.pic_data) {
+        for (uint32_t i = 0; i < item->data.num_pictures; i++) {
+            // pictures not copied yet have both pointers NULL
+            delete item->data.pic_data[i].pic_parms;
+            delete [] item->data.pic_data[i].slc_data;
+        }
+        delete [] item->data.pic_data;
+    }
+    delete item->data.IQ_matrix_buf;
+    delete item->data.codec_data;
+    delete [] item->bitstream;
+    delete item;
+}
@@ -29,12 +29,21 @@ public:
     virtual void stop(void);
     virtual void flush(void);
     virtual Decode_Status decode(VideoDecodeBuffer *buffer);
+    virtual void freeSurfaceBuffers(void);
+    virtual const VideoRenderBuffer* getOutput(bool draining = false, VideoErrorBuffer *outErrBuf = NULL);
+    // number of VA calls (create/render/begin/end) issued for the last decoded frame
+    uint32_t getVACallsPerFrame(void) {return mVACallsLastFrame;}
 
 protected:
+    Decode_Status decodeParsedBuffer(VideoDecodeBuffer *buffer, vbp_data_h264 *data);
     virtual Decode_Status decodeFrame(VideoDecodeBuffer *buffer, vbp_data_h264 *data);
     virtual Decode_Status beginDecodingFrame(vbp_data_h264 *data);
     virtual Decode_Status continueDecodingFrame(vbp_data_h264 *data);
     virtual Decode_Status decodeSlice(vbp_data_h264 *data, uint32_t picIndex, uint32_t sliceIndex);
+    virtual Decode_Status endDecodingFrame(bool dropFrame);
+    Decode_Status queueSlice(VASliceParameterBufferH264 *sliceParam, uint8_t *sliceData, uint32_t sliceSize);
+    Decode_Status submitSliceBatch(void);
+    void releaseSliceBatch(void);
     Decode_Status setReference(VASliceParameterBufferH264 *sliceParam);
     Decode_Status updateDPB(VAPictureParameterBufferH264 *picParam);
     Decode_Status updateReferenceFrames(vbp_picture_data_h264 *picData);
@@ -78,6 +87,58 @@ private:
     VideoExtensionBuffer mExtensionBuffer;
     PackedFrameData mPackedFrame;
     bool mAdaptive;
+
+    // slice batching: all slices of a picture are rendered with one vaRenderPicture
+    bool mBatchSlices;
+    VABufferID mBatchPicBufferIDs[2]; // picture parameter and IQ matrix
+    uint32_t mBatchPicBufferCount;
+    uint8_t *mBatchSliceParams;
+    uint32_t mBatchSliceCount;
+    uint32_t mBatchSliceCapacity;
+    uint8_t *mBatchSliceData;
+    uint32_t mBatchSliceDataSize;
+    uint32_t mBatchSliceDataCapacity;
+    uint32_t mVACallsInFrame;
+    uint32_t mVACallsLastFrame;
+
+    // decode ahead: parsed frames are snapshotted and submitted to VA by mSubmitThread
+    struct DecodeAheadItem {
+        VideoDecodeBuffer buffer;
+        vbp_data_h264 data;
+        uint8_t *bitstream;
+    };
+
+    enum {
+        DECODE_AHEAD_DEPTH = 2,
+        // poll interval while waiting for the client to return a surface
+        DECODE_AHEAD_SURFACE_WAIT_MS = 5,
+        // polls of getOutput at EOS while there is nothing to output yet
+        DECODE_AHEAD_DRAIN_RETRIES = 40,
+    };
+
+    Decode_Status startDecodeAhead(void);
+    void stopDecodeAhead(void);
+    bool canDecodeAhead(vbp_data_h264 *data);
+    Decode_Status queueDecodeAhead(VideoDecodeBuffer *buffer, vbp_data_h264 *data);
+    bool drainDecodeAhead(void);
+    void waitDecodeAhead(int32_t ms);
+    void discardDecodeAhead(void);
+    void submitLoop(void);
+    static void* submitThreadEntry(void *arg);
+    static DecodeAheadItem* snapshotFrame(VideoDecodeBuffer *buffer, vbp_data_h264 *data);
+    static void freeDecodeAheadItem(DecodeAheadItem *item);
+
+    bool mDecodeAhead;
+    bool mDecodeAheadExit;
+    pthread_t mSubmitThread;
+    // held while a frame is submitted, by both the caller and the submit thread
+    pthread_mutex_t mDecodeAheadLock;
+    pthread_cond_t mDecodeAheadCond;
+    DecodeAheadItem *mDecodeAheadQueue[DECODE_AHEAD_DEPTH];
+    uint32_t mDecodeAheadHead;
+    uint32_t mDecodeAheadCount;
+    DecodeAheadItem *mDecodeAheadRetry; // parsed buffer waiting for the queue to drain
+    Decode_Status mDecodeAheadStatus; // first error of a frame submitted ahead
 };
 
 
@@ -19,9 +19,7 @@
 #include <string.h>
 #include <va/va_android.h>
 #include <va/va_tpi.h>
-#ifdef  __SSE4_1__
-#include "use_util_sse4.h"
-#endif
+#include "PlaneCopy.h"
 
 #define INVALID_PTS ((uint64_t)-1)
 #define MAXIMUM_POC  0x7FFFFFFF
@@ -32,6 +30,7 @@ VideoDecoderBase::VideoDecoderBase(const char *mimeType, _vbp_parser_type type)
     : mInitialized(false),
       mLowDelay(false),
       mStoreMetaData(false),
+      mVA(getVABackend()),
       mDisplay(NULL),
       mVADisplay(NULL),
       mVAContext(VA_INVALID_ID),
@@ -49,16 +48,18 @@ VideoDecoderBase::VideoDecoderBase(const char *mimeType, _vbp_parser_type type)
       mErrReportEnabled(false),
       mWiDiOn(false),
       mRawOutput(false),
+      mRawOutputView(false),
       mManageReference(true),
       mOutputMethod(OUTPUT_BY_PCT),
       mNumSurfaces(0),
       mSurfaceBuffers(NULL),
-      mOutputHead(NULL),
-      mOutputTail(NULL),
       mSurfaces(NULL),
       mVASurfaceAttrib(NULL),
       mSurfaceUserPtr(NULL),
       mSurfaceAcquirePos(0),
+      mSharedSurfaceHead(NULL),
+      mSharedSurfaceNext(NULL),
+      mSharedSurfaceFrom(NULL),
       mNextOutputPOC(MINIMUM_POC),
       mParserType(type),
       mParserHandle(NULL),
@@ -142,6 +143,12 @@ Decode_Status VideoDecoderBase::start(VideoConfigBuffer *buffer) {
     if (mRawOutput) {
         WTRACE("Output is raw data.");
     }
+    // surfaces can only be mapped up front when they are allocated by the decoder
+    mRawOutputView = mRawOutput && (buffer->flag & WANT_RAW_OUTPUT_VIEW) &&
+        !(buffer->flag & USE_NATIVE_GRAPHIC_BUFFER);
+    if (mRawOutputView) {
+        WTRACE("Raw data is output as view of the surface.");
+    }
 
     return DECODE_SUCCESS;
 }
@@ -174,6 +181,12 @@ Decode_Status VideoDecoderBase::reset(VideoConfigBuffer *buffer) {
     if (mRawOutput) {
         WTRACE("Output is raw data.");
     }
+    // surfaces can only be mapped up front when they are allocated by the decoder
+    mRawOutputView = mRawOutput && (buffer->flag & WANT_RAW_OUTPUT_VIEW) &&
+        !(buffer->flag & USE_NATIVE_GRAPHIC_BUFFER);
+    if (mRawOutputView) {
+        WTRACE("Raw data is output as view of the surface.");
+    }
     return DECODE_SUCCESS;
 }
 
@@ -193,6 +206,7 @@ void VideoDecoderBase::stop(void) {
     mLowDelay = false;
     mStoreMetaData = false;
     mRawOutput = false;
+    mRawOutputView = false;
     mNumSurfaces = 0;
     mSurfaceAcquirePos = 0;
     mNextOutputPOC = MINIMUM_POC;
@@ -215,7 +229,7 @@ void VideoDecoderBase::flush(void) {
 
     endDecodingFrame(true);
 
-    VideoSurfaceBuffer *p = mOutputHead;
+    VideoSurfaceBuffer *p = mOutputQueue.head();
     // check if there's buffer with DRC flag in the output queue
     while (p) {
         if (p->renderBuffer.flag & IS_RESOLUTION_CHANGE) {
@@ -232,8 +246,7 @@ void VideoDecoderBase::flush(void) {
     mAcquiredBuffer = NULL;
     mLastReference = NULL;
     mForwardReference = NULL;
-    mOutputHead = NULL;
-    mOutputTail = NULL;
+    mOutputQueue.clear();
     mDecodingFrame = false;
 
     // flush vbp parser
@@ -274,15 +287,7 @@ const VideoFormatInfo* VideoDecoderBase::getFormatInfo(void) {
 }
 
 int VideoDecoderBase::getOutputQueueLength(void) {
-    VideoSurfaceBuffer *p = mOutputHead;
-
-    int i = 0;
-    while (p) {
-        p = p->next;
-        i++;
-    }
-
-    return i;
+    return mOutputQueue.length();
 }
 
 const VideoRenderBuffer* VideoDecoderBase::getOutput(bool draining, VideoErrorBuffer *outErrBuf) {
@@ -296,24 +301,21 @@ const VideoRenderBuffer* VideoDecoderBase::getOutput(bool draining, VideoErrorBu
         endDecodingFrame(false);
     }
 
-    if (mOutputHead == NULL) {
+    if (mOutputQueue.head() == NULL) {
         return NULL;
     }
 
     // output by position (the first buffer)
-    VideoSurfaceBuffer *outputByPos = mOutputHead;
+    VideoSurfaceBuffer *outputByPos = mOutputQueue.head();
 
     if (mLowDelay) {
-        mOutputHead = mOutputHead->next;
-        if (mOutputHead == NULL) {
-            mOutputTail = NULL;
-        }
-        vaSetTimestampForSurface(mVADisplay, outputByPos->renderBuffer.surface, outputByPos->renderBuffer.timeStamp);
+        mOutputQueue.remove(outputByPos);
+        mVA->SetTimestampForSurface(mVADisplay, outputByPos->renderBuffer.surface, outputByPos->renderBuffer.timeStamp);
         if (useGraphicBuffer && !mUseGEN) {
-            vaSyncSurface(mVADisplay, outputByPos->renderBuffer.surface);
+            mVA->SyncSurface(mVADisplay, outputByPos->renderBuffer.surface);
             fillDecodingErrors(&(outputByPos->renderBuffer));
         }
-        if (draining && mOutputTail == NULL) {
+        if (draining && mOutputQueue.length() == 0) {
             outputByPos->renderBuffer.flag |= IS_EOS;
         }
         drainDecodingErrors(outErrBuf, &(outputByPos->renderBuffer));
@@ -335,32 +337,16 @@ const VideoRenderBuffer* VideoDecoderBase::getOutput(bool draining, VideoErrorBu
         return NULL;
     }
 
-    if (output != outputByPos) {
-        // remove this output from middle or end of the list
-        VideoSurfaceBuffer *p = outputByPos;
-        while (p->next != output) {
-            p = p->next;
-        }
-        p->next = output->next;
-        if (mOutputTail == output) {
-            mOutputTail = p;
-        }
-    } else {
-        // remove this output from head of the list
-        mOutputHead = mOutputHead->next;
-        if (mOutputHead == NULL) {
-            mOutputTail = NULL;
-        }
-    }
+    mOutputQueue.remove(output);
     //VTRACE("Output POC %d for display (pts = %.2f)", output->pictureOrder, output->renderBuffer.timeStamp/1E6);
-    vaSetTimestampForSurface(mVADisplay, output->renderBuffer.surface, output->renderBuffer.timeStamp);
+    mVA->SetTimestampForSurface(mVADisplay, output->renderBuffer.surface, output->renderBuffer.timeStamp);
 
     if (useGraphicBuffer && !mUseGEN) {
-        vaSyncSurface(mVADisplay, output->renderBuffer.surface);
+        mVA->SyncSurface(mVADisplay, output->renderBuffer.surface);
         fillDecodingErrors(&(output->renderBuffer));
     }
 
-    if (draining && mOutputTail == NULL) {
+    if (draining && mOutputQueue.length() == 0) {
         output->renderBuffer.flag |= IS_EOS;
     }
 
@@ -371,19 +357,7 @@ const VideoRenderBuffer* VideoDecoderBase::getOutput(bool draining, VideoErrorBu
 
 VideoSurfaceBuffer* VideoDecoderBase::findOutputByPts() {
     // output by presentation time stamp - buffer with the smallest time stamp is output
-    VideoSurfaceBuffer *p = mOutputHead;
-    VideoSurfaceBuffer *outputByPts = NULL;
-    uint64_t pts = INVALID_PTS;
-    do {
-        if ((uint64_t)(p->renderBuffer.timeStamp) <= pts) {
-            // find buffer with the smallest PTS
-            pts = p->renderBuffer.timeStamp;
-            outputByPts = p;
-        }
-        p = p->next;
-    } while (p != NULL);
-
-    return outputByPts;
+    return mOutputQueue.leastPts();
 }
 
 VideoSurfaceBuffer* VideoDecoderBase::findOutputByPct(bool draining) {
@@ -391,27 +365,21 @@ VideoSurfaceBuffer* VideoDecoderBase::findOutputByPct(bool draining) {
     // if there is more than one reference frame, the first reference frame is ouput, otherwise,
     // output non-reference frame if there is any.
 
-    VideoSurfaceBuffer *p = mOutputHead;
+    VideoSurfaceBuffer *nonReference = mOutputQueue.firstNonReference();
+    VideoSurfaceBuffer *secondReference = mOutputQueue.secondReference();
     VideoSurfaceBuffer *outputByPct = NULL;
-    int32_t reference = 0;
-    do {
-        if (p->referenceFrame) {
-            reference++;
-            if (reference > 1) {
-                // mOutputHead must be a reference frame
-                outputByPct = mOutputHead;
-                break;
-            }
-        } else {
-            // first non-reference frame
-            outputByPct = p;
-            break;
-        }
-        p = p->next;
-    } while (p != NULL);
+
+    if (nonReference &&
+        (secondReference == NULL || mOutputQueue.before(nonReference, secondReference))) {
+        // first non-reference frame
+        outputByPct = nonReference;
+    } else if (secondReference) {
+        // queue head must be a reference frame
+        outputByPct = mOutputQueue.head();
+    }
 
     if (outputByPct == NULL && draining) {
-        outputByPct = mOutputHead;
+        outputByPct = mOutputQueue.head();
     }
     return  outputByPct;
 }
@@ -437,7 +405,7 @@ VideoSurfaceBuffer* VideoDecoderBase::findOutputByPoc(bool draining) {
         dpbFullness--;
     }
 
-    VideoSurfaceBuffer *p = mOutputHead;
+    VideoSurfaceBuffer *p = mOutputQueue.head();
     while (p != NULL) {
         // count dpbFullness with non-reference frame in the output queue
         if (p->asReferernce == false) {
@@ -447,7 +415,7 @@ VideoSurfaceBuffer* VideoDecoderBase::findOutputByPoc(bool draining) {
     }
 
 Retry:
-    p = mOutputHead;
+    p = mOutputQueue.head();
     VideoSurfaceBuffer *outputByPoc = NULL;
     int32_t count = 0;
     int32_t poc = MAXIMUM_POC;
@@ -501,10 +469,10 @@ Retry:
 #else
 VideoSurfaceBuffer* VideoDecoderBase::findOutputByPoc(bool draining) {
     VideoSurfaceBuffer *output = NULL;
-    VideoSurfaceBuffer *p = mOutputHead;
+    VideoSurfaceBuffer *p = mOutputQueue.head();
     int32_t count = 0;
     int32_t poc = MAXIMUM_POC;
-    VideoSurfaceBuffer *outputleastpoc = mOutputHead;
+    VideoSurfaceBuffer *outputleastpoc = mOutputQueue.head();
     do {
         count++;
         if (p->pictureOrder == 0) {
@@ -536,7 +504,7 @@ VideoSurfaceBuffer* VideoDecoderBase::findOutputByPoc(bool draining) {
                 mNextOutputPOC = MINIMUM_POC;
                 count = 0;
                 poc = MAXIMUM_POC;
-                p = mOutputHead;
+                p = mOutputQueue.head();
                 continue;
             }
         }
@@ -600,23 +568,15 @@ Decode_Status VideoDecoderBase::acquireSurfaceBuffer(void) {
     while (acquired == false) {
         acquiredBuffer = mSurfaceBuffers + nextAcquire;
 
-        querySurfaceRenderStatus(acquiredBuffer);
-
-        if (acquiredBuffer->asReferernce == false && acquiredBuffer->renderBuffer.renderDone == true && acquiredBuffer->renderBuffer.driverRenderDone == true) {
-            // this is potential buffer for acquisition. Check if it is referenced by other surface for frame skipping
-            VideoSurfaceBuffer *temp;
-            acquired = true;
-            for (int i = 0; i < mNumSurfaces; i++) {
-                if (i == nextAcquire) {
-                    continue;
-                }
-                temp = mSurfaceBuffers + i;
-                // use mSurfaces[nextAcquire] instead of acquiredBuffer->renderBuffer.surface as its the actual surface to use.
-                if (temp->renderBuffer.surface == mSurfaces[nextAcquire] &&
-                    temp->renderBuffer.renderDone == false) {
+        // check the flags first, surface status is only queried for a potential buffer
+        if (acquiredBuffer->asReferernce == false && acquiredBuffer->renderBuffer.renderDone == true) {
+            querySurfaceRenderStatus(acquiredBuffer);
+            if (acquiredBuffer->renderBuffer.driverRenderDone == true) {
+                // this is potential buffer for acquisition. Check if it is referenced by other surface for frame skipping
+                acquired = true;
+                if (isSurfaceShared(nextAcquire)) {
                     ITRACE("Surface is referenced by other surface buffer.");
                     acquired = false;
-                    break;
                 }
             }
         }
@@ -638,6 +598,7 @@ Decode_Status VideoDecoderBase::acquireSurfaceBuffer(void) {
 
     mAcquiredBuffer = acquiredBuffer;
     mSurfaceAcquirePos = nextAcquire;
+    unshareSurfaceBuffer(mSurfaceAcquirePos);
 
     // set surface again as surface maybe reset by skipped frame.
     // skipped frame is a "non-coded frame" and decoder needs to duplicate the previous reference frame as the output.
@@ -696,13 +657,7 @@ Decode_Status VideoDecoderBase::outputSurfaceBuffer(void) {
     }
     // add to the output list
     if (mShowFrame) {
-        if (mOutputHead == NULL) {
-            mOutputHead = mAcquiredBuffer;
-        } else {
-            mOutputTail->next = mAcquiredBuffer;
-        }
-        mOutputTail = mAcquiredBuffer;
-        mOutputTail->next = NULL;
+        mOutputQueue.push(mAcquiredBuffer);
     }
 
     //VTRACE("Pushing POC %d to queue (pts = %.2f)", mAcquiredBuffer->pictureOrder, mAcquiredBuffer->renderBuffer.timeStamp/1E6);
@@ -728,14 +683,54 @@ Decode_Status VideoDecoderBase::releaseSurfaceBuffer(void) {
 void VideoDecoderBase::flushSurfaceBuffers(void) {
     endDecodingFrame(true);
     VideoSurfaceBuffer *p = NULL;
-    while (mOutputHead) {
-        mOutputHead->renderBuffer.renderDone = true;
-        p = mOutputHead;
-        mOutputHead = mOutputHead->next;
-        p->next = NULL;
-    }
-    mOutputHead = NULL;
-    mOutputTail = NULL;
+    while ((p = mOutputQueue.head()) != NULL) {
+        p->renderBuffer.renderDone = true;
+        mOutputQueue.remove(p);
+    }
+}
+
+void VideoDecoderBase::shareSurfaceBuffer(VideoSurfaceBuffer *source) {
+    int32_t index = mAcquiredBuffer - mSurfaceBuffers;
+    int32_t from = source - mSurfaceBuffers;
+    if (mSharedSurfaceFrom[from] != -1) {
+        // source is a skipped frame itself
+        from = mSharedSurfaceFrom[from];
+    }
+
+    unshareSurfaceBuffer(index);
+    mAcquiredBuffer->renderBuffer.surface = source->renderBuffer.surface;
+    mSharedSurfaceFrom[index] = from;
+    mSharedSurfaceNext[index] = mSharedSurfaceHead[from];
+    mSharedSurfaceHead[from] = index;
+}
+
+void VideoDecoderBase::unshareSurfaceBuffer(int32_t index) {
+    int32_t from = mSharedSurfaceFrom[index];
+    if (from == -1) {
+        return;
+    }
+    int32_t *p = &mSharedSurfaceHead[from];
+    while (*p != index) {
+        p = &mSharedSurfaceNext[*p];
+    }
+    *p = mSharedSurfaceNext[index];
+    mSharedSurfaceNext[index] = -1;
+    mSharedSurfaceFrom[index] = -1;
+}
+
+bool VideoDecoderBase::isSurfaceShared(int32_t index) {
+    // surface is still in use if any buffer outputting it is not rendered yet
+    for (int32_t i = mSharedSurfaceHead[index]; i != -1; i = mSharedSurfaceNext[i]) {
+        if (mSurfaceBuffers[i].renderBuffer.renderDone == false) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void VideoDecoderBase::updateOutputTimeStamp(VideoSurfaceBuffer *buffer, int64_t timeStamp) {
+    // keeps the time stamp order of the output queue valid
+    mOutputQueue.updateTimeStamp(buffer, timeStamp);
 }
 
 Decode_Status VideoDecoderBase::endDecodingFrame(bool dropFrame) {
@@ -757,7 +752,7 @@ Decode_Status VideoDecoderBase::endDecodingFrame(bool dropFrame) {
         goto exit;
     }
 
-    vaStatus = vaEndPicture(mVADisplay, mVAContext);
+    vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
     if (vaStatus != VA_STATUS_SUCCESS) {
         releaseSurfaceBuffer();
         ETRACE("vaEndPicture failed. vaStatus = %d", vaStatus);
@@ -768,7 +763,7 @@ Decode_Status VideoDecoderBase::endDecodingFrame(bool dropFrame) {
     if (dropFrame) {
         // we are asked to drop this decoded picture
         VTRACE("Frame dropped in endDecodingFrame");
-        vaStatus = vaSyncSurface(mVADisplay, mAcquiredBuffer->renderBuffer.surface);
+        vaStatus = mVA->SyncSurface(mVADisplay, mAcquiredBuffer->renderBuffer.surface);
         releaseSurfaceBuffer();
         goto exit;
     }
@@ -841,14 +836,14 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
         mUseGEN = false;
     }
 #endif
-    mVADisplay = vaGetDisplay(mDisplay);
+    mVADisplay = mVA->GetDisplay(mDisplay);
     if (mVADisplay == NULL) {
         ETRACE("vaGetDisplay failed.");
         return DECODE_DRIVER_FAIL;
     }
 
     int majorVersion, minorVersion;
-    vaStatus = vaInitialize(mVADisplay, &majorVersion, &minorVersion);
+    vaStatus = mVA->Initialize(mVADisplay, &majorVersion, &minorVersion);
     CHECK_VA_STATUS("vaInitialize");
 
     if ((int32_t)profile != VAProfileSoftwareDecoding) {
@@ -865,7 +860,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
         attrib.type = VAConfigAttribRTFormat;
         attrib.value = VA_RT_FORMAT_YUV420;
 
-        vaStatus = vaCreateConfig(
+        vaStatus = mVA->CreateConfig(
                 mVADisplay,
                 profile,
                 VAEntrypointVLD,
@@ -949,7 +944,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
             attribs[1].value.type = VAGenericValueTypePointer;
             attribs[1].value.value.p = (void *)mVASurfaceAttrib;
 
-            vaStatus = vaCreateSurfaces(
+            vaStatus = mVA->CreateSurfaces(
                 mVADisplay,
                 format,
                 mVideoFormatInfo.surfaceWidth,
@@ -960,7 +955,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
                 2);
         }
     } else {
-        vaStatus = vaCreateSurfaces(
+        vaStatus = mVA->CreateSurfaces(
             mVADisplay,
             format,
             mVideoFormatInfo.width,
@@ -975,7 +970,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
     CHECK_VA_STATUS("vaCreateSurfaces");
 
     if (mNumExtraSurfaces != 0) {
-        vaStatus = vaCreateSurfaces(
+        vaStatus = mVA->CreateSurfaces(
             mVADisplay,
             format,
             mVideoFormatInfo.surfaceWidth,
@@ -993,7 +988,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
     if ((int32_t)profile != VAProfileSoftwareDecoding) {
         if (mStoreMetaData) {
             if (mUseGEN) {
-                vaStatus = vaCreateContext(
+                vaStatus = mVA->CreateContext(
                     mVADisplay,
                     mVAConfig,
                     mVideoFormatInfo.surfaceWidth,
@@ -1003,7 +998,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
                     0,
                     &mVAContext);
             } else {
-                vaStatus = vaCreateContext(
+                vaStatus = mVA->CreateContext(
                     mVADisplay,
                     mVAConfig,
                     mVideoFormatInfo.surfaceWidth,
@@ -1014,7 +1009,7 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
                     &mVAContext);
             }
         } else {
-            vaStatus = vaCreateContext(
+            vaStatus = mVA->CreateContext(
                 mVADisplay,
                 mVAConfig,
                 mVideoFormatInfo.surfaceWidth,
@@ -1031,9 +1026,19 @@ Decode_Status VideoDecoderBase::setupVA(uint32_t numSurface, VAProfile profile,
     if (mSurfaceBuffers == NULL) {
         return DECODE_MEMORY_FAIL;
     }
+
+    mSharedSurfaceHead = new int32_t [mNumSurfaces];
+    mSharedSurfaceNext = new int32_t [mNumSurfaces];
+    mSharedSurfaceFrom = new int32_t [mNumSurfaces];
+    if (mSharedSurfaceHead == NULL || mSharedSurfaceNext == NULL || mSharedSurfaceFrom == NULL) {
+        return DECODE_MEMORY_FAIL;
+    }
     initSurfaceBuffer(true);
 
-    if ((int32_t)profile == VAProfileSoftwareDecoding) {
+    status = mOutputQueue.init(mSurfaceBuffers, mNumSurfaces);
+    CHECK_STATUS("mOutputQueue.init");
+
+    if ((int32_t)profile == VAProfileSoftwareDecoding || mRawOutputView) {
         // derive user pointer from surface for direct access
         status = mapSurface();
         CHECK_STATUS("mapSurface")
@@ -1070,7 +1075,8 @@ Decode_Status VideoDecoderBase::terminateVA(void) {
     if (mSurfaceBuffers) {
         for (int32_t i = 0; i < mNumSurfaces; i++) {
             if (mSurfaceBuffers[i].renderBuffer.rawData) {
-                if (mSurfaceBuffers[i].renderBuffer.rawData->data) {
+                if (mSurfaceBuffers[i].renderBuffer.rawData->own &&
+                    mSurfaceBuffers[i].renderBuffer.rawData->data) {
                     delete [] mSurfaceBuffers[i].renderBuffer.rawData->data;
                 }
                 delete mSurfaceBuffers[i].renderBuffer.rawData;
@@ -1083,6 +1089,20 @@ Decode_Status VideoDecoderBase::terminateVA(void) {
         delete [] mSurfaceBuffers;
         mSurfaceBuffers = NULL;
     }
+    mOutputQueue.deinit();
+
+    if (mSharedSurfaceHead) {
+        delete [] mSharedSurfaceHead;
+        mSharedSurfaceHead = NULL;
+    }
+    if (mSharedSurfaceNext) {
+        delete [] mSharedSurfaceNext;
+        mSharedSurfaceNext = NULL;
+    }
+    if (mSharedSurfaceFrom) {
+        delete [] mSharedSurfaceFrom;
+        mSharedSurfaceFrom = NULL;
+    }
 
     if (mVASurfaceAttrib) {
         if (mVASurfaceAttrib->buffers) free(mVASurfaceAttrib->buffers);
@@ -1097,23 +1117,23 @@ Decode_Status VideoDecoderBase::terminateVA(void) {
     }
 
     if (mSurfaces) {
-        vaDestroySurfaces(mVADisplay, mSurfaces, mStoreMetaData ? mMetaDataBuffersNum : (mNumSurfaces + mNumExtraSurfaces));
+        mVA->DestroySurfaces(mVADisplay, mSurfaces, mStoreMetaData ? mMetaDataBuffersNum : (mNumSurfaces + mNumExtraSurfaces));
         delete [] mSurfaces;
         mSurfaces = NULL;
     }
 
     if (mVAContext != VA_INVALID_ID) {
-         vaDestroyContext(mVADisplay, mVAContext);
+         mVA->DestroyContext(mVADisplay, mVAContext);
          mVAContext = VA_INVALID_ID;
     }
 
     if (mVAConfig != VA_INVALID_ID) {
-        vaDestroyConfig(mVADisplay, mVAConfig);
+        mVA->DestroyConfig(mVADisplay, mVAConfig);
         mVAConfig = VA_INVALID_ID;
     }
 
     if (mVADisplay) {
-        vaTerminate(mVADisplay);
+        mVA->Terminate(mVADisplay);
         mVADisplay = NULL;
     }
 
@@ -1165,9 +1185,9 @@ Decode_Status VideoDecoderBase::mapSurface(void) {
     }
 
     for (int32_t i = 0; i< mNumSurfaces; i++) {
-        vaStatus = vaDeriveImage(mVADisplay, mSurfaces[i], &image);
+        vaStatus = mVA->DeriveImage(mVADisplay, mSurfaces[i], &image);
         CHECK_VA_STATUS("vaDeriveImage");
-        vaStatus = vaMapBuffer(mVADisplay, image.buf, (void**)&userPtr);
+        vaStatus = mVA->MapBuffer(mVADisplay, image.buf, (void**)&userPtr);
         CHECK_VA_STATUS("vaMapBuffer");
         mSurfaceUserPtr[i] = userPtr;
         mSurfaceBuffers[i].mappedData = new VideoFrameRawData;
@@ -1192,33 +1212,78 @@ Decode_Status VideoDecoderBase::mapSurface(void) {
             WTRACE("Unexpected VAImage format, w = %d, h = %d, offset = %d", image.width, image.height, image.offsets[0]);
         }
         // TODO: do we need to unmap buffer?
-        //vaStatus = vaUnmapBuffer(mVADisplay, image.buf);
+        //vaStatus = mVA->UnmapBuffer(mVADisplay, image.buf);
         //CHECK_VA_STATUS("vaMapBuffer");
-        vaStatus = vaDestroyImage(mVADisplay,image.image_id);
+        vaStatus = mVA->DestroyImage(mVADisplay,image.image_id);
         CHECK_VA_STATUS("vaDestroyImage");
 
     }
     return DECODE_SUCCESS;
 }
 
+Decode_Status VideoDecoderBase::getRawDataView(VideoRenderBuffer *renderBuffer) {
+    // raw data of the acquired buffer points to the surface mapped in mapSurface,
+    // it stays valid until the buffer is returned (renderDone) and acquired again.
+    int32_t index = mAcquiredBuffer - mSurfaceBuffers;
+    if (mSharedSurfaceFrom[index] != -1) {
+        // skipped frame outputs the surface of the last reference
+        index = mSharedSurfaceFrom[index];
+    }
+    VideoFrameRawData *mappedData = mSurfaceBuffers[index].mappedData;
+    if (mappedData == NULL) {
+        return DECODE_FAIL;
+    }
+
+    VAStatus vaStatus = mVA->SyncSurface(renderBuffer->display, renderBuffer->surface);
+    CHECK_VA_STATUS("vaSyncSurface");
+
+    VideoFrameRawData *rawData = renderBuffer->rawData;
+    if (rawData == NULL) {
+        rawData = new VideoFrameRawData;
+        if (rawData == NULL) {
+            return DECODE_MEMORY_FAIL;
+        }
+        memset(rawData, 0, sizeof(VideoFrameRawData));
+        renderBuffer->rawData = rawData;
+    }
+
+    uint32_t cropWidth = mVideoFormatInfo.width - (mVideoFormatInfo.cropLeft + mVideoFormatInfo.cropRight);
+    uint32_t cropHeight = mVideoFormatInfo.height - (mVideoFormatInfo.cropBottom + mVideoFormatInfo.cropTop);
+    if (strcasecmp(mVideoFormatInfo.mimeType,"video/avc") == 0 ||
+        strcasecmp(mVideoFormatInfo.mimeType,"video/h264") == 0) {
+        cropHeight = mVideoFormatInfo.height;
+        cropWidth = mVideoFormatInfo.width;
+    }
+
+    *rawData = *mappedData;
+    rawData->data = mSurfaceUserPtr[index];
+    rawData->own = false; // derived from surface so can't be released
+    rawData->width = cropWidth;
+    rawData->height = cropHeight;
+    return DECODE_SUCCESS;
+}
+
 Decode_Status VideoDecoderBase::getRawDataFromSurface(VideoRenderBuffer *renderBuffer, uint8_t *pRawData, uint32_t *pSize, bool internal) {
     if (internal) {
         if (mAcquiredBuffer == NULL) {
             return DECODE_FAIL;
         }
         renderBuffer = &(mAcquiredBuffer->renderBuffer);
+        if (mRawOutputView && mSurfaceUserPtr) {
+            return getRawDataView(renderBuffer);
+        }
     }
 
     VAStatus vaStatus;
     VAImage vaImage;
-    vaStatus = vaSyncSurface(renderBuffer->display, renderBuffer->surface);
+    vaStatus = mVA->SyncSurface(renderBuffer->display, renderBuffer->surface);
     CHECK_VA_STATUS("vaSyncSurface");
 
-    vaStatus = vaDeriveImage(renderBuffer->display, renderBuffer->surface, &vaImage);
+    vaStatus = mVA->DeriveImage(renderBuffer->display, renderBuffer->surface, &vaImage);
     CHECK_VA_STATUS("vaDeriveImage");
 
     void *pBuf = NULL;
-    vaStatus = vaMapBuffer(renderBuffer->display, vaImage.buf, &pBuf);
+    vaStatus = mVA->MapBuffer(renderBuffer->display, vaImage.buf, &pBuf);
     CHECK_VA_STATUS("vaMapBuffer");
 
 
@@ -1245,12 +1310,12 @@ Decode_Status VideoDecoderBase::getRawDataFromSurface(VideoRenderBuffer *renderB
             rawData = renderBuffer->rawData;
         }
 
-        if (rawData->data != NULL && rawData->size != size) {
+        if (rawData->own && rawData->data != NULL && rawData->size != size) {
             delete [] rawData->data;
             rawData->data = NULL;
             rawData->size = 0;
         }
-        if (rawData->data == NULL) {
+        if (!rawData->own || rawData->data == NULL) {
             rawData->data = new uint8_t [size];
             if (rawData->data == NULL) {
                 return DECODE_MEMORY_FAIL;
@@ -1275,42 +1340,18 @@ Decode_Status VideoDecoderBase::getRawDataFromSurface(VideoRenderBuffer *renderB
     }
 
     if (size == (int32_t)vaImage.data_size) {
-#ifdef  __SSE4_1__
-        stream_memcpy(pRawData, pBuf, size);
-#else
-        memcpy(pRawData, pBuf, size);
-#endif
+        copyPlane(pRawData, size, (uint8_t*)pBuf, size, size, 1);
     } else {
-        // copy Y data
-        uint8_t *src = (uint8_t*)pBuf;
-        uint8_t *dst = pRawData;
-        uint32_t row = 0;
-        for (row = 0; row < cropHeight; row++) {
-#ifdef  __SSE4_1__
-            stream_memcpy(dst, src, cropWidth);
-#else
-            memcpy(dst, src, cropWidth);
-#endif
-            dst += cropWidth;
-            src += vaImage.pitches[0];
-        }
-        // copy interleaved V and  U data
-        src = (uint8_t*)pBuf + vaImage.offsets[1];
-        for (row = 0; row < cropHeight / 2; row++) {
-#ifdef  __SSE4_1__
-            stream_memcpy(dst, src, cropWidth);
-#else
-            memcpy(dst, src, cropWidth);
-#endif
-            dst += cropWidth;
-            src += vaImage.pitches[1];
-        }
+        // copy Y data and interleaved V and U data
+        NV12Planes dst = {pRawData, pRawData + cropWidth * cropHeight, cropWidth, cropWidth};
+        NV12Planes src = {(uint8_t*)pBuf, (uint8_t*)pBuf + vaImage.offsets[1], vaImage.pitches[0], vaImage.pitches[1]};
+        copyNV12(dst, src, cropWidth, cropHeight);
     }
 
-    vaStatus = vaUnmapBuffer(renderBuffer->display, vaImage.buf);
+    vaStatus = mVA->UnmapBuffer(renderBuffer->display, vaImage.buf);
     CHECK_VA_STATUS("vaUnmapBuffer");
 
-    vaStatus = vaDestroyImage(renderBuffer->display, vaImage.image_id);
+    vaStatus = mVA->DestroyImage(renderBuffer->display, vaImage.image_id);
     CHECK_VA_STATUS("vaDestroyImage");
 
     return DECODE_SUCCESS;
@@ -1368,7 +1409,7 @@ Decode_Status VideoDecoderBase::createSurfaceFromHandle(int index) {
     attribs[1].value.type = VAGenericValueTypePointer;
     attribs[1].value.value.p = (void *)&surfExtBuf;
 
-    vaStatus = vaCreateSurfaces(
+    vaStatus = mVA->CreateSurfaces(
             mVADisplay,
             format,
             mVideoFormatInfo.surfaceWidth,
@@ -1397,6 +1438,9 @@ void VideoDecoderBase::initSurfaceBuffer(bool reset) {
         mSurfaceBuffers[i].asReferernce= false;
         mSurfaceBuffers[i].pictureOrder = 0;
         mSurfaceBuffers[i].next = NULL;
+        mSharedSurfaceHead[i] = -1;
+        mSharedSurfaceNext[i] = -1;
+        mSharedSurfaceFrom[i] = -1;
         if (reset == true) {
             mSurfaceBuffers[i].renderBuffer.rawData = NULL;
             mSurfaceBuffers[i].mappedData = NULL;
@@ -1507,7 +1551,7 @@ void VideoDecoderBase::querySurfaceRenderStatus(VideoSurfaceBuffer* surface) {
     if (surface->renderBuffer.surface != VA_INVALID_SURFACE &&
        (mConfigBuffer.flag & USE_NATIVE_GRAPHIC_BUFFER)) {
 
-        vaStat = vaQuerySurfaceStatus(mVADisplay, surface->renderBuffer.surface, &surfStat);
+        vaStat = mVA->QuerySurfaceStatus(mVADisplay, surface->renderBuffer.surface, &surfStat);
 
         if ((vaStat == VA_STATUS_SUCCESS) && (surfStat != VASurfaceReady))
             surface->renderBuffer.driverRenderDone = false;
@@ -1569,7 +1613,7 @@ Decode_Status VideoDecoderBase::getCodecSpecificConfigs(VAProfile profile, VACon
         return DECODE_FAIL;
     }
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay,
             profile,
             VAEntrypointVLD,
@@ -1604,7 +1648,7 @@ void VideoDecoderBase::fillDecodingErrors(VideoRenderBuffer *currentSurface) {
         currentSurface->errBuf.timeStamp = currentSurface->timeStamp;
         // TODO: is 10 a suitable number?
         VASurfaceDecodeMBErrors *err_drv_output = NULL;
-        ret = vaQuerySurfaceError(mVADisplay, currentSurface->surface, VA_STATUS_ERROR_DECODING_ERROR, (void **)&err_drv_output);
+        ret = mVA->QuerySurfaceError(mVADisplay, currentSurface->surface, VA_STATUS_ERROR_DECODING_ERROR, (void **)&err_drv_output);
         if (ret || !err_drv_output) {
             WTRACE("vaQuerySurfaceError failed.");
             return;
@@ -1648,7 +1692,7 @@ void VideoDecoderBase::setRotationDegrees(int32_t rotationDegrees) {
     else if (rotationDegrees == 270)
         rotate.value = VA_ROTATION_270;
 
-    VAStatus ret = vaSetDisplayAttributes(mVADisplay, &rotate, 1);
+    VAStatus ret = mVA->SetDisplayAttributes(mVADisplay, &rotate, 1);
     if (ret) {
         ETRACE("Failed to set rotation degree.");
     }
@@ -1680,7 +1724,7 @@ void VideoDecoderBase::setRenderRect() {
     render_rect.attrib_ptr = &rect;
 #endif
 
-    ret = vaSetDisplayAttributes(mVADisplay, &render_rect, 1);
+    ret = mVA->SetDisplayAttributes(mVADisplay, &render_rect, 1);
     if (ret) {
         ETRACE("Failed to set rotation degree.");
     }
@@ -1710,7 +1754,7 @@ void VideoDecoderBase::setColorSpaceInfo(int32_t colorMatrix, int32_t videoRange
           *ptr = &s709;
     }
 
-    VAStatus ret = vaSetDisplayAttributes(mVADisplay, &cm, 1);
+    VAStatus ret = mVA->SetDisplayAttributes(mVADisplay, &cm, 1);
 
     if (ret) {
         ETRACE("Failed to set colorMatrix.");
@@ -1722,7 +1766,7 @@ void VideoDecoderBase::setColorSpaceInfo(int32_t colorMatrix, int32_t videoRange
     vr.type = VADisplayAttribColorRange;
     vr.value = (videoRange == 1) ? VA_SOURCE_RANGE_FULL : VA_SOURCE_RANGE_REDUCED;
 
-    ret = vaSetDisplayAttributes(mVADisplay, &vr, 1);
+    ret = mVA->SetDisplayAttributes(mVADisplay, &vr, 1);
 
     if (ret) {
         ETRACE("Failed to set videoRange.");
@@ -21,6 +21,8 @@
 #include <va/va_tpi.h>
 #include "VideoDecoderDefs.h"
 #include "VideoDecoderInterface.h"
+#include "VABackend.h"
+#include "VideoDecoderOutputQueue.h"
 #include <pthread.h>
 #include <dlfcn.h>
 
@@ -88,6 +90,10 @@ protected:
     virtual Decode_Status releaseSurfaceBuffer(void);
     // flush all decoded but not rendered buffers
     virtual void flushSurfaceBuffers(void);
+    // update time stamp of a buffer which may already be in the output queue
+    void updateOutputTimeStamp(VideoSurfaceBuffer *buffer, int64_t timeStamp);
+    // output the surface of source buffer through the acquired buffer (skipped frame)
+    void shareSurfaceBuffer(VideoSurfaceBuffer *source);
     virtual Decode_Status endDecodingFrame(bool dropFrame);
     virtual VideoSurfaceBuffer* findOutputByPoc(bool draining = false);
     virtual VideoSurfaceBuffer* findOutputByPct(bool draining = false);
@@ -112,7 +118,10 @@ protected:
     Decode_Status createSurfaceFromHandle(int32_t index);
 private:
     Decode_Status mapSurface(void);
+    Decode_Status getRawDataView(VideoRenderBuffer *renderBuffer);
     void initSurfaceBuffer(bool reset);
+    void unshareSurfaceBuffer(int32_t index);
+    bool isSurfaceShared(int32_t index);
     void drainDecodingErrors(VideoErrorBuffer *outErrBuf, VideoRenderBuffer *currentSurface);
     void fillDecodingErrors(VideoRenderBuffer *currentSurface);
 
@@ -123,6 +132,7 @@ protected:
     bool mLowDelay; // when true, decoded frame is immediately output for rendering
     bool mStoreMetaData; // when true, meta data mode is enabled for adaptive playback
     VideoFormatInfo mVideoFormatInfo;
+    const VABackend *mVA; // libva or null VA
     Display *mDisplay;
     VADisplay mVADisplay;
     VAContextID mVAContext;
@@ -178,17 +188,21 @@ protected:
 
 private:
     bool mRawOutput; // whether to output NV12 raw data
+    bool mRawOutputView; // raw data points to the mapped surface, no copy
     bool mManageReference;  // this should stay true for VC1/MP4 decoder, and stay false for AVC decoder. AVC  handles reference frame using DPB
     OUTPUT_METHOD mOutputMethod;
 
     int32_t mNumSurfaces;
     VideoSurfaceBuffer *mSurfaceBuffers;
-    VideoSurfaceBuffer *mOutputHead; // head of output buffer list
-    VideoSurfaceBuffer *mOutputTail;  // tail of output buffer list
+    VideoDecoderOutputQueue mOutputQueue; // decoded buffers waiting for output
     VASurfaceID *mSurfaces; // surfaces array
     VASurfaceAttribExternalBuffers *mVASurfaceAttrib;
     uint8_t **mSurfaceUserPtr; // mapped user space pointer
     int32_t mSurfaceAcquirePos; // position of surface to start acquiring
+    // buffers outputting the surface of another buffer, so acquisition doesn't compare every surface buffer
+    int32_t *mSharedSurfaceHead; // per surface: first buffer sharing it, -1 if none
+    int32_t *mSharedSurfaceNext; // per buffer: next buffer sharing the same surface
+    int32_t *mSharedSurfaceFrom; // per buffer: index of the surface being shared, -1 if its own
     int32_t mNextOutputPOC; // Picture order count of next output
     _vbp_parser_type mParserType;
     void *mParserHandle;
@@ -114,6 +114,15 @@ typedef enum {
 
     // indicate meta data mode
     WANT_STORE_META_DATA = 0x400000,
+
+    // indicate all slices of a picture should be submitted with one render call (AVC only)
+    WANT_BATCHED_SLICES = 0x800000,
+
+    // indicate raw data is output as a view of the mapped surface instead of a copy (with WANT_RAW_OUTPUT)
+    WANT_RAW_OUTPUT_VIEW = 0x1000000,
+
+    // indicate VA submission runs on a separate thread, one buffer behind parsing (AVC only)
+    WANT_DECODE_AHEAD = 0x2000000,
 } VIDEO_BUFFER_FLAG;
 
 typedef enum
@@ -218,12 +218,12 @@ Decode_Status VideoDecoderMPEG2::decodePicture(vbp_data_mpeg2 *data, int picInde
     status = setReference(picParam);
     CHECK_STATUS("setReference");
 
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
     // setting mDecodingFrame to true so vaEndPicture will be invoked to end the picture decoding.
     mDecodingFrame = true;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -234,7 +234,7 @@ Decode_Status VideoDecoderMPEG2::decodePicture(vbp_data_mpeg2 *data, int picInde
     CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 VAIQMatrixBufferType,
@@ -246,7 +246,7 @@ Decode_Status VideoDecoderMPEG2::decodePicture(vbp_data_mpeg2 *data, int picInde
     bufferIDCount++;
 
     for (uint32_t i = 0; i < picData->num_slices; i++) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 VASliceParameterBufferType,
@@ -261,7 +261,7 @@ Decode_Status VideoDecoderMPEG2::decodePicture(vbp_data_mpeg2 *data, int picInde
         // Note that this is the original data buffer ptr;
         // offset to the actual slice data is provided in
         // slice_data_offset in VASliceParameterBufferMPEG2
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 VASliceDataBufferType,
@@ -273,14 +273,14 @@ Decode_Status VideoDecoderMPEG2::decodePicture(vbp_data_mpeg2 *data, int picInde
         bufferIDCount++;
     }
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
             mVADisplay,
             mVAContext,
             mBufferIDs,
             bufferIDCount);
     CHECK_VA_STATUS("vaRenderPicture");
 
-    vaStatus = vaEndPicture(mVADisplay, mVAContext);
+    vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
     mDecodingFrame = false;
     CHECK_VA_STATUS("vaRenderPicture");
 
@@ -412,7 +412,7 @@ Decode_Status VideoDecoderMPEG2::checkHardwareCapability() {
     VAConfigAttrib cfgAttribs[2];
     cfgAttribs[0].type = VAConfigAttribMaxPictureWidth;
     cfgAttribs[1].type = VAConfigAttribMaxPictureHeight;
-    vaStatus = vaGetConfigAttributes(mVADisplay,
+    vaStatus = mVA->GetConfigAttributes(mVADisplay,
             VAProfileMPEG2Main,
             VAEntrypointVLD, cfgAttribs, 2);
     CHECK_VA_STATUS("vaGetConfigAttributes");
@@ -244,7 +244,7 @@ Decode_Status VideoDecoderMPEG4::beginDecodingFrame(vbp_data_mp42 *data) {
 
         if (mExpectingNVOP) {
             // P frame is already in queue, just need to update time stamp.
-            mLastReference->renderBuffer.timeStamp = mCurrentPTS;
+            updateOutputTimeStamp(mLastReference, mCurrentPTS);
             mExpectingNVOP = false;
         }
         else {
@@ -257,7 +257,7 @@ Decode_Status VideoDecoderMPEG4::beginDecodingFrame(vbp_data_mp42 *data) {
             mAcquiredBuffer->renderBuffer.timeStamp = mCurrentPTS;
             mAcquiredBuffer->renderBuffer.flag = 0;
             mAcquiredBuffer->renderBuffer.scanFormat = mLastReference->renderBuffer.scanFormat;
-            mAcquiredBuffer->renderBuffer.surface = mLastReference->renderBuffer.surface;
+            shareSurfaceBuffer(mLastReference);
             // No need to update mappedData for HW decoding
             //mAcquiredBuffer->mappedData.data = mLastReference->mappedData.data;
             mAcquiredBuffer->referenceFrame = true;
@@ -430,7 +430,7 @@ Decode_Status VideoDecoderMPEG4::continueDecodingFrame(vbp_data_mp42 *data) {
             }
 
             // start decoding a frame
-            vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+            vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
             CHECK_VA_STATUS("vaBeginPicture");
 
             mDecodingFrame = true;
@@ -460,7 +460,7 @@ Decode_Status VideoDecoderMPEG4::decodeSlice(vbp_data_mp42 *data, vbp_picture_da
     status = setReference(picParam);
     CHECK_STATUS("setReference");
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VAPictureParameterBufferType,
@@ -474,7 +474,7 @@ Decode_Status VideoDecoderMPEG4::decodeSlice(vbp_data_mp42 *data, vbp_picture_da
     if (picParam->vol_fields.bits.quant_type && mSendIQMatrixBuf)
     {
         // only send IQ matrix for the first slice in the picture
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -488,7 +488,7 @@ Decode_Status VideoDecoderMPEG4::decodeSlice(vbp_data_mp42 *data, vbp_picture_da
         bufferIDCount++;
     }
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -505,7 +505,7 @@ Decode_Status VideoDecoderMPEG4::decodeSlice(vbp_data_mp42 *data, vbp_picture_da
     // offset to the actual slice data is provided in
     // slice_data_offset in VASliceParameterBufferMP42
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceDataBufferType,
@@ -517,7 +517,7 @@ Decode_Status VideoDecoderMPEG4::decodeSlice(vbp_data_mp42 *data, vbp_picture_da
 
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
@@ -665,7 +665,7 @@ Decode_Status VideoDecoderMPEG4::checkHardwareCapability() {
     VAConfigAttrib cfgAttribs[2];
     cfgAttribs[0].type = VAConfigAttribMaxPictureWidth;
     cfgAttribs[1].type = VAConfigAttribMaxPictureHeight;
-    vaStatus = vaGetConfigAttributes(mVADisplay,
+    vaStatus = mVA->GetConfigAttributes(mVADisplay,
             mIsShortHeader ? VAProfileH263Baseline : VAProfileMPEG4AdvancedSimple,
             VAEntrypointVLD, cfgAttribs, 2);
     CHECK_VA_STATUS("vaGetConfigAttributes");
@@ -0,0 +1,260 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "VideoDecoderOutputQueue.h"
+#include "VideoDecoderTrace.h"
+
+VideoDecoderOutputQueue::VideoDecoderOutputQueue()
+    : mBuffers(NULL),
+      mNumBuffers(0),
+      mNodes(NULL),
+      mHeap(NULL),
+      mHeapSize(0),
+      mHead(NULL),
+      mTail(NULL),
+      mLength(0),
+      mSeq(0) {
+    mKindHead[0] = mKindHead[1] = INVALID_INDEX;
+    mKindTail[0] = mKindTail[1] = INVALID_INDEX;
+}
+
+VideoDecoderOutputQueue::~VideoDecoderOutputQueue() {
+    deinit();
+}
+
+Decode_Status VideoDecoderOutputQueue::init(VideoSurfaceBuffer *buffers, int32_t num) {
+    deinit();
+    if (buffers == NULL || num <= 0) {
+        return DECODE_INVALID_DATA;
+    }
+
+    mNodes = new Node [num];
+    mHeap = new int32_t [num];
+    if (mNodes == NULL || mHeap == NULL) {
+        deinit();
+        return DECODE_MEMORY_FAIL;
+    }
+    mBuffers = buffers;
+    mNumBuffers = num;
+    clear();
+    return DECODE_SUCCESS;
+}
+
+void VideoDecoderOutputQueue::deinit(void) {
+    if (mNodes) {
+        delete [] mNodes;
+        mNodes = NULL;
+    }
+    if (mHeap) {
+        delete [] mHeap;
+        mHeap = NULL;
+    }
+    mBuffers = NULL;
+    mNumBuffers = 0;
+    mHeapSize = 0;
+    mHead = NULL;
+    mTail = NULL;
+    mLength = 0;
+}
+
+void VideoDecoderOutputQueue::clear(void) {
+    for (int32_t i = 0; i < mNumBuffers; i++) {
+        mNodes[i].prev = INVALID_INDEX;
+        mNodes[i].prevOfKind = INVALID_INDEX;
+        mNodes[i].nextOfKind = INVALID_INDEX;
+        mNodes[i].heapPos = INVALID_INDEX;
+        mNodes[i].seq = 0;
+        mNodes[i].reference = false;
+    }
+    mKindHead[0] = mKindHead[1] = INVALID_INDEX;
+    mKindTail[0] = mKindTail[1] = INVALID_INDEX;
+    mHeapSize = 0;
+    mHead = NULL;
+    mTail = NULL;
+    mLength = 0;
+    mSeq = 0;
+}
+
+void VideoDecoderOutputQueue::push(VideoSurfaceBuffer *buffer) {
+    int32_t index = indexOf(buffer);
+    if (index < 0 || index >= mNumBuffers || mNodes[index].heapPos != INVALID_INDEX) {
+        ETRACE("Surface buffer %p can't be queued for output.", buffer);
+        return;
+    }
+
+    Node &node = mNodes[index];
+    node.seq = mSeq++;
+    // reference flag is sampled here, it does not change while the buffer is queued
+    node.reference = buffer->referenceFrame;
+
+    buffer->next = NULL;
+    if (mTail) {
+        mTail->next = buffer;
+        node.prev = indexOf(mTail);
+    } else {
+        mHead = buffer;
+        node.prev = INVALID_INDEX;
+    }
+    mTail = buffer;
+
+    int32_t kind = node.reference ? 1 : 0;
+    node.nextOfKind = INVALID_INDEX;
+    node.prevOfKind = mKindTail[kind];
+    if (mKindTail[kind] != INVALID_INDEX) {
+        mNodes[mKindTail[kind]].nextOfKind = index;
+    } else {
+        mKindHead[kind] = index;
+    }
+    mKindTail[kind] = index;
+
+    node.heapPos = mHeapSize;
+    mHeap[mHeapSize++] = index;
+    siftUp(node.heapPos);
+
+    mLength++;
+}
+
+void VideoDecoderOutputQueue::remove(VideoSurfaceBuffer *buffer) {
+    int32_t index = indexOf(buffer);
+    if (index < 0 || index >= mNumBuffers || mNodes[index].heapPos == INVALID_INDEX) {
+        return;
+    }
+
+    Node &node = mNodes[index];
+
+    // decoding order
+    VideoSurfaceBuffer *prev = (node.prev != INVALID_INDEX) ? &mBuffers[node.prev] : NULL;
+    if (prev) {
+        prev->next = buffer->next;
+    } else {
+        mHead = buffer->next;
+    }
+    if (buffer->next) {
+        mNodes[indexOf(buffer->next)].prev = node.prev;
+    } else {
+        mTail = prev;
+    }
+    buffer->next = NULL;
+    node.prev = INVALID_INDEX;
+
+    // reference/non-reference order
+    int32_t kind = node.reference ? 1 : 0;
+    if (node.prevOfKind != INVALID_INDEX) {
+        mNodes[node.prevOfKind].nextOfKind = node.nextOfKind;
+    } else {
+        mKindHead[kind] = node.nextOfKind;
+    }
+    if (node.nextOfKind != INVALID_INDEX) {
+        mNodes[node.nextOfKind].prevOfKind = node.prevOfKind;
+    } else {
+        mKindTail[kind] = node.prevOfKind;
+    }
+    node.prevOfKind = INVALID_INDEX;
+    node.nextOfKind = INVALID_INDEX;
+
+    // time stamp heap
+    int32_t pos = node.heapPos;
+    node.heapPos = INVALID_INDEX;
+    mHeapSize--;
+    if (pos != mHeapSize) {
+        mHeap[pos] = mHeap[mHeapSize];
+        mNodes[mHeap[pos]].heapPos = pos;
+        siftUp(pos);
+        siftDown(mNodes[mHeap[pos]].heapPos);
+    }
+
+    mLength--;
+}
+
+void VideoDecoderOutputQueue::updateTimeStamp(VideoSurfaceBuffer *buffer, int64_t timeStamp) {
+    buffer->renderBuffer.timeStamp = timeStamp;
+
+    int32_t index = indexOf(buffer);
+    if (index < 0 || index >= mNumBuffers || mNodes[index].heapPos == INVALID_INDEX) {
+        return;
+    }
+    siftUp(mNodes[index].heapPos);
+    siftDown(mNodes[index].heapPos);
+}
+
+VideoSurfaceBuffer* VideoDecoderOutputQueue::firstNonReference(void) {
+    return (mKindHead[0] != INVALID_INDEX) ? &mBuffers[mKindHead[0]] : NULL;
+}
+
+VideoSurfaceBuffer* VideoDecoderOutputQueue::secondReference(void) {
+    if (mKindHead[1] == INVALID_INDEX) {
+        return NULL;
+    }
+    int32_t second = mNodes[mKindHead[1]].nextOfKind;
+    return (second != INVALID_INDEX) ? &mBuffers[second] : NULL;
+}
+
+VideoSurfaceBuffer* VideoDecoderOutputQueue::leastPts(void) {
+    return mHeapSize ? &mBuffers[mHeap[0]] : NULL;
+}
+
+bool VideoDecoderOutputQueue::before(VideoSurfaceBuffer *a, VideoSurfaceBuffer *b) {
+    return mNodes[indexOf(a)].seq < mNodes[indexOf(b)].seq;
+}
+
+bool VideoDecoderOutputQueue::ptsLess(int32_t a, int32_t b) {
+    // same unsigned comparison as the linear search used to do, so an invalid
+    // (-1) time stamp sorts last; on a tie the later decoded buffer wins
+    uint64_t ptsA = (uint64_t)mBuffers[a].renderBuffer.timeStamp;
+    uint64_t ptsB = (uint64_t)mBuffers[b].renderBuffer.timeStamp;
+    if (ptsA != ptsB) {
+        return ptsA < ptsB;
+    }
+    return mNodes[a].seq > mNodes[b].seq;
+}
+
+void VideoDecoderOutputQueue::heapSwap(int32_t i, int32_t j) {
+    int32_t tmp = mHeap[i];
+    mHeap[i] = mHeap[j];
+    mHeap[j] = tmp;
+    mNodes[mHeap[i]].heapPos = i;
+    mNodes[mHeap[j]].heapPos = j;
+}
+
+void VideoDecoderOutputQueue::siftUp(int32_t pos) {
+    while (pos > 0) {
+        int32_t parent = (pos - 1) / 2;
+        if (!ptsLess(mHeap[pos], mHeap[parent])) {
+            break;
+        }
+        heapSwap(pos, parent);
+        pos = parent;
+    }
+}
+
+void VideoDecoderOutputQueue::siftDown(int32_t pos) {
+    while (true) {
+        int32_t least = pos;
+        int32_t left = 2 * pos + 1;
+        int32_t right = left + 1;
+        if (left < mHeapSize && ptsLess(mHeap[left], mHeap[least])) {
+            least = left;
+        }
+        if (right < mHeapSize && ptsLess(mHeap[right], mHeap[least])) {
+            least = right;
+        }
+        if (least == pos) {
+            break;
+        }
+        heapSwap(pos, least);
+        pos = least;
+    }
+}
@@ -0,0 +1,84 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VIDEO_DECODER_OUTPUT_QUEUE_H_
+#define VIDEO_DECODER_OUTPUT_QUEUE_H_
+
+#include "VideoDecoderDefs.h"
+
+// Queue of decoded surface buffers waiting for output, kept in decoding order.
+// Buffers are indexed by their position in the surface buffer array, which gives
+// O(1) push/remove/length, O(1) access to the first non-reference and second reference
+// frame (output by PCT) and an O(log n) min-heap on presentation time stamp.
+// VideoSurfaceBuffer::next still links the queue in decoding order.
+class VideoDecoderOutputQueue {
+public:
+    VideoDecoderOutputQueue();
+    ~VideoDecoderOutputQueue();
+
+    Decode_Status init(VideoSurfaceBuffer *buffers, int32_t num);
+    void deinit(void);
+    void clear(void);
+
+    void push(VideoSurfaceBuffer *buffer);
+    void remove(VideoSurfaceBuffer *buffer);
+    void updateTimeStamp(VideoSurfaceBuffer *buffer, int64_t timeStamp);
+
+    VideoSurfaceBuffer* head(void) {return mHead;}
+    VideoSurfaceBuffer* tail(void) {return mTail;}
+    int32_t length(void) {return mLength;}
+    VideoSurfaceBuffer* firstNonReference(void);
+    VideoSurfaceBuffer* secondReference(void);
+    // buffer with the smallest time stamp, the latest decoded one if several are equal
+    VideoSurfaceBuffer* leastPts(void);
+    // true if a is decoded before b
+    bool before(VideoSurfaceBuffer *a, VideoSurfaceBuffer *b);
+
+private:
+    struct Node {
+        int32_t prev;         // previous buffer in decoding order
+        int32_t prevOfKind;   // previous/next buffer of the same kind (reference or not)
+        int32_t nextOfKind;
+        int32_t heapPos;      // position in mHeap, -1 if not queued
+        uint32_t seq;         // decoding order
+        bool reference;
+    };
+
+    enum {
+        INVALID_INDEX = -1,
+    };
+
+    int32_t indexOf(VideoSurfaceBuffer *buffer) {return buffer - mBuffers;}
+    bool ptsLess(int32_t a, int32_t b);
+    void heapSwap(int32_t i, int32_t j);
+    void siftUp(int32_t pos);
+    void siftDown(int32_t pos);
+
+    VideoSurfaceBuffer *mBuffers;
+    int32_t mNumBuffers;
+    Node *mNodes;
+    int32_t *mHeap;
+    int32_t mHeapSize;
+    VideoSurfaceBuffer *mHead;
+    VideoSurfaceBuffer *mTail;
+    // [0]: non-reference frames, [1]: reference frames
+    int32_t mKindHead[2];
+    int32_t mKindTail[2];
+    int32_t mLength;
+    uint32_t mSeq;
+};
+
+#endif  // VIDEO_DECODER_OUTPUT_QUEUE_H_
@@ -267,12 +267,12 @@ Decode_Status VideoDecoderVP8::decodePicture(vbp_data_vp8 *data, int32_t picInde
     status = setReference(picParams);
     CHECK_STATUS("setReference");
 
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
     // setting mDecodingFrame to true so vaEndPicture will be invoked to end the picture decoding.
     mDecodingFrame = true;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
                    mVADisplay,
                    mVAContext,
                    VAPictureParameterBufferType,
@@ -283,7 +283,7 @@ Decode_Status VideoDecoderVP8::decodePicture(vbp_data_vp8 *data, int32_t picInde
     CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
                    mVADisplay,
                    mVAContext,
                    VAProbabilityBufferType,
@@ -294,7 +294,7 @@ Decode_Status VideoDecoderVP8::decodePicture(vbp_data_vp8 *data, int32_t picInde
     CHECK_VA_STATUS("vaCreateProbabilityBuffer");
     bufferIDCount++;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
                    mVADisplay,
                    mVAContext,
                    VAIQMatrixBufferType,
@@ -307,7 +307,7 @@ Decode_Status VideoDecoderVP8::decodePicture(vbp_data_vp8 *data, int32_t picInde
 
     /* Here picData->num_slices is always equal to 1 */
     for (uint32_t i = 0; i < picData->num_slices; i++) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                        mVADisplay,
                        mVAContext,
                        VASliceParameterBufferType,
@@ -318,7 +318,7 @@ Decode_Status VideoDecoderVP8::decodePicture(vbp_data_vp8 *data, int32_t picInde
         CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                        mVADisplay,
                        mVAContext,
                        VASliceDataBufferType,
@@ -330,14 +330,14 @@ Decode_Status VideoDecoderVP8::decodePicture(vbp_data_vp8 *data, int32_t picInde
         bufferIDCount++;
     }
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
                    mVADisplay,
                    mVAContext,
                    bufferIDs,
                    bufferIDCount);
     CHECK_VA_STATUS("vaRenderPicture");
 
-    vaStatus = vaEndPicture(mVADisplay, mVAContext);
+    vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
     mDecodingFrame = false;
     CHECK_VA_STATUS("vaEndPicture");
 
@@ -469,7 +469,7 @@ Decode_Status VideoDecoderVP8::checkHardwareCapability() {
     VAConfigAttrib cfgAttribs[2];
     cfgAttribs[0].type = VAConfigAttribMaxPictureWidth;
     cfgAttribs[1].type = VAConfigAttribMaxPictureHeight;
-    vaStatus = vaGetConfigAttributes(mVADisplay, VAProfileVP8Version0_3,
+    vaStatus = mVA->GetConfigAttributes(mVADisplay, VAProfileVP8Version0_3,
             VAEntrypointVLD, cfgAttribs, 2);
     CHECK_VA_STATUS("vaGetConfigAttributes");
     if (cfgAttribs[0].value * cfgAttribs[1].value < (uint32_t)mVideoFormatInfo.width * (uint32_t)mVideoFormatInfo.height) {
@@ -174,7 +174,7 @@ Decode_Status VideoDecoderWMV::decodeFrame(VideoDecodeBuffer* buffer, vbp_data_v
         mAcquiredBuffer->renderBuffer.timeStamp = mCurrentPTS;
         mAcquiredBuffer->renderBuffer.flag = 0;
         mAcquiredBuffer->renderBuffer.scanFormat = mLastReference->renderBuffer.scanFormat;
-        mAcquiredBuffer->renderBuffer.surface = mLastReference->renderBuffer.surface;
+        shareSurfaceBuffer(mLastReference);
         // No need to update mappedData for HW decoding
         //mAcquiredBuffer->mappedData.data = mLastReference->mappedData.data;
         mAcquiredBuffer->referenceFrame = true;
@@ -259,12 +259,12 @@ Decode_Status VideoDecoderWMV::decodePicture(vbp_data_vc1 *data, int32_t picInde
         picParams->inloop_decoded_picture = VA_INVALID_SURFACE;
     }
 
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
     // setting mDecodingFrame to true so vaEndPicture will be invoked to end the picture decoding.
     mDecodingFrame = true;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -276,7 +276,7 @@ Decode_Status VideoDecoderWMV::decodePicture(vbp_data_vc1 *data, int32_t picInde
     bufferIDCount++;
 
     if (picParams->bitplane_present.value) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 VABitPlaneBufferType,
@@ -289,7 +289,7 @@ Decode_Status VideoDecoderWMV::decodePicture(vbp_data_vc1 *data, int32_t picInde
     }
 
     for (uint32_t i = 0; i < picData->num_slices; i++) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 VASliceParameterBufferType,
@@ -300,7 +300,7 @@ Decode_Status VideoDecoderWMV::decodePicture(vbp_data_vc1 *data, int32_t picInde
         CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 VASliceDataBufferType,
@@ -318,14 +318,14 @@ Decode_Status VideoDecoderWMV::decodePicture(vbp_data_vc1 *data, int32_t picInde
         bufferIDCount++;
     }
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
             mVADisplay,
             mVAContext,
             mBufferIDs,
             bufferIDCount);
     CHECK_VA_STATUS("vaRenderPicture");
 
-    vaStatus = vaEndPicture(mVADisplay, mVAContext);
+    vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
     mDecodingFrame = false;
     CHECK_VA_STATUS("vaRenderPicture");
 
@@ -573,7 +573,7 @@ Decode_Status VideoDecoderWMV::checkHardwareCapability() {
     VAConfigAttrib cfgAttribs[2];
     cfgAttribs[0].type = VAConfigAttribMaxPictureWidth;
     cfgAttribs[1].type = VAConfigAttribMaxPictureHeight;
-    vaStatus = vaGetConfigAttributes(mVADisplay, VAProfileVC1Advanced,
+    vaStatus = mVA->GetConfigAttributes(mVADisplay, VAProfileVC1Advanced,
             VAEntrypointVLD, cfgAttribs, 2);
     CHECK_VA_STATUS("vaGetConfigAttributes");
     if (cfgAttribs[0].value * cfgAttribs[1].value < (uint32_t)mVideoFormatInfo.width * (uint32_t)mVideoFormatInfo.height) {
@@ -229,7 +229,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         }
         if (mDecodingFrame) {
             // interlace content, complete decoding the first field
-            vaStatus = vaEndPicture(mVADisplay, mVAContext);
+            vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
             CHECK_VA_STATUS("vaEndPicture");
 
             // for interlace content, top field may be valid only after the second field is parsed
@@ -240,13 +240,13 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         status = updateDPB(picParam);
         CHECK_STATUS("updateDPB");
 
-        vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+        vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
         CHECK_VA_STATUS("vaBeginPicture");
 
         // start decoding a frame
         mDecodingFrame = true;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -257,7 +257,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -277,7 +277,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
             encryptParam.app_id = 0;
             memcpy(encryptParam.pavpAesCounter, mEncParam.iv, 16);
 
-            vaStatus = vaCreateBuffer(
+            vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 (VABufferType)VAEncryptionParameterBufferType,
@@ -289,7 +289,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
             bufferIDCount++;
         }
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VASliceDataBufferType,
@@ -302,7 +302,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
 
     }
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -314,7 +314,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
@@ -340,7 +340,7 @@ Decode_Status VideoDecoderAVCSecure::getCodecSpecificConfigs(
     attrib[1].type = VAConfigAttribDecSliceMode;
     attrib[1].value = VA_DEC_SLICE_MODE_NORMAL;
 
-    vaStatus = vaGetConfigAttributes(mVADisplay,profile,VAEntrypointVLD, &attrib[1], 1);
+    vaStatus = mVA->GetConfigAttributes(mVADisplay,profile,VAEntrypointVLD, &attrib[1], 1);
 
     if (attrib[1].value & VA_DEC_SLICE_MODE_BASE)
     {
@@ -354,7 +354,7 @@ Decode_Status VideoDecoderAVCSecure::getCodecSpecificConfigs(
         return DECODE_FAIL;
     }
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay,
             profile,
             VAEntrypointVLD,
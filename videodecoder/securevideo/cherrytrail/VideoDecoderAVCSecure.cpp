@@ -213,7 +213,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         }
         if (mDecodingFrame) {
             // interlace content, complete decoding the first field
-            vaStatus = vaEndPicture(mVADisplay, mVAContext);
+            vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
             CHECK_VA_STATUS("vaEndPicture");
 
             // for interlace content, top field may be valid only after the second field is parsed
@@ -224,13 +224,13 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         status = updateDPB(picParam);
         CHECK_STATUS("updateDPB");
 
-        vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+        vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
         CHECK_VA_STATUS("vaBeginPicture");
 
         // start decoding a frame
         mDecodingFrame = true;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -241,7 +241,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -261,7 +261,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
             encryptParam.app_id = 0;
             memcpy(encryptParam.pavpAesCounter, mEncParam.iv, 16);
 
-            vaStatus = vaCreateBuffer(
+            vaStatus = mVA->CreateBuffer(
                 mVADisplay,
                 mVAContext,
                 (VABufferType)VAEncryptionParameterBufferType,
@@ -273,7 +273,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
             bufferIDCount++;
         }
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VASliceDataBufferType,
@@ -286,7 +286,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
 
     }
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -298,7 +298,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
@@ -324,7 +324,7 @@ Decode_Status VideoDecoderAVCSecure::getCodecSpecificConfigs(
     attrib[1].type = VAConfigAttribDecSliceMode;
     attrib[1].value = VA_DEC_SLICE_MODE_NORMAL;
 
-    vaStatus = vaGetConfigAttributes(mVADisplay,profile,VAEntrypointVLD, &attrib[1], 1);
+    vaStatus = mVA->GetConfigAttributes(mVADisplay,profile,VAEntrypointVLD, &attrib[1], 1);
 
     if (attrib[1].value & VA_DEC_SLICE_MODE_BASE)
     {
@@ -338,7 +338,7 @@ Decode_Status VideoDecoderAVCSecure::getCodecSpecificConfigs(
         return DECODE_FAIL;
     }
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay,
             profile,
             VAEntrypointVLD,
@@ -223,7 +223,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         }
         if (mDecodingFrame) {
             // interlace content, complete decoding the first field
-            vaStatus = vaEndPicture(mVADisplay, mVAContext);
+            vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
             CHECK_VA_STATUS("vaEndPicture");
 
             // for interlace content, top field may be valid only after the second field is parsed
@@ -240,13 +240,13 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         status = updateReferenceFrames(picData);
         CHECK_STATUS("updateReferenceFrames");
 
-        vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+        vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
         CHECK_VA_STATUS("vaBeginPicture");
 
         // start decoding a frame
         mDecodingFrame = true;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -257,7 +257,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -300,7 +300,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     // sliceParam->slice_data_offset - 0 always
     // sliceParam->slice_data_bit_offset - relative to  sliceData->slice_offset
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -315,7 +315,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     // offset points to first byte of NAL unit
     uint32_t sliceOffset = mMetadata.naluInfo[naluIndex].naluOffset;
     if (mInputBuffer != NULL) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VASliceDataBufferType,
@@ -324,7 +324,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
             mInputBuffer  + sliceOffset,
             &bufferIDs[bufferIDCount]);
     } else {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAProtectedSliceDataBufferType,
@@ -336,7 +336,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     CHECK_VA_STATUS("vaCreateSliceDataBuffer");
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
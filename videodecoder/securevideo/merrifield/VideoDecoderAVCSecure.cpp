@@ -481,10 +481,10 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(VideoDecodeBuffer *
     if (mFrameSize <= 0) {
         return DECODE_SUCCESS;
     }
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VAParseSliceHeaderGroupBufferType,
@@ -495,7 +495,7 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(VideoDecodeBuffer *
     CHECK_VA_STATUS("vaCreateSliceHeaderGroupBuffer");
 
     void *sliceheaderbuf;
-    vaStatus = vaMapBuffer(
+    vaStatus = mVA->MapBuffer(
         mVADisplay,
         sliceheaderbufferID,
         &sliceheaderbuf);
@@ -503,13 +503,13 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(VideoDecodeBuffer *
 
     memset(sliceheaderbuf, 0, MAX_SLICEHEADER_BUFFER_SIZE);
 
-    vaStatus = vaUnmapBuffer(
+    vaStatus = mVA->UnmapBuffer(
         mVADisplay,
         sliceheaderbufferID);
     CHECK_VA_STATUS("vaUnmapBuffer");
 
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceDataBufferType,
@@ -545,7 +545,7 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(VideoDecodeBuffer *
     VTRACE("pic_parse_buffer->num_ref_idc_l1_active_minus1 = %d", data->pic_parse_buffer->num_ref_idc_l1_active_minus1);
 #endif
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VAParsePictureParameterBufferType,
@@ -555,14 +555,14 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(VideoDecodeBuffer *
         &pictureparameterparsingbufferID);
     CHECK_VA_STATUS("vaCreatePictureParameterParsingBuffer");
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         &pictureparameterparsingbufferID,
         1);
     CHECK_VA_STATUS("vaRenderPicture");
 
-    vaStatus = vaMapBuffer(
+    vaStatus = mVA->MapBuffer(
         mVADisplay,
         sliceheaderbufferID,
         &sliceheaderbuf);
@@ -571,7 +571,7 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(VideoDecodeBuffer *
     status = updateSliceParameter(data,sliceheaderbuf);
     CHECK_STATUS("processSliceHeader");
 
-    vaStatus = vaUnmapBuffer(
+    vaStatus = mVA->UnmapBuffer(
         mVADisplay,
         sliceheaderbufferID);
     CHECK_VA_STATUS("vaUnmapBuffer");
@@ -588,7 +588,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
     VABufferID mSlicebufferID;
     int32_t sliceIdx;
 
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
 
     if (mFrameSize <= 0 || mSliceNum <=0) {
@@ -600,7 +600,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
     int32_t size = 0;
 
     for (sliceIdx = 0; sliceIdx < mSliceNum; sliceIdx++) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAParseSliceHeaderGroupBufferType,
@@ -610,7 +610,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
             &sliceheaderbufferID);
         CHECK_VA_STATUS("vaCreateSliceHeaderGroupBuffer");
 
-        vaStatus = vaMapBuffer(
+        vaStatus = mVA->MapBuffer(
             mVADisplay,
             sliceheaderbufferID,
             &sliceheaderbuf);
@@ -618,12 +618,12 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
 
         memset(sliceheaderbuf, 0, MAX_SLICEHEADER_BUFFER_SIZE);
 
-        vaStatus = vaUnmapBuffer(
+        vaStatus = mVA->UnmapBuffer(
             mVADisplay,
             sliceheaderbufferID);
         CHECK_VA_STATUS("vaUnmapBuffer");
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VASliceDataBufferType,
@@ -660,7 +660,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
         VTRACE("pic_parse_buffer->num_ref_idc_l0_active_minus1 = %d", data->pic_parse_buffer->num_ref_idc_l0_active_minus1);
         VTRACE("pic_parse_buffer->num_ref_idc_l1_active_minus1 = %d", data->pic_parse_buffer->num_ref_idc_l1_active_minus1);
 #endif
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAParsePictureParameterBufferType,
@@ -670,14 +670,14 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
             &pictureparameterparsingbufferID);
         CHECK_VA_STATUS("vaCreatePictureParameterParsingBuffer");
 
-        vaStatus = vaRenderPicture(
+        vaStatus = mVA->RenderPicture(
             mVADisplay,
             mVAContext,
             &pictureparameterparsingbufferID,
             1);
         CHECK_VA_STATUS("vaRenderPicture");
 
-        vaStatus = vaMapBuffer(
+        vaStatus = mVA->MapBuffer(
             mVADisplay,
             sliceheaderbufferID,
             &sliceheaderbuf);
@@ -691,7 +691,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(VideoDecodeBuffer *
         } else {
             WTRACE("Cached slice header is not big enough!");
         }
-        vaStatus = vaUnmapBuffer(
+        vaStatus = mVA->UnmapBuffer(
             mVADisplay,
             sliceheaderbufferID);
         CHECK_VA_STATUS("vaUnmapBuffer");
@@ -744,7 +744,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
 
         mDecodingFrame = true;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -755,7 +755,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -785,7 +785,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         slice_data_addr = mFrameData;
     }
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -796,7 +796,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
@@ -805,7 +805,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
 
     VABufferID slicebufferID;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceDataBufferType,
@@ -815,7 +815,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         &slicebufferID);
     CHECK_VA_STATUS("vaCreateSliceDataBuffer");
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         &slicebufferID,
@@ -845,7 +845,7 @@ Decode_Status VideoDecoderAVCSecure::getCodecSpecificConfigs(
         attrib[1].value = VA_DEC_SLICE_MODE_SUBSAMPLE;
     }
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay,
             profile,
             VAEntrypointVLD,
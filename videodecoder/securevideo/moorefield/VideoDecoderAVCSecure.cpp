@@ -501,10 +501,10 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(vbp_data_h264 *data
     if (mFrameSize <= 0) {
         return DECODE_SUCCESS;
     }
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VAParseSliceHeaderGroupBufferType,
@@ -515,7 +515,7 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(vbp_data_h264 *data
     CHECK_VA_STATUS("vaCreateSliceHeaderGroupBuffer");
 
     void *sliceheaderbuf;
-    vaStatus = vaMapBuffer(
+    vaStatus = mVA->MapBuffer(
         mVADisplay,
         sliceheaderbufferID,
         &sliceheaderbuf);
@@ -523,13 +523,13 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(vbp_data_h264 *data
 
     memset(sliceheaderbuf, 0, MAX_SLICEHEADER_BUFFER_SIZE);
 
-    vaStatus = vaUnmapBuffer(
+    vaStatus = mVA->UnmapBuffer(
         mVADisplay,
         sliceheaderbufferID);
     CHECK_VA_STATUS("vaUnmapBuffer");
 
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceDataBufferType,
@@ -565,7 +565,7 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(vbp_data_h264 *data
     VTRACE("pic_parse_buffer->num_ref_idc_l1_active_minus1 = %d", data->pic_parse_buffer->num_ref_idc_l1_active_minus1);
 #endif
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VAParsePictureParameterBufferType,
@@ -575,14 +575,14 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(vbp_data_h264 *data
         &pictureparameterparsingbufferID);
     CHECK_VA_STATUS("vaCreatePictureParameterParsingBuffer");
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         &pictureparameterparsingbufferID,
         1);
     CHECK_VA_STATUS("vaRenderPicture");
 
-    vaStatus = vaMapBuffer(
+    vaStatus = mVA->MapBuffer(
         mVADisplay,
         sliceheaderbufferID,
         &sliceheaderbuf);
@@ -591,7 +591,7 @@ Decode_Status VideoDecoderAVCSecure::parseClassicSliceHeader(vbp_data_h264 *data
     status = updateSliceParameter(data,sliceheaderbuf);
     CHECK_STATUS("processSliceHeader");
 
-    vaStatus = vaUnmapBuffer(
+    vaStatus = mVA->UnmapBuffer(
         mVADisplay,
         sliceheaderbufferID);
     CHECK_VA_STATUS("vaUnmapBuffer");
@@ -608,7 +608,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
     VABufferID mSlicebufferID;
     int32_t sliceIdx;
 
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, mAcquiredBuffer->renderBuffer.surface);
     CHECK_VA_STATUS("vaBeginPicture");
 
     if (mFrameSize <= 0 || mSliceNum <=0) {
@@ -620,7 +620,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
     int32_t size = 0;
 
     for (sliceIdx = 0; sliceIdx < mSliceNum; sliceIdx++) {
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAParseSliceHeaderGroupBufferType,
@@ -630,7 +630,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
             &sliceheaderbufferID);
         CHECK_VA_STATUS("vaCreateSliceHeaderGroupBuffer");
 
-        vaStatus = vaMapBuffer(
+        vaStatus = mVA->MapBuffer(
             mVADisplay,
             sliceheaderbufferID,
             &sliceheaderbuf);
@@ -638,12 +638,12 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
 
         memset(sliceheaderbuf, 0, MAX_SLICEHEADER_BUFFER_SIZE);
 
-        vaStatus = vaUnmapBuffer(
+        vaStatus = mVA->UnmapBuffer(
             mVADisplay,
             sliceheaderbufferID);
         CHECK_VA_STATUS("vaUnmapBuffer");
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VASliceDataBufferType,
@@ -680,7 +680,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
         VTRACE("pic_parse_buffer->num_ref_idc_l0_active_minus1 = %d", data->pic_parse_buffer->num_ref_idc_l0_active_minus1);
         VTRACE("pic_parse_buffer->num_ref_idc_l1_active_minus1 = %d", data->pic_parse_buffer->num_ref_idc_l1_active_minus1);
 #endif
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAParsePictureParameterBufferType,
@@ -690,14 +690,14 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
             &pictureparameterparsingbufferID);
         CHECK_VA_STATUS("vaCreatePictureParameterParsingBuffer");
 
-        vaStatus = vaRenderPicture(
+        vaStatus = mVA->RenderPicture(
             mVADisplay,
             mVAContext,
             &pictureparameterparsingbufferID,
             1);
         CHECK_VA_STATUS("vaRenderPicture");
 
-        vaStatus = vaMapBuffer(
+        vaStatus = mVA->MapBuffer(
             mVADisplay,
             sliceheaderbufferID,
             &sliceheaderbuf);
@@ -711,7 +711,7 @@ Decode_Status VideoDecoderAVCSecure::parseModularSliceHeader(vbp_data_h264 *data
         } else {
             WTRACE("Cached slice header is not big enough!");
         }
-        vaStatus = vaUnmapBuffer(
+        vaStatus = mVA->UnmapBuffer(
             mVADisplay,
             sliceheaderbufferID);
         CHECK_VA_STATUS("vaUnmapBuffer");
@@ -764,7 +764,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
 
         mDecodingFrame = true;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAPictureParameterBufferType,
@@ -775,7 +775,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         CHECK_VA_STATUS("vaCreatePictureParameterBuffer");
         bufferIDCount++;
 
-        vaStatus = vaCreateBuffer(
+        vaStatus = mVA->CreateBuffer(
             mVADisplay,
             mVAContext,
             VAIQMatrixBufferType,
@@ -805,7 +805,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         slice_data_addr = mFrameData;
     }
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceParameterBufferType,
@@ -816,7 +816,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
     CHECK_VA_STATUS("vaCreateSliceParameterBuffer");
     bufferIDCount++;
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         bufferIDs,
@@ -825,7 +825,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
 
     VABufferID slicebufferID;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
         mVADisplay,
         mVAContext,
         VASliceDataBufferType,
@@ -835,7 +835,7 @@ Decode_Status VideoDecoderAVCSecure::decodeSlice(vbp_data_h264 *data, uint32_t p
         &slicebufferID);
     CHECK_VA_STATUS("vaCreateSliceDataBuffer");
 
-    vaStatus = vaRenderPicture(
+    vaStatus = mVA->RenderPicture(
         mVADisplay,
         mVAContext,
         &slicebufferID,
@@ -865,7 +865,7 @@ Decode_Status VideoDecoderAVCSecure::getCodecSpecificConfigs(
         attrib[1].value = VA_DEC_SLICE_MODE_SUBSAMPLE;
     }
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay,
             profile,
             VAEntrypointVLD,
@@ -8,7 +8,7 @@ LOCAL_CFLAGS += \
     -DOSCL_UNUSED_ARG= \
     -DOSCL_EXPORT_REF=
 
-LOCAL_STATIC_LIBRARIES := \
+LOCAL_STATIC_LIBRARIES += \
     libstagefright_m4vh263enc
 endif
 
@@ -19,7 +19,8 @@ LOCAL_SRC_FILES := \
     VideoEncoderMP4.cpp \
     VideoEncoderVP8.cpp \
     VideoEncoderUtils.cpp \
-    VideoEncoderHost.cpp
+    VideoEncoderHost.cpp \
+    VideoEncoderScheduler.cpp
 
 # VideoEncoderAVC.cpp has extraneous parentheses and
 # uses va_enc_h264.h with empty union.
@@ -34,7 +35,9 @@ endif
 LOCAL_C_INCLUDES := \
     $(TARGET_OUT_HEADERS)/libva \
     $(call include-path-for, frameworks-native) \
-    $(TARGET_OUT_HEADERS)/pvr
+    $(TARGET_OUT_HEADERS)/pvr \
+    $(LOCAL_PATH)/../vabackend \
+    $(LOCAL_PATH)/../planecopy
 
 ifeq ($(ENABLE_IMG_GRAPHICS),)
 LOCAL_C_INCLUDES += \
@@ -46,6 +49,10 @@ LOCAL_C_INCLUDES += \
     frameworks/av/media/libstagefright/include
 endif
 
+LOCAL_STATIC_LIBRARIES += \
+    libva_backend \
+    libmix_planecopy
+
 LOCAL_SHARED_LIBRARIES := \
     libcutils \
     libutils \
@@ -61,7 +68,8 @@ LOCAL_COPY_HEADERS_TO  := libmix_videoencoder
 LOCAL_COPY_HEADERS := \
     VideoEncoderHost.h \
     VideoEncoderInterface.h \
-    VideoEncoderDef.h
+    VideoEncoderDef.h \
+    VideoEncoderScheduler.h
 
 ifeq ($(VIDEO_ENC_LOG_ENABLE),true)
 LOCAL_CPPFLAGS += -DVIDEO_ENC_LOG_ENABLE
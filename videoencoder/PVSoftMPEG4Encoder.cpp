@@ -29,57 +29,29 @@
 
 #include <ui/GraphicBufferMapper.h>
 #include <ui/Rect.h>
+#include <unistd.h>
 
 #include "PVSoftMPEG4Encoder.h"
 #include "VideoEncoderLog.h"
+#include "PlaneCopy.h"
+#include "PlaneConvert.h"
 
 #define ALIGN(x, align)                  (((x) + (align) - 1) & (~((align) - 1)))
 
-inline static void ConvertYUV420SemiPlanarToYUV420Planar(
-        uint8_t *inyuv, uint8_t* outyuv,
-        int32_t width, int32_t height) {
+// Crop a pitched NV12 frame to width x height and write it as the contiguous
+// I420 frame PVEncodeVideoFrame reads, reading each source byte once.
+inline static void ConvertNV12ToYUV420Planar(
+        const uint8_t *dataIn, uint8_t *dataOut,
+        int32_t width, int32_t height,
+        int32_t alignedHeight, int32_t stride) {
 
     int32_t outYsize = width * height;
-    uint32_t *outy =  (uint32_t *) outyuv;
-    uint16_t *outcb = (uint16_t *) (outyuv + outYsize);
-    uint16_t *outcr = (uint16_t *) (outyuv + outYsize + (outYsize >> 2));
-
-    /* Y copying */
-    memcpy(outy, inyuv, outYsize);
-
-    /* U & V copying */
-    uint32_t *inyuv_4 = (uint32_t *) (inyuv + outYsize);
-    for (int32_t i = height >> 1; i > 0; --i) {
-        for (int32_t j = width >> 2; j > 0; --j) {
-            uint32_t temp = *inyuv_4++;
-            uint32_t tempU = temp & 0xFF;
-            tempU = tempU | ((temp >> 8) & 0xFF00);
-
-            uint32_t tempV = (temp >> 8) & 0xFF;
-            tempV = tempV | ((temp >> 16) & 0xFF00);
-
-            // Flip U and V
-            *outcb++ = tempU;
-            *outcr++ = tempV;
-        }
-    }
-}
+    uint8_t *outcb = dataOut + outYsize;
+    uint8_t *outcr = outcb + (outYsize >> 2);
 
-inline static void trimBuffer(uint8_t *dataIn, uint8_t *dataOut,
-        int32_t width, int32_t height,
-        int32_t alignedHeight, int32_t stride) {
-    int32_t h;
-    uint8_t *y_start, *uv_start, *_y_start, *_uv_start;
-    y_start = dataOut;
-    uv_start = dataOut + width * height;
-    _y_start = dataIn;
-    _uv_start = dataIn + stride * alignedHeight;
-
-    for (h = 0; h < height; h++)
-        memcpy(y_start + h * width, _y_start + h * stride, width);
-    for (h = 0; h < height / 2; h++)
-        memcpy(uv_start + h * width,
-                _uv_start + h * stride, width);
+    copyPlane(dataOut, width, dataIn, stride, width, height);
+    deinterleaveUV(outcb, outcr, width >> 1,
+            dataIn + stride * alignedHeight, stride, width >> 1, height >> 1);
 }
 
 PVSoftMPEG4Encoder::PVSoftMPEG4Encoder(const char *name)
@@ -97,8 +69,17 @@ PVSoftMPEG4Encoder::PVSoftMPEG4Encoder(const char *name)
       mSignalledError(false),
       mHandle(new tagvideoEncControls),
       mEncParams(new tagvideoEncOptions),
-      mInputFrameData(NULL)
+      mInputFrameData(NULL),
+      mAsyncEncode(false),
+      mEncodeThreadExit(false),
+      mQueueDepth(0),
+      mFillPos(0),
+      mEncodePos(0),
+      mOutputPos(0),
+      mPending(0),
+      mReady(0)
 {
+    memset(mSlots, 0, sizeof(mSlots));
 
     if (!strcmp(name, "OMX.google.h263.encoder")) {
         mEncodeMode = H263_MODE;
@@ -185,17 +166,11 @@ Encode_Status PVSoftMPEG4Encoder::initEncParams() {
     mEncParams->quantType[0] = 0;
     mEncParams->noFrameSkipped = PV_OFF;
 
-    mTrimedInputData =
+    // planar frame for the synchronous path, input is converted straight into it
+    CHECK(mInputFrameData == NULL);
+    mInputFrameData =
         (uint8_t *) malloc((mVideoWidth * mVideoHeight * 3 ) >> 1);
-    CHECK(mTrimedInputData != NULL);
-
-    if (mVideoColorFormat == OMX_COLOR_FormatYUV420SemiPlanar) {
-        // Color conversion is needed.
-        CHECK(mInputFrameData == NULL);
-        mInputFrameData =
-            (uint8_t *) malloc((mVideoWidth * mVideoHeight * 3 ) >> 1);
-        CHECK(mInputFrameData != NULL);
-    }
+    CHECK(mInputFrameData != NULL);
 
     // PV's MPEG4 encoder requires the video dimension of multiple
     if (mVideoWidth % 16 != 0 || mVideoHeight % 16 != 0) {
@@ -249,6 +224,16 @@ Encode_Status PVSoftMPEG4Encoder::initEncoder() {
     mLastTimestampUs = 0;
     mVolHeaderLength = 256;
 
+    // a second core is needed for staging and encoding to overlap
+    if (!mComParams.syncEncMode && sysconf(_SC_NPROCESSORS_ONLN) > 1) {
+        ret = startEncodeThread();
+        if (ret != ENCODE_SUCCESS) {
+            LOG_E("Failed to start encode thread");
+            mSignalledError = true;
+            return ret;
+        }
+    }
+
     LOG_V("End\n");
 
     return ENCODE_SUCCESS;
@@ -261,12 +246,10 @@ Encode_Status PVSoftMPEG4Encoder::releaseEncoder() {
         return ENCODE_SUCCESS;
     }
 
+    stopEncodeThread();
     PVCleanUpVideoEncoder(mHandle);
 
-    delete mTrimedInputData;
-    mTrimedInputData = NULL;
-
-    delete mInputFrameData;
+    free(mInputFrameData);
     mInputFrameData = NULL;
 
     delete mEncParams;
@@ -380,28 +363,104 @@ Encode_Status PVSoftMPEG4Encoder::getParameters(
     return ret;
 }
 
-Encode_Status PVSoftMPEG4Encoder::encode(VideoEncRawBuffer *inBuffer, uint32_t timeout)
-{
-    LOG_V("Begin\n");
+Encode_Status PVSoftMPEG4Encoder::startEncodeThread() {
+    mQueueDepth = mComParams.codedBufNum;
+    if (mQueueDepth > MAX_ENCODE_QUEUE_DEPTH) {
+        mQueueDepth = MAX_ENCODE_QUEUE_DEPTH;
+    }
+    mFillPos = mEncodePos = mOutputPos = 0;
+    mPending = mReady = 0;
+    mEncodeThreadExit = false;
+
+    // usually enough for a frame, encodeLoop grows the bitstream if PV overruns it
+    int32_t frameSize = (mVideoWidth * mVideoHeight * 3) >> 1;
+    for (uint32_t i = 0; i < mQueueDepth; i++) {
+        mSlots[i].frame = (uint8_t *) malloc(frameSize);
+        mSlots[i].bitstream = (uint8_t *) malloc(frameSize);
+        mSlots[i].bitstreamSize = frameSize;
+        if (mSlots[i].frame == NULL || mSlots[i].bitstream == NULL) {
+            stopEncodeThread();
+            return ENCODE_NO_MEMORY;
+        }
+    }
 
-    Encode_Status ret = ENCODE_SUCCESS;
+    if (pthread_create(&mEncodeThread, NULL, encodeThreadEntry, this) != 0) {
+        stopEncodeThread();
+        return ENCODE_FAIL;
+    }
+    mAsyncEncode = true;
+    LOG_I("Frames are encoded on a separate thread, queue depth %d", mQueueDepth);
+    return ENCODE_SUCCESS;
+}
 
-    if (mCurTimestampUs <= inBuffer->timeStamp) {
-        mLastTimestampUs = mCurTimestampUs;
-        mCurTimestampUs = inBuffer->timeStamp;
+void PVSoftMPEG4Encoder::stopEncodeThread() {
+    if (mAsyncEncode) {
+        mSlotLock.lock();
+        mEncodeThreadExit = true;
+        mSlotFilledCond.broadcast();
+        mSlotFreeCond.broadcast();
+        mSlotEncodedCond.broadcast();
+        mSlotLock.unlock();
+        // the frame being encoded, if any, is finished before the thread exits
+        pthread_join(mEncodeThread, NULL);
+        mAsyncEncode = false;
     }
 
-    if (mNumInputFrames < 0) {
-        if (!PVGetVolHeader(mHandle, mVolHeader, &mVolHeaderLength, 0)) {
-            LOG_E("Failed to get VOL header");
-            mSignalledError = true;
-            return ENCODE_FAIL;
+    for (uint32_t i = 0; i < MAX_ENCODE_QUEUE_DEPTH; i++) {
+        free(mSlots[i].frame);
+        free(mSlots[i].bitstream);
+        mSlots[i].frame = NULL;
+        mSlots[i].bitstream = NULL;
+        mSlots[i].bitstreamSize = 0;
+    }
+    mPending = mReady = 0;
+}
+
+void* PVSoftMPEG4Encoder::encodeThreadEntry(void *arg) {
+    ((PVSoftMPEG4Encoder *)arg)->encodeLoop();
+    return NULL;
+}
+
+void PVSoftMPEG4Encoder::encodeLoop() {
+    mSlotLock.lock();
+    while (true) {
+        while (mPending == 0 && !mEncodeThreadExit) {
+            mSlotFilledCond.wait(mSlotLock);
         }
-        LOG_I("Output VOL header: %d bytes", mVolHeaderLength);
-        mNumInputFrames++;
-        //return ENCODE_SUCCESS;
+        if (mEncodeThreadExit) {
+            break;
+        }
+        // slots from mEncodePos to mFillPos are only touched by this thread until encoded
+        EncodeSlot *slot = &mSlots[mEncodePos];
+        mSlotLock.unlock();
+
+        slot->dataLength = slot->bitstreamSize;
+        slot->status = encodeFrame(slot->frame, slot->timeStamp,
+                slot->bitstream, &slot->dataLength, &slot->flag);
+        if (slot->status == ENCODE_BUFFER_TOO_SMALL) {
+            // the whole frame is in PV's overrun buffer until the next frame is encoded
+            uint8_t *bitstream = (uint8_t *) realloc(slot->bitstream, slot->dataLength);
+            if (bitstream != NULL) {
+                LOG_I("Bitstream buffer grown to %d bytes\n", slot->dataLength);
+                slot->bitstream = bitstream;
+                slot->bitstreamSize = slot->dataLength;
+                memcpy(slot->bitstream, PVGetOverrunBuffer(mHandle), slot->dataLength);
+                slot->status = ENCODE_SUCCESS;
+            } else {
+                slot->status = ENCODE_NO_MEMORY;
+            }
+        }
+
+        mSlotLock.lock();
+        mEncodePos = (mEncodePos + 1) % mQueueDepth;
+        mPending--;
+        mReady++;
+        mSlotEncodedCond.signal();
     }
+    mSlotLock.unlock();
+}
 
+void PVSoftMPEG4Encoder::prepareInput(VideoEncRawBuffer *inBuffer, uint8_t *frame) {
     if (mStoreMetaDataInBuffers) {
         IntelMetadataBuffer imb;
         int32_t type;
@@ -423,26 +482,133 @@ Encode_Status PVSoftMPEG4Encoder::encode(VideoEncRawBuffer *inBuffer, uint32_t t
             img = (uint8_t*)value;
         }
         if (pvinfo != NULL)
-            trimBuffer(img, mTrimedInputData, pvinfo->width, pvinfo->height,
+            ConvertNV12ToYUV420Planar(img, frame, mVideoWidth, mVideoHeight,
                    pvinfo->height, pvinfo->lumaStride);
         else {
             //NV12 Y-TILED
-            trimBuffer(img, mTrimedInputData, mVideoWidth, mVideoHeight,
+            ConvertNV12ToYUV420Planar(img, frame, mVideoWidth, mVideoHeight,
                     ALIGN(mVideoHeight, 32), ALIGN(mVideoWidth, 128));
             android::GraphicBufferMapper::get().unlock((buffer_handle_t)value);
         }
+    } else if (mVideoColorFormat != OMX_COLOR_FormatYUV420Planar) {
+        ConvertNV12ToYUV420Planar(inBuffer->data, frame, mVideoWidth, mVideoHeight,
+                mVideoHeight, mVideoWidth);
     } else {
-        memcpy(mTrimedInputData, inBuffer->data,
+        memcpy(frame, inBuffer->data,
                 (mVideoWidth * mVideoHeight * 3 ) >> 1);
     }
+}
 
-    if (mVideoColorFormat != OMX_COLOR_FormatYUV420Planar) {
-        ConvertYUV420SemiPlanarToYUV420Planar(
-                mTrimedInputData, mInputFrameData, mVideoWidth, mVideoHeight);
-    } else {
-        memcpy(mTrimedInputData, mInputFrameData,
-                (mVideoWidth * mVideoHeight * 3 ) >> 1);
+Encode_Status PVSoftMPEG4Encoder::encodeFrame(uint8_t *frame, int64_t timeStamp,
+        uint8_t *outPtr, int32_t *dataLength, uint32_t *flag) {
+
+    Encode_Status ret = ENCODE_SUCCESS;
+
+    VideoEncFrameIO vin, vout;
+    memset(&vin, 0, sizeof(vin));
+    memset(&vout, 0, sizeof(vout));
+    vin.height = ((mVideoHeight  + 15) >> 4) << 4;
+    vin.pitch = ((mVideoWidth + 15) >> 4) << 4;
+    vin.timestamp = (timeStamp + 500) / 1000;  // in ms
+    vin.yChan = frame;
+    vin.uChan = vin.yChan + vin.height * vin.pitch;
+    vin.vChan = vin.uChan + ((vin.height * vin.pitch) >> 2);
+
+    unsigned long modTimeMs = 0;
+    int32_t nLayer = 0;
+    MP4HintTrack hintTrack;
+    if (!PVEncodeVideoFrame(mHandle, &vin, &vout,
+                &modTimeMs, outPtr, dataLength, &nLayer) ||
+            !PVGetHintTrack(mHandle, &hintTrack)) {
+        LOG_E("Failed to encode frame or get hink track at %lld us",
+                timeStamp);
+        // also runs on the encode thread
+        android::Mutex::Autolock autoLock(mSlotLock);
+        mSignalledError = true;
+        hintTrack.CodeType = 0;
+        ret = ENCODE_FAIL;
     }
+    LOG_I("dataLength %d\n", *dataLength);
+    if (ret == ENCODE_SUCCESS && PVGetOverrunBuffer(mHandle) != NULL) {
+        // outPtr only holds the start of the frame, *dataLength is the full size
+        LOG_E("Encoded frame size %d overruns the output buffer\n", *dataLength);
+        ret = ENCODE_BUFFER_TOO_SMALL;
+    }
+
+    *flag = ENCODE_BUFFERFLAG_ENDOFFRAME;
+    if (hintTrack.CodeType == 0) {  // I-frame serves as sync frame
+        *flag |= ENCODE_BUFFERFLAG_SYNCFRAME;
+    }
+
+    return ret;
+}
+
+Encode_Status PVSoftMPEG4Encoder::encode(VideoEncRawBuffer *inBuffer, uint32_t timeout)
+{
+    LOG_V("Begin\n");
+
+    Encode_Status ret = ENCODE_SUCCESS;
+    EncodeSlot *slot = NULL;
+
+    if (mAsyncEncode) {
+        // wait for a free slot the same way VideoEncoderBase waits for a coded buffer
+        mSlotLock.lock();
+        while (mPending + mReady >= mQueueDepth && !mEncodeThreadExit) {
+            if (timeout == FUNC_BLOCK) {
+                mSlotFreeCond.wait(mSlotLock);
+            } else if (timeout > 0) {
+                if (NO_ERROR != mSlotFreeCond.waitRelative(mSlotLock, 1000000LL * timeout)) {
+                    mSlotLock.unlock();
+                    LOG_E("Time out wait for free input slot.\n");
+                    return ENCODE_DEVICE_BUSY;
+                }
+            } else {//Nonblock
+                mSlotLock.unlock();
+                LOG_E("Input slot is not ready now.\n");
+                return ENCODE_DEVICE_BUSY;
+            }
+        }
+        if (mEncodeThreadExit) {
+            mSlotLock.unlock();
+            return ENCODE_NOT_INIT;
+        }
+        slot = &mSlots[mFillPos];
+        mSlotLock.unlock();
+    }
+
+    if (mCurTimestampUs <= inBuffer->timeStamp) {
+        mLastTimestampUs = mCurTimestampUs;
+        mCurTimestampUs = inBuffer->timeStamp;
+    }
+
+    if (mNumInputFrames < 0) {
+        if (!PVGetVolHeader(mHandle, mVolHeader, &mVolHeaderLength, 0)) {
+            LOG_E("Failed to get VOL header");
+            android::Mutex::Autolock autoLock(mSlotLock);
+            mSignalledError = true;
+            return ENCODE_FAIL;
+        }
+        LOG_I("Output VOL header: %d bytes", mVolHeaderLength);
+        mNumInputFrames++;
+        //return ENCODE_SUCCESS;
+    }
+
+    if (slot == NULL) {
+        // synchronous mode, the frame is encoded by getOutput
+        prepareInput(inBuffer, mInputFrameData);
+        LOG_V("End\n");
+        return ret;
+    }
+
+    // the slot at mFillPos is owned by the caller until it is queued
+    prepareInput(inBuffer, slot->frame);
+    slot->timeStamp = mCurTimestampUs;
+
+    mSlotLock.lock();
+    mFillPos = (mFillPos + 1) % mQueueDepth;
+    mPending++;
+    mSlotFilledCond.signal();
+    mSlotLock.unlock();
 
     LOG_V("End\n");
 
@@ -470,44 +636,65 @@ Encode_Status PVSoftMPEG4Encoder::getOutput(VideoEncOutputBuffer *outBuffer, uin
         return ENCODE_SUCCESS;
     }
 
-    outBuffer->timeStamp = mCurTimestampUs;
-    LOG_I("info.mTimeUs %lld\n", outBuffer->timeStamp);
+    if (!mAsyncEncode) {
+        outBuffer->timeStamp = mCurTimestampUs;
+        LOG_I("info.mTimeUs %lld\n", outBuffer->timeStamp);
 
-    VideoEncFrameIO vin, vout;
-    memset(&vin, 0, sizeof(vin));
-    memset(&vout, 0, sizeof(vout));
-    vin.height = ((mVideoHeight  + 15) >> 4) << 4;
-    vin.pitch = ((mVideoWidth + 15) >> 4) << 4;
-    vin.timestamp = (outBuffer->timeStamp + 500) / 1000;  // in ms
-    vin.yChan = mInputFrameData;
-    vin.uChan = vin.yChan + vin.height * vin.pitch;
-    vin.vChan = vin.uChan + ((vin.height * vin.pitch) >> 2);
+        ret = encodeFrame(mInputFrameData, outBuffer->timeStamp,
+                outPtr, &dataLength, &outBuffer->flag);
+        ++mNumInputFrames;
+        if (ret == ENCODE_BUFFER_TOO_SMALL) {
+            // the frame is dropped, the caller's buffer holds only part of it
+            outBuffer->dataSize = 0;
+            outBuffer->remainingSize = dataLength;
+        } else {
+            outBuffer->dataSize = dataLength;
+        }
 
-    unsigned long modTimeMs = 0;
-    int32_t nLayer = 0;
-    MP4HintTrack hintTrack;
-    if (!PVEncodeVideoFrame(mHandle, &vin, &vout,
-                &modTimeMs, outPtr, &dataLength, &nLayer) ||
-            !PVGetHintTrack(mHandle, &hintTrack)) {
-        LOG_E("Failed to encode frame or get hink track at frame %lld",
-                mNumInputFrames);
-        mSignalledError = true;
-        hintTrack.CodeType = 0;
-        ret = ENCODE_FAIL;
+        LOG_V("End\n");
+        return ret;
     }
-    LOG_I("dataLength %d\n", dataLength);
-    CHECK(NULL == PVGetOverrunBuffer(mHandle));
-    if (hintTrack.CodeType == 0) {  // I-frame serves as sync frame
-        outBuffer->flag |= ENCODE_BUFFERFLAG_SYNCFRAME;
+
+    // same timeout semantics as VideoEncoderBase::getOutput
+    android::Mutex::Autolock autoLock(mSlotLock);
+    while (mReady == 0) {
+        if (mEncodeThreadExit) {
+            return ENCODE_NOT_INIT;
+        }
+        if (timeout == FUNC_BLOCK) {
+            mSlotEncodedCond.wait(mSlotLock);
+        } else if (timeout > 0) {
+            if (NO_ERROR != mSlotEncodedCond.waitRelative(mSlotLock, 1000000LL * timeout)) {
+                LOG_V("Time out wait for encoded frame.\n");
+                return mPending ? ENCODE_DATA_NOT_READY : ENCODE_NO_REQUEST_DATA;
+            }
+        } else {//Nonblock
+            return mPending ? ENCODE_DATA_NOT_READY : ENCODE_NO_REQUEST_DATA;
+        }
     }
 
+    EncodeSlot *slot = &mSlots[mOutputPos];
+    if ((uint32_t)slot->dataLength > outBuffer->bufferSize) {
+        // keep the frame, the caller may retry with a larger buffer
+        LOG_E("Output buffer size %d is less than encoded frame size %d\n",
+                outBuffer->bufferSize, slot->dataLength);
+        return ENCODE_BUFFER_TOO_SMALL;
+    }
+
+    memcpy(outPtr, slot->bitstream, slot->dataLength);
+    outBuffer->dataSize = slot->dataLength;
+    outBuffer->remainingSize = 0;
+    outBuffer->flag = slot->flag;
+    outBuffer->timeStamp = slot->timeStamp;
+    ret = slot->status;
+    LOG_I("info.mTimeUs %lld\n", outBuffer->timeStamp);
     ++mNumInputFrames;
 
-    outBuffer->flag |= ENCODE_BUFFERFLAG_ENDOFFRAME;
-    outBuffer->dataSize = dataLength;
+    mOutputPos = (mOutputPos + 1) % mQueueDepth;
+    mReady--;
+    mSlotFreeCond.signal();
 
     LOG_V("End\n");
 
     return ret;
 }
-
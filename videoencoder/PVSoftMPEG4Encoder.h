@@ -22,12 +22,17 @@
 #include "VideoEncoderDef.h"
 #include "VideoEncoderInterface.h"
 #include "IntelMetadataBuffer.h"
+#include <utils/threads.h>
+#include <pthread.h>
 
 #include <media/stagefright/MediaBuffer.h>
 #include <media/stagefright/foundation/ABase.h>
 #include "SimpleSoftOMXComponent.h"
 #include "mp4enc_api.h"
 
+// most frames staged ahead of the encode thread
+#define MAX_ENCODE_QUEUE_DEPTH 4
+
 class PVSoftMPEG4Encoder : IVideoEncoder {
 
 public:
@@ -48,6 +53,17 @@ public:
     virtual Encode_Status getMaxOutSize(uint32_t *maxSize) {return ENCODE_SUCCESS;}
 
 private:
+    // input frame staged for the encode thread, and its bitstream once encoded
+    struct EncodeSlot {
+        uint8_t *frame;
+        uint8_t *bitstream;
+        int32_t bitstreamSize;
+        int32_t dataLength;
+        int64_t timeStamp;
+        uint32_t flag;
+        Encode_Status status;
+    };
+
     void setDefaultParams(void);
     VideoParamsCommon mComParams;
 
@@ -63,20 +79,41 @@ private:
     int64_t  mNumInputFrames;
     bool     mStarted;
     bool     mSawInputEOS;
-    bool     mSignalledError;
+    bool     mSignalledError;   // guarded by mSlotLock once the encode thread runs
     int64_t mCurTimestampUs;
     int64_t mLastTimestampUs;
 
     tagvideoEncControls   *mHandle;
     tagvideoEncOptions    *mEncParams;
     uint8_t               *mInputFrameData;
-    uint8_t               *mTrimedInputData;
     uint8_t mVolHeader[256];
     int32_t mVolHeaderLength;
 
     Encode_Status initEncParams();
     Encode_Status initEncoder();
     Encode_Status releaseEncoder();
+    void prepareInput(VideoEncRawBuffer *inBuffer, uint8_t *frame);
+    Encode_Status encodeFrame(uint8_t *frame, int64_t timeStamp,
+            uint8_t *outPtr, int32_t *dataLength, uint32_t *flag);
+    Encode_Status startEncodeThread();
+    void stopEncodeThread();
+    void encodeLoop();
+    static void* encodeThreadEntry(void *arg);
+
+    // when mAsyncEncode is set, encode() only stages the frame and PVEncodeVideoFrame
+    // runs on mEncodeThread; getOutput() returns frames in input order
+    bool mAsyncEncode;
+    pthread_t mEncodeThread;
+    bool mEncodeThreadExit;
+    android::Mutex mSlotLock;
+    android::Condition mSlotFreeCond, mSlotFilledCond, mSlotEncodedCond;
+    EncodeSlot mSlots[MAX_ENCODE_QUEUE_DEPTH];
+    uint32_t mQueueDepth;
+    uint32_t mFillPos;      // next slot encode() stages a frame into
+    uint32_t mEncodePos;    // next slot the encode thread works on
+    uint32_t mOutputPos;    // next slot getOutput() returns
+    uint32_t mPending;      // staged, not encoded yet
+    uint32_t mReady;        // encoded, not output yet
 
     DISALLOW_EVIL_CONSTRUCTORS(PVSoftMPEG4Encoder);
 };
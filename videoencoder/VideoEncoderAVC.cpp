@@ -21,6 +21,44 @@
 #include <va/va_tpi.h>
 #include <va/va_enc_h264.h>
 #include <bitstream.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Returns the offset of the first 00 00 01 start code prefix in buf, or size if there is none.
+static uint32_t findStartCode(const uint8_t *buf, uint32_t size) {
+    uint32_t pos = 0;
+
+#ifdef __SSE2__
+    // compare 16 candidate positions at a time, unaligned loads are fine here
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    while (pos + 18 <= size) {
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(buf + pos));
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(buf + pos + 1));
+        __m128i b2 = _mm_loadu_si128((const __m128i *)(buf + pos + 2));
+        __m128i match = _mm_and_si128(
+                _mm_and_si128(_mm_cmpeq_epi8(b0, zero), _mm_cmpeq_epi8(b1, zero)),
+                _mm_cmpeq_epi8(b2, one));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(match);
+        if (mask) {
+            return pos + __builtin_ctz(mask);
+        }
+        pos += 16;
+    }
+#endif
+
+    while (pos + 3 <= size) {
+        if (buf[pos + 2] > 1) {
+            pos += 3;
+        } else if (buf[pos + 2] == 1 && buf[pos + 1] == 0 && buf[pos] == 0) {
+            return pos;
+        } else {
+            pos++;
+        }
+    }
+    return size;
+}
 
 VideoEncoderAVC::VideoEncoderAVC()
     :VideoEncoderBase() {
@@ -58,6 +96,18 @@ VideoEncoderAVC::VideoEncoderAVC()
     packed_pic_buf_id = VA_INVALID_ID;
     packed_sei_header_param_buf_id = VA_INVALID_ID;   /* the SEI buffer */
     packed_sei_buf_id = VA_INVALID_ID;
+
+    mNALUnits = NULL;
+    mNALCapacity = 0;
+    mNALCount = 0;
+    mNALPos = 0;
+}
+
+VideoEncoderAVC::~VideoEncoderAVC() {
+    if (mNALUnits) {
+        delete [] mNALUnits;
+        mNALUnits = NULL;
+    }
 }
 
 Encode_Status VideoEncoderAVC::start() {
@@ -361,10 +411,8 @@ Encode_Status VideoEncoderAVC::getOneNALUnit(
         uint8_t *inBuffer, uint32_t bufSize, uint32_t *nalSize,
         uint32_t *nalType, uint32_t *nalOffset, uint32_t status) {
     uint32_t pos = 0;
+    uint32_t end = 0;
     uint32_t zeroByteCount = 0;
-    uint32_t singleByteTable[3][2] = {{1,0},{2,0},{2,3}};
-    uint32_t dataRemaining = 0;
-    uint8_t *dataPtr;
 
     // Don't need to check parameters here as we just checked by caller
     while ((inBuffer[pos++] == 0x00)) {
@@ -382,7 +430,6 @@ Encode_Status VideoEncoderAVC::getOneNALUnit(
     *nalType = (*(inBuffer + pos)) & 0x1F;
     LOG_V ("NAL type = 0x%x\n", *nalType);
 
-    zeroByteCount = 0;
     *nalOffset = pos;
 
     if (status & VA_CODED_BUF_STATUS_SINGLE_NALU) {
@@ -390,120 +437,119 @@ Encode_Status VideoEncoderAVC::getOneNALUnit(
         return ENCODE_SUCCESS;
     }
 
-    dataPtr  = inBuffer + pos;
-    dataRemaining = bufSize - pos + 1;
-
-    while ((dataRemaining > 0) && (zeroByteCount < 3)) {
-        if (((((intptr_t)dataPtr) & 0xF ) == 0) && (0 == zeroByteCount)
-               && (dataRemaining > 0xF)) {
-
-            __asm__  (
-                //Data input
-                "movl %1, %%ecx\n\t"//data_ptr=>ecx
-                "movl %0, %%eax\n\t"//data_remaing=>eax
-                //Main compare loop
-                //
-                "0:\n\t"   //MATCH_8_ZERO:
-                "pxor %%xmm0,%%xmm0\n\t"//set 0=>xmm0
-                "pcmpeqb (%%ecx),%%xmm0\n\t"//data_ptr=xmm0,(byte==0)?0xFF:0x00
-                "pmovmskb %%xmm0, %%edx\n\t"//edx[0]=xmm0[7],edx[1]=xmm0[15],...,edx[15]=xmm0[127]
-                "test $0xAAAA, %%edx\n\t"//edx& 1010 1010 1010 1010b
-                "jnz 2f\n\t"//Not equal to zero means that at least one byte 0x00
-
-                "1:\n\t"  //PREPARE_NEXT_MATCH:
-                "sub $0x10, %%eax\n\t"//16 + ecx --> ecx
-                "add $0x10, %%ecx\n\t"//eax-16 --> eax
-                "cmp $0x10, %%eax\n\t"
-                "jge 0b\n\t"//search next 16 bytes
-
-                "2:\n\t"   //DATA_RET:
-                "movl %%ecx, %1\n\t"//output ecx->data_ptr
-                "movl %%eax, %0\n\t"//output eax->data_remaining
-                : "+m"(dataRemaining), "+m"(dataPtr)
-                :
-                :"eax", "ecx", "edx", "xmm0"
-                );
-            if (0 >= dataRemaining) {
-                break;
-            }
-
+    end = pos + findStartCode(inBuffer + pos, bufSize - pos);
+    if (end < bufSize) {
+        // zero bytes before the next start code prefix (4-byte start code, trailing zeros)
+        // don't belong to this NAL unit
+        while (end > pos && inBuffer[end - 1] == 0x00) {
+            end--;
         }
-        //check the value of each byte
-        if ((*dataPtr) >= 2) {
-
-            zeroByteCount = 0;
-
-        }
-        else {
-            zeroByteCount = singleByteTable[zeroByteCount][*dataPtr];
-         }
-
-        dataPtr ++;
-        dataRemaining --;
     }
+    *nalSize = end - pos;
 
-    if ((3 == zeroByteCount) && (dataRemaining > 0)) {
-
-        *nalSize =  bufSize - dataRemaining - *nalOffset - 3;
-
-    } else if (0 == dataRemaining) {
-
-        *nalSize = bufSize - *nalOffset;
-    }
     return ENCODE_SUCCESS;
 }
 
-Encode_Status VideoEncoderAVC::getHeader(
-        uint8_t *inBuffer, uint32_t bufSize, uint32_t *headerSize, uint32_t status) {
+Encode_Status VideoEncoderAVC::indexNALUnits(void) {
 
+    Encode_Status ret = ENCODE_SUCCESS;
+    VACodedBufferSegment *segment = mCurSegment;
+    uint32_t pos = mOffsetInSeg;
     uint32_t nalType = 0;
     uint32_t nalSize = 0;
     uint32_t nalOffset = 0;
-    uint32_t size = 0;
-    uint8_t *buf = inBuffer;
-    Encode_Status ret = ENCODE_SUCCESS;
 
-    *headerSize = 0;
-    CHECK_NULL_RETURN_IFFAIL(inBuffer);
+    mNALCount = 0;
+    mNALPos = 0;
+
+    while (segment != NULL) {
+        CHECK_NULL_RETURN_IFFAIL(segment->buf);
+
+        while (pos < segment->size) {
+            ret = getOneNALUnit((uint8_t *)segment->buf + pos, segment->size - pos,
+                    &nalSize, &nalType, &nalOffset, segment->status);
+            CHECK_ENCODE_STATUS_RETURN("getOneNALUnit");
+
+            if (mNALCount == mNALCapacity) {
+                uint32_t capacity = mNALCapacity ? mNALCapacity * 2 : 16;
+                NALUnit *units = new NALUnit[capacity];
+                if (units == NULL) {
+                    LOG_E("Failed to allocate NAL unit table\n");
+                    return ENCODE_NO_MEMORY;
+                }
+                if (mNALUnits) {
+                    memcpy(units, mNALUnits, mNALCount * sizeof(NALUnit));
+                    delete [] mNALUnits;
+                }
+                mNALUnits = units;
+                mNALCapacity = capacity;
+            }
 
-    if (bufSize == 0) {
-        //bufSize shoule not be 0, error happens
-        LOG_E("Buffer size is 0\n");
-        return ENCODE_FAIL;
+            NALUnit *nal = &mNALUnits[mNALCount++];
+            nal->segment = segment;
+            nal->start = pos;
+            nal->offset = pos + nalOffset;
+            nal->size = nalSize;
+            nal->type = nalType;
+
+            pos += nalOffset + nalSize;
+        }
+
+        segment = (VACodedBufferSegment *)segment->next;
+        pos = 0;
     }
 
-    while (1) {
-        nalType = nalSize = nalOffset = 0;
-        ret = getOneNALUnit(buf, bufSize, &nalSize, &nalType, &nalOffset, status);
-        CHECK_ENCODE_STATUS_RETURN("getOneNALUnit");
+    LOG_V("%d NAL units indexed\n", mNALCount);
+    return ENCODE_SUCCESS;
+}
 
-        LOG_V("NAL type = %d, NAL size = %d, offset = %d\n", nalType, nalSize, nalOffset);
-        size = nalSize + nalOffset;
+Encode_Status VideoEncoderAVC::locateNALUnit(void) {
 
-        // Codec_data should be SPS or PPS
-        if (nalType == 7 || nalType == 8) {
-            *headerSize += size;
-            buf += size;
-            bufSize -= size;
-        } else {
-            LOG_V("No header found or no header anymore\n");
-            break;
-        }
+    // The index is rebuilt for a new coded buffer (nothing copied out yet), or when
+    // data has been output without it (e.g. OUTPUT_EVERYTHING for part of the frame)
+    if (mTotalSizeCopied == 0 || mNALPos >= mNALCount ||
+            mNALUnits[mNALPos].segment != mCurSegment ||
+            mNALUnits[mNALPos].start != mOffsetInSeg) {
+        Encode_Status ret = indexNALUnits();
+        CHECK_ENCODE_STATUS_RETURN("indexNALUnits");
     }
 
+    if (mNALPos >= mNALCount) {
+        LOG_E("No NAL unit found\n");
+        return ENCODE_FAIL;
+    }
     return ENCODE_SUCCESS;
 }
 
+// write NAL unit length as 4-byte big endian
+static inline void writeNALLength(uint8_t *p, uint32_t size) {
+    p[0] = (size >> 24) & 0xff;
+    p[1] = (size >> 16) & 0xff;
+    p[2] = (size >> 8) & 0xff;
+    p[3] = size & 0xff;
+}
+
 Encode_Status VideoEncoderAVC::outputCodecData(
         VideoEncOutputBuffer *outBuffer) {
 
     Encode_Status ret = ENCODE_SUCCESS;
     uint32_t headerSize = 0;
+    uint32_t i;
+
+    ret = locateNALUnit();
+    CHECK_ENCODE_STATUS_RETURN("locateNALUnit");
+
+    // Codec_data should be SPS or PPS
+    for (i = mNALPos; i < mNALCount; i++) {
+        NALUnit *nal = &mNALUnits[i];
+        if (nal->segment != mCurSegment || (nal->type != 7 && nal->type != 8)) {
+            break;
+        }
+        headerSize = nal->offset + nal->size - mOffsetInSeg;
+    }
 
-    ret = getHeader((uint8_t *)mCurSegment->buf + mOffsetInSeg,
-            mCurSegment->size - mOffsetInSeg, &headerSize, mCurSegment->status);
-    CHECK_ENCODE_STATUS_RETURN("getHeader");
     if (headerSize == 0) {
+        LOG_V("No header found\n");
         outBuffer->dataSize = 0;
         mCurSegment = NULL;
         return ENCODE_NO_REQUEST_DATA;
@@ -513,6 +559,7 @@ Encode_Status VideoEncoderAVC::outputCodecData(
         memcpy(outBuffer->data, (uint8_t *)mCurSegment->buf + mOffsetInSeg, headerSize);
         mTotalSizeCopied += headerSize;
         mOffsetInSeg += headerSize;
+        mNALPos = i;
         outBuffer->dataSize = headerSize;
         outBuffer->remainingSize = 0;
         outBuffer->flag |= ENCODE_BUFFERFLAG_ENDOFFRAME;
@@ -533,34 +580,32 @@ Encode_Status VideoEncoderAVC::outputCodecData(
 Encode_Status VideoEncoderAVC::outputOneNALU(
         VideoEncOutputBuffer *outBuffer, bool startCode) {
 
-    uint32_t nalType = 0;
-    uint32_t nalSize = 0;
-    uint32_t nalOffset = 0;
     uint32_t sizeToBeCopied = 0;
 
     Encode_Status ret = ENCODE_SUCCESS;
     CHECK_NULL_RETURN_IFFAIL(mCurSegment->buf);
 
-    ret = getOneNALUnit((uint8_t *)mCurSegment->buf + mOffsetInSeg,
-            mCurSegment->size - mOffsetInSeg, &nalSize, &nalType, &nalOffset, mCurSegment->status);
-    CHECK_ENCODE_STATUS_RETURN("getOneNALUnit");
+    ret = locateNALUnit();
+    CHECK_ENCODE_STATUS_RETURN("locateNALUnit");
+
+    NALUnit *nal = &mNALUnits[mNALPos];
 
     // check if we need startcode along with the payload
     if (startCode) {
-        sizeToBeCopied = nalSize + nalOffset;
+        sizeToBeCopied = nal->offset + nal->size - nal->start;
     } else {
-        sizeToBeCopied = nalSize;
+        sizeToBeCopied = nal->size;
     }
 
     if (sizeToBeCopied <= outBuffer->bufferSize) {
         if (startCode) {
-            memcpy(outBuffer->data, (uint8_t *)mCurSegment->buf + mOffsetInSeg, sizeToBeCopied);
+            memcpy(outBuffer->data, (uint8_t *)mCurSegment->buf + nal->start, sizeToBeCopied);
         } else {
-            memcpy(outBuffer->data, (uint8_t *)mCurSegment->buf + mOffsetInSeg + nalOffset,
-                   sizeToBeCopied);
+            memcpy(outBuffer->data, (uint8_t *)mCurSegment->buf + nal->offset, sizeToBeCopied);
         }
         mTotalSizeCopied += sizeToBeCopied;
-        mOffsetInSeg += (nalSize + nalOffset);
+        mOffsetInSeg = nal->offset + nal->size;
+        mNALPos++;
         outBuffer->dataSize = sizeToBeCopied;
         outBuffer->flag |= ENCODE_BUFFERFLAG_PARTIALFRAME;
         outBuffer->remainingSize = 0;
@@ -591,137 +636,125 @@ Encode_Status VideoEncoderAVC::outputOneNALU(
 Encode_Status VideoEncoderAVC::outputLengthPrefixed(VideoEncOutputBuffer *outBuffer) {
 
     Encode_Status ret = ENCODE_SUCCESS;
-    uint32_t nalType = 0;
-    uint32_t nalSize = 0;
-    uint32_t nalOffset = 0;
+    uint32_t sizeToBeCopied = 0;
     uint32_t sizeCopiedHere = 0;
+    uint32_t i, j, k;
 
     CHECK_NULL_RETURN_IFFAIL(mCurSegment->buf);
 
-    while (1) {
-
-        if (mCurSegment->size < mOffsetInSeg || outBuffer->bufferSize < sizeCopiedHere) {
-            LOG_E("mCurSegment->size < mOffsetInSeg  || outBuffer->bufferSize < sizeCopiedHere\n");
-            return ENCODE_FAIL;
-        }
-
-        // we need to handle the whole bitstream NAL by NAL
-        ret = getOneNALUnit(
-                (uint8_t *)mCurSegment->buf + mOffsetInSeg,
-                mCurSegment->size - mOffsetInSeg, &nalSize, &nalType, &nalOffset, mCurSegment->status);
-        CHECK_ENCODE_STATUS_RETURN("getOneNALUnit");
+    ret = locateNALUnit();
+    CHECK_ENCODE_STATUS_RETURN("locateNALUnit");
 
-        if (nalSize + 4 <= outBuffer->bufferSize - sizeCopiedHere) {
-            // write the NAL length to bit stream
-            outBuffer->data[sizeCopiedHere] = (nalSize >> 24) & 0xff;
-            outBuffer->data[sizeCopiedHere + 1] = (nalSize >> 16) & 0xff;
-            outBuffer->data[sizeCopiedHere + 2] = (nalSize >> 8)  & 0xff;
-            outBuffer->data[sizeCopiedHere + 3] = nalSize   & 0xff;
-
-            sizeCopiedHere += 4;
-            mTotalSizeCopied += 4;
+    // every NAL unit is output with a 4-byte length instead of its start code
+    for (i = mNALPos; i < mNALCount; i++) {
+        sizeToBeCopied += mNALUnits[i].size + 4;
+    }
 
-            memcpy(outBuffer->data + sizeCopiedHere,
-                   (uint8_t *)mCurSegment->buf + mOffsetInSeg + nalOffset, nalSize);
+    if (sizeToBeCopied > outBuffer->bufferSize) {
+        outBuffer->dataSize = 0;
+        outBuffer->remainingSize = sizeToBeCopied;
+        outBuffer->flag |= ENCODE_BUFFERFLAG_DATAINVALID;
+        LOG_E("Buffer size too small\n");
+        return ENCODE_BUFFER_TOO_SMALL;
+    }
 
-            sizeCopiedHere += nalSize;
-            mTotalSizeCopied += nalSize;
-            mOffsetInSeg += (nalSize + nalOffset);
+    for (i = mNALPos; i < mNALCount; i = j) {
+        NALUnit *nal = &mNALUnits[i];
+        uint8_t *buf = (uint8_t *)nal->segment->buf;
 
-        } else {
-            outBuffer->dataSize = sizeCopiedHere;
-            // In case the start code is 3-byte length but we use 4-byte for length prefixed
-            // so the remainingSize size may larger than the remaining data size
-            outBuffer->remainingSize = mTotalSize - mTotalSizeCopied + 100;
-            outBuffer->flag |= ENCODE_BUFFERFLAG_PARTIALFRAME;
-            LOG_E("Buffer size too small\n");
-            return ENCODE_BUFFER_TOO_SMALL;
+        if (nal->offset - nal->start != 4) {
+            writeNALLength(outBuffer->data + sizeCopiedHere, nal->size);
+            memcpy(outBuffer->data + sizeCopiedHere + 4, buf + nal->offset, nal->size);
+            sizeCopiedHere += nal->size + 4;
+            j = i + 1;
+            continue;
         }
 
-        // check if all data in current segment has been copied out
-        if (mCurSegment->size == mOffsetInSeg) {
-            if (mCurSegment->next != NULL) {
-                mCurSegment = (VACodedBufferSegment *)mCurSegment->next;
-                mOffsetInSeg = 0;
-            } else {
-                LOG_V("End of stream\n");
-                outBuffer->dataSize = sizeCopiedHere;
-                outBuffer->remainingSize = 0;
-                outBuffer->flag |= ENCODE_BUFFERFLAG_ENDOFFRAME;
-                mCurSegment = NULL;
+        // adjacent NAL units with 4-byte start codes are copied at once,
+        // then their start codes are overwritten with the lengths
+        for (j = i + 1; j < mNALCount; j++) {
+            NALUnit *next = &mNALUnits[j];
+            if (next->segment != nal->segment || next->offset - next->start != 4 ||
+                    next->start != mNALUnits[j - 1].offset + mNALUnits[j - 1].size) {
                 break;
             }
         }
+        uint32_t runSize = mNALUnits[j - 1].offset + mNALUnits[j - 1].size - nal->start;
+        memcpy(outBuffer->data + sizeCopiedHere, buf + nal->start, runSize);
+        for (k = i; k < j; k++) {
+            writeNALLength(outBuffer->data + sizeCopiedHere + mNALUnits[k].start - nal->start,
+                    mNALUnits[k].size);
+        }
+        sizeCopiedHere += runSize;
     }
 
+    LOG_V("End of stream\n");
+    mTotalSizeCopied += sizeCopiedHere;
+    mNALPos = mNALCount;
+    outBuffer->dataSize = sizeCopiedHere;
+    outBuffer->remainingSize = 0;
+    outBuffer->flag |= ENCODE_BUFFERFLAG_ENDOFFRAME;
+    mCurSegment = NULL;
+
     return ENCODE_SUCCESS;
 }
 
 Encode_Status VideoEncoderAVC::outputNaluLengthsPrefixed(VideoEncOutputBuffer *outBuffer) {
 
     Encode_Status ret = ENCODE_SUCCESS;
-    uint32_t nalType = 0;
-    uint32_t nalSize = 0;
-    uint32_t nalOffset = 0;
+    uint32_t sizeToBeCopied = 0;
     uint32_t sizeCopiedHere = 0;
     const uint32_t NALUINFO_OFFSET = 256;
     uint32_t nalNum = 0;
+    uint32_t i;
 
     CHECK_NULL_RETURN_IFFAIL(mCurSegment->buf);
 
-    while (1) {
-
-        if (mCurSegment->size < mOffsetInSeg || outBuffer->bufferSize < sizeCopiedHere) {
-            LOG_E("mCurSegment->size < mOffsetInSeg  || outBuffer->bufferSize < sizeCopiedHere\n");
-            return ENCODE_FAIL;
-        }
+    ret = locateNALUnit();
+    CHECK_ENCODE_STATUS_RETURN("locateNALUnit");
 
-        // we need to handle the whole bitstream NAL by NAL
-        ret = getOneNALUnit(
-                (uint8_t *)mCurSegment->buf + mOffsetInSeg,
-                mCurSegment->size - mOffsetInSeg, &nalSize, &nalType, &nalOffset, mCurSegment->status);
-        CHECK_ENCODE_STATUS_RETURN("getOneNALUnit");
-
-        if (nalSize + 4 <= outBuffer->bufferSize - NALUINFO_OFFSET - sizeCopiedHere) {
+    // 'nall', number of NAL units and the NAL unit lengths must fit before the bitstream
+    nalNum = mNALCount - mNALPos;
+    if ((nalNum + 2) * 4 > NALUINFO_OFFSET) {
+        LOG_E("Too many NAL units (%d) in coded buffer\n", nalNum);
+        return ENCODE_FAIL;
+    }
 
-            memcpy(outBuffer->data + NALUINFO_OFFSET + sizeCopiedHere,
-                   (uint8_t *)mCurSegment->buf + mOffsetInSeg, nalSize + nalOffset);
+    for (i = mNALPos; i < mNALCount; i++) {
+        sizeToBeCopied += mNALUnits[i].offset + mNALUnits[i].size - mNALUnits[i].start;
+    }
 
-            sizeCopiedHere += nalSize + nalOffset;
-            mTotalSizeCopied += nalSize + nalOffset;
-            mOffsetInSeg += (nalSize + nalOffset);
+    if (NALUINFO_OFFSET + sizeToBeCopied > outBuffer->bufferSize) {
+        outBuffer->dataSize = 0;
+        outBuffer->remainingSize = NALUINFO_OFFSET + sizeToBeCopied;
+        outBuffer->flag |= ENCODE_BUFFERFLAG_DATAINVALID;
+        LOG_E("Buffer size too small\n");
+        return ENCODE_BUFFER_TOO_SMALL;
+    }
 
-        } else {
-            outBuffer->dataSize = sizeCopiedHere;
-            // In case the start code is 3-byte length but we use 4-byte for length prefixed
-            // so the remainingSize size may larger than the remaining data size
-            outBuffer->remainingSize = mTotalSize - mTotalSizeCopied + 100;
-            outBuffer->flag |= ENCODE_BUFFERFLAG_PARTIALFRAME;
-            LOG_E("Buffer size too small\n");
-            return ENCODE_BUFFER_TOO_SMALL;
-        }
+    uint32_t *nalLength = (uint32_t *)outBuffer->data + 2;
+    for (i = mNALPos; i < mNALCount; i++) {
+        NALUnit *nal = &mNALUnits[i];
+        *nalLength++ = nal->offset + nal->size - nal->start;
 
-        nalNum ++;
-        uint32_t *nalLength = (uint32_t *) (outBuffer->data + (nalNum+1) * 4);
-
-        *nalLength = nalSize + nalOffset;
-
-        // check if all data in current segment has been copied out
-        if (mCurSegment->size == mOffsetInSeg) {
-            if (mCurSegment->next != NULL) {
-                mCurSegment = (VACodedBufferSegment *)mCurSegment->next;
-                mOffsetInSeg = 0;
-            } else {
-                LOG_V("End of stream\n");
-                outBuffer->dataSize = sizeCopiedHere;
-                outBuffer->remainingSize = 0;
-                outBuffer->flag |= ENCODE_BUFFERFLAG_ENDOFFRAME;
-                mCurSegment = NULL;
-                break;
-            }
+        // NAL units of a segment follow each other, copy each segment at once
+        if (i + 1 == mNALCount || mNALUnits[i + 1].segment != nal->segment) {
+            uint32_t first = (nal->segment == mCurSegment) ? mOffsetInSeg : 0;
+            uint32_t size = nal->offset + nal->size - first;
+            memcpy(outBuffer->data + NALUINFO_OFFSET + sizeCopiedHere,
+                   (uint8_t *)nal->segment->buf + first, size);
+            sizeCopiedHere += size;
         }
     }
 
+    LOG_V("End of stream\n");
+    mTotalSizeCopied += sizeCopiedHere;
+    mNALPos = mNALCount;
+    outBuffer->dataSize = sizeCopiedHere;
+    outBuffer->remainingSize = 0;
+    outBuffer->flag |= ENCODE_BUFFERFLAG_ENDOFFRAME;
+    mCurSegment = NULL;
+
     outBuffer->offset = NALUINFO_OFFSET;
     uint32_t *nalHead = (uint32_t *) outBuffer->data;
     *nalHead = 0x4E414C4C; //'nall'
@@ -825,14 +858,14 @@ Encode_Status VideoEncoderAVC::renderMaxSliceSize() {
     VAEncMiscParameterMaxSliceSize *maxSliceSizeParam;
     VABufferID miscParamBufferID;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterMaxSliceSize),
             1, NULL, &miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaMapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     miscEncParamBuf->type = VAEncMiscParameterTypeMaxSliceSize;
@@ -840,12 +873,12 @@ Encode_Status VideoEncoderAVC::renderMaxSliceSize() {
 
     maxSliceSizeParam->max_slice_size = mVideoParamsAVC.maxSliceSize;
 
-    vaStatus = vaUnmapBuffer(mVADisplay, miscParamBufferID);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
     LOG_I( "max slice size = %d\n", maxSliceSizeParam->max_slice_size);
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     return ENCODE_SUCCESS;
@@ -859,7 +892,7 @@ Encode_Status VideoEncoderAVC::renderCIR(){
     VAEncMiscParameterBuffer *misc_param;
     VAEncMiscParameterCIR *misc_cir_param;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterCIR),
             1,
@@ -867,7 +900,7 @@ Encode_Status VideoEncoderAVC::renderCIR(){
             &miscParamBufferCIRid);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaMapBuffer(mVADisplay, miscParamBufferCIRid,  (void **)&misc_param);
+    vaStatus = mVA->MapBuffer(mVADisplay, miscParamBufferCIRid,  (void **)&misc_param);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     misc_param->type = VAEncMiscParameterTypeCIR;
@@ -875,10 +908,10 @@ Encode_Status VideoEncoderAVC::renderCIR(){
     misc_cir_param->cir_num_mbs = mComParams.cirParams.cir_num_mbs;
     LOG_I( "cir_num_mbs %d \n", misc_cir_param->cir_num_mbs);
 
-    vaUnmapBuffer(mVADisplay, miscParamBufferCIRid);
+    mVA->UnmapBuffer(mVADisplay, miscParamBufferCIRid);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &miscParamBufferCIRid, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &miscParamBufferCIRid, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     return ENCODE_SUCCESS;
@@ -892,14 +925,14 @@ Encode_Status VideoEncoderAVC::renderAIR() {
     VAEncMiscParameterAIR *airParams;
     VABufferID miscParamBufferID;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof(miscEncParamBuf) + sizeof(VAEncMiscParameterAIR),
             1, NULL, &miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaMapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     miscEncParamBuf->type = VAEncMiscParameterTypeAIR;
@@ -909,10 +942,10 @@ Encode_Status VideoEncoderAVC::renderAIR() {
     airParams->air_threshold= mComParams.airParams.airThreshold;
     airParams->air_auto = mComParams.airParams.airAuto;
 
-    vaStatus = vaUnmapBuffer(mVADisplay, miscParamBufferID);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_I( "airThreshold = %d\n", airParams->air_threshold);
@@ -956,22 +989,22 @@ Encode_Status VideoEncoderAVC::renderSequenceParams(EncodeTask *) {
     uint32_t frameRateDenom = mComParams.frameRate.frameRateDenom;
 
     LOG_V( "Begin\n\n");
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof (VAEncMiscParameterBuffer) + sizeof (VAEncMiscParameterRateControl),
             1, NULL,
             &mRcParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
-    vaStatus = vaMapBuffer(mVADisplay, mRcParamBuf, (void **)&miscEncRCParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, mRcParamBuf, (void **)&miscEncRCParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof (VAEncMiscParameterBuffer) + sizeof (VAEncMiscParameterFrameRate),
             1, NULL,
             &mFrameRateParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
-    vaStatus = vaMapBuffer(mVADisplay, mFrameRateParamBuf, (void **)&miscEncFrameRateParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, mFrameRateParamBuf, (void **)&miscEncFrameRateParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     miscEncRCParamBuf->type = VAEncMiscParameterTypeRateControl;
@@ -1070,21 +1103,21 @@ Encode_Status VideoEncoderAVC::renderSequenceParams(EncodeTask *) {
 //    avcSeqParams.num_units_in_tick = 15;			/* Tc = num_units_in_tick / time_sacle */
     // Not sure whether these settings work for all drivers
 
-    vaStatus = vaUnmapBuffer(mVADisplay, mRcParamBuf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, mRcParamBuf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
-    vaStatus = vaUnmapBuffer(mVADisplay, mFrameRateParamBuf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, mFrameRateParamBuf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSequenceParameterBufferType,
             sizeof(avcSeqParams), 1, &avcSeqParams,
             &mSeqParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mFrameRateParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mFrameRateParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mRcParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mRcParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     return ENCODE_SUCCESS;
@@ -1100,32 +1133,32 @@ Encode_Status VideoEncoderAVC::renderPackedSequenceParams(EncodeTask *) {
 
     LOG_V("Begin\n");
 
-    vaStatus = vaMapBuffer(mVADisplay, mSeqParamBuf, (void **)&avcSeqParams);
+    vaStatus = mVA->MapBuffer(mVADisplay, mSeqParamBuf, (void **)&avcSeqParams);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     length_in_bits = build_packed_seq_buffer(&packed_seq_buffer, mComParams.profile, avcSeqParams);
     packed_header_param_buffer.type = VAEncPackedHeaderSequence;
     packed_header_param_buffer.bit_length = length_in_bits;
     packed_header_param_buffer.has_emulation_bytes = 0;
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncPackedHeaderParameterBufferType,
             sizeof(packed_header_param_buffer), 1, &packed_header_param_buffer,
             &packed_seq_header_param_buf_id);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncPackedHeaderDataBufferType,
             (length_in_bits + 7) / 8, 1, packed_seq_buffer,
             &packed_seq_buf_id);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &packed_seq_header_param_buf_id, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &packed_seq_header_param_buf_id, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &packed_seq_buf_id, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &packed_seq_buf_id, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
-    vaStatus = vaUnmapBuffer(mVADisplay, mSeqParamBuf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, mSeqParamBuf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
     free(packed_seq_buffer);
@@ -1194,7 +1227,7 @@ Encode_Status VideoEncoderAVC::renderPictureParams(EncodeTask *task) {
     //LOG_I( "picture_width = %d\n", avcPicParams.picture_width);
     //LOG_I( "picture_height = %d\n\n", avcPicParams.picture_height);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncPictureParameterBufferType,
             sizeof(avcPicParams),
@@ -1202,7 +1235,7 @@ Encode_Status VideoEncoderAVC::renderPictureParams(EncodeTask *task) {
             &mPicParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mPicParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mPicParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "end\n");
@@ -1219,32 +1252,32 @@ Encode_Status VideoEncoderAVC::renderPackedPictureParams(EncodeTask *) {
 
     LOG_V("Begin\n");
 
-    vaStatus = vaMapBuffer(mVADisplay, mPicParamBuf, (void **)&avcPicParams);
+    vaStatus = mVA->MapBuffer(mVADisplay, mPicParamBuf, (void **)&avcPicParams);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     length_in_bits = build_packed_pic_buffer(&packed_pic_buffer, avcPicParams);
     packed_header_param_buffer.type = VAEncPackedHeaderPicture;
     packed_header_param_buffer.bit_length = length_in_bits;
     packed_header_param_buffer.has_emulation_bytes = 0;
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncPackedHeaderParameterBufferType,
             sizeof(packed_header_param_buffer), 1, &packed_header_param_buffer,
             &packed_pic_header_param_buf_id);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncPackedHeaderDataBufferType,
             (length_in_bits + 7) / 8, 1, packed_pic_buffer,
             &packed_pic_buf_id);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &packed_pic_header_param_buf_id, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &packed_pic_header_param_buf_id, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &packed_pic_buf_id, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &packed_pic_buf_id, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
-    vaStatus = vaUnmapBuffer(mVADisplay, mSeqParamBuf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, mSeqParamBuf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
     free(packed_pic_buffer);
@@ -1293,7 +1326,7 @@ Encode_Status VideoEncoderAVC::renderSliceParams(EncodeTask *task) {
     modulus = maxSliceNum % sliceNum;
     sliceHeightInMB = (maxSliceNum - modulus) / sliceNum ;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSliceParameterBufferType,
             sizeof(VAEncSliceParameterBufferH264),
@@ -1303,7 +1336,7 @@ Encode_Status VideoEncoderAVC::renderSliceParams(EncodeTask *task) {
 
     VAEncSliceParameterBufferH264 *sliceParams, *currentSlice;
 
-    vaStatus = vaMapBuffer(mVADisplay, mSliceParamBuf, (void **)&sliceParams);
+    vaStatus = mVA->MapBuffer(mVADisplay, mSliceParamBuf, (void **)&sliceParams);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
     if(!sliceParams)
         return ENCODE_NULL_PTR;
@@ -1367,10 +1400,10 @@ Encode_Status VideoEncoderAVC::renderSliceParams(EncodeTask *task) {
         startRowInMB += actualSliceHeightInMB;
     }
 
-    vaStatus = vaUnmapBuffer(mVADisplay, mSliceParamBuf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, mSliceParamBuf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSliceParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSliceParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
     LOG_V( "end\n");
     return ENCODE_SUCCESS;
@@ -23,7 +23,7 @@ class VideoEncoderAVC : public VideoEncoderBase {
 
 public:
     VideoEncoderAVC();
-    ~VideoEncoderAVC() {};
+    ~VideoEncoderAVC();
 
     virtual Encode_Status start();
 
@@ -41,7 +41,8 @@ private:
     // Local Methods
 
     Encode_Status getOneNALUnit(uint8_t *inBuffer, uint32_t bufSize, uint32_t *nalSize, uint32_t *nalType, uint32_t *nalOffset, uint32_t status);
-    Encode_Status getHeader(uint8_t *inBuffer, uint32_t bufSize, uint32_t *headerSize, uint32_t status);
+    Encode_Status indexNALUnits(void);
+    Encode_Status locateNALUnit(void);
     Encode_Status outputCodecData(VideoEncOutputBuffer *outBuffer);
     Encode_Status outputOneNALU(VideoEncOutputBuffer *outBuffer, bool startCode);
     Encode_Status outputLengthPrefixed(VideoEncOutputBuffer *outBuffer);
@@ -57,6 +58,22 @@ private:
     Encode_Status renderPackedSequenceParams(EncodeTask *task);
     Encode_Status renderPackedPictureParams(EncodeTask *task);
 
+    // NAL unit of the coded buffer being output
+    struct NALUnit {
+        VACodedBufferSegment *segment;
+        uint32_t start;     // offset in segment of the start code (and any zero bytes before it)
+        uint32_t offset;    // offset in segment of the NAL unit
+        uint32_t size;      // NAL unit size without start code
+        uint32_t type;
+    };
+
+    // NAL units from the current output position to the end of the coded buffer,
+    // indexed once per coded buffer instead of searched for on every output call
+    NALUnit *mNALUnits;
+    uint32_t mNALCapacity;
+    uint32_t mNALCount;
+    uint32_t mNALPos;   // next NAL unit to output
+
 public:
 
     VideoParamsAVC mVideoParamsAVC;
@@ -24,9 +24,13 @@
 #define min(X,Y) (((X) < (Y)) ? (X) : (Y))
 #define max(X,Y) (((X) > (Y)) ? (X) : (Y))
 
+// source surface maps kept before the least recently used ones are released
+#define MAX_SRC_SURFACE_MAP 64
+
 VideoEncoderBase::VideoEncoderBase()
     :mInitialized(true)
     ,mStarted(false)
+    ,mVA(getVABackend())
     ,mVADisplay(NULL)
     ,mVAContext(VA_INVALID_ID)
     ,mVAConfig(VA_INVALID_ID)
@@ -52,6 +56,8 @@ VideoEncoderBase::VideoEncoderBase()
     ,mAutoReference(false)
     ,mAutoReferenceSurfaceNum(4)
     ,mEncPackedHeaders(VA_ATTRIB_NOT_SUPPORTED)
+    ,mTaskPool(NULL)
+    ,mSpareTask(NULL)
     ,mSliceSizeOverflow(false)
     ,mCurOutputTask(NULL)
     ,mOutCodedBuffer(0)
@@ -78,12 +84,12 @@ VideoEncoderBase::VideoEncoderBase()
     setDefaultParams();
 
     LOG_V("vaGetDisplay \n");
-    mVADisplay = vaGetDisplay(&display);
+    mVADisplay = mVA->GetDisplay(&display);
     if (mVADisplay == NULL) {
         LOG_E("vaGetDisplay failed.");
     }
 
-    vaStatus = vaInitialize(mVADisplay, &majorVersion, &minorVersion);
+    vaStatus = mVA->Initialize(mVADisplay, &majorVersion, &minorVersion);
     LOG_V("vaInitialize \n");
     if (vaStatus != VA_STATUS_SUCCESS) {
         LOG_E( "Failed vaInitialize, vaStatus = %d\n", vaStatus);
@@ -97,7 +103,7 @@ VideoEncoderBase::~VideoEncoderBase() {
 
     stop();
 
-    vaStatus = vaTerminate(mVADisplay);
+    vaStatus = mVA->Terminate(mVADisplay);
     LOG_V( "vaTerminate\n");
     if (vaStatus != VA_STATUS_SUCCESS) {
         LOG_W( "Failed vaTerminate, vaStatus = %d\n", vaStatus);
@@ -148,7 +154,7 @@ Encode_Status VideoEncoderBase::start() {
     vaAttrib_tmp[4].type = VAConfigAttribEncMaxRefFrames;
     vaAttrib_tmp[5].type = VAConfigAttribEncRateControlExt;
 
-    vaStatus = vaGetConfigAttributes(mVADisplay, mComParams.profile,
+    vaStatus = mVA->GetConfigAttributes(mVADisplay, mComParams.profile,
             VAEntrypointEncSlice, &vaAttrib_tmp[0], 6);
     CHECK_VA_STATUS_RETURN("vaGetConfigAttributes");
 
@@ -204,7 +210,7 @@ Encode_Status VideoEncoderBase::start() {
 
     LOG_V( "vaCreateConfig\n");
 
-    vaStatus = vaCreateConfig(
+    vaStatus = mVA->CreateConfig(
             mVADisplay, mComParams.profile, mVAEntrypoint,
             &vaAttrib[0], vaAttribNumber, &(mVAConfig));
 //            &vaAttrib[0], 3, &(mVAConfig));  //uncomment this after psb_video supports
@@ -279,7 +285,7 @@ Encode_Status VideoEncoderBase::start() {
 
     //Initialize and save the VA context ID
     LOG_V( "vaCreateContext\n");
-    vaStatus = vaCreateContext(mVADisplay, mVAConfig,
+    vaStatus = mVA->CreateContext(mVADisplay, mVAConfig,
 #ifdef IMG_GFX
             mComParams.resolution.width,
             mComParams.resolution.height,
@@ -300,18 +306,28 @@ Encode_Status VideoEncoderBase::start() {
     ret = getMaxOutSize(&maxSize);
     CHECK_ENCODE_STATUS_RETURN("getMaxOutSize");
 
-    // Create CodedBuffer for output
-    VABufferID VACodedBuffer;
+    // Create CodedBuffer for output, each owned by one pre-allocated task
+    // a pool left by a failed start is dropped, init() drops the old rings
+    delete [] mTaskPool;
+    mTaskPool = new EncodeTask[mComParams.codedBufNum];
+    CHECK_NULL_RETURN_IFFAIL(mTaskPool);
+    ret = mFreeTasks.init(mComParams.codedBufNum);
+    CHECK_ENCODE_STATUS_RETURN("mFreeTasks.init");
+    ret = mReadyTasks.init(mComParams.codedBufNum);
+    CHECK_ENCODE_STATUS_RETURN("mReadyTasks.init");
+    mCodedBufferWait.reset();
+    mEncodeTaskWait.reset();
+    mHwWait.reset();
 
     for(uint32_t i = 0; i <mComParams.codedBufNum; i++) {
-            vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+            vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
                     VAEncCodedBufferType,
                     mCodedBufSize,
                     1, NULL,
-                    &VACodedBuffer);
+                    &mTaskPool[i].coded_buffer);
             CHECK_VA_STATUS_RETURN("vaCreateBuffer::VAEncCodedBufferType");
 
-            mVACodedBufferList.push_back(VACodedBuffer);
+            mFreeTasks.push(&mTaskPool[i]);
     }
 
     if (ret == ENCODE_SUCCESS)
@@ -340,38 +356,27 @@ Encode_Status VideoEncoderBase::encode(VideoEncRawBuffer *inBuffer, uint32_t tim
     ret = manageSrcSurface(inBuffer, &sid);
     CHECK_ENCODE_STATUS_RETURN("manageSrcSurface");
 
-    //Prepare CodedBuffer
-    mCodedBuffer_Lock.lock();
-    if(mVACodedBufferList.empty()){
-        if(timeout == FUNC_BLOCK)
-            mCodedBuffer_Cond.wait(mCodedBuffer_Lock);
-        else if (timeout > 0) {
-            if(NO_ERROR != mEncodeTask_Cond.waitRelative(mCodedBuffer_Lock, 1000000*timeout)){
-                mCodedBuffer_Lock.unlock();
-                LOG_E("Time out wait for Coded buffer.\n");
+    //Prepare CodedBuffer, a task not submitted by the last call still holds one
+    EncodeTask* task = mSpareTask;
+    mSpareTask = NULL;
+    if (task == NULL) {
+        if (mFreeTasks.empty()) {
+            nsecs_t start = systemTime();
+            if (!mFreeTasks.wait(timeout)) {
+                LOG_E("Coded buffer is not ready now.\n");
                 return ENCODE_DEVICE_BUSY;
             }
+            mCodedBufferWait.add(systemTime() - start);
+        } else {
+            mCodedBufferWait.add(0);
         }
-        else {//Nonblock
-            mCodedBuffer_Lock.unlock();
-            LOG_E("Coded buffer is not ready now.\n");
-            return ENCODE_DEVICE_BUSY;
-        }
+        task = mFreeTasks.pop();
     }
-
-    if(mVACodedBufferList.empty()){
-        mCodedBuffer_Lock.unlock();
-        return ENCODE_DEVICE_BUSY;
-    }
-    VABufferID coded_buf = (VABufferID) *(mVACodedBufferList.begin());
-    mVACodedBufferList.erase(mVACodedBufferList.begin());
-    mCodedBuffer_Lock.unlock();
+    VABufferID coded_buf = task->coded_buffer;
 
     LOG_V("CodedBuffer ID 0x%08x\n", coded_buf);
 
     //All resources are ready, start to assemble EncodeTask
-    EncodeTask* task = new EncodeTask();
-
     task->completed = false;
     task->enc_surface = sid;
     task->coded_buffer = coded_buf;
@@ -416,20 +421,17 @@ Encode_Status VideoEncoderBase::encode(VideoEncRawBuffer *inBuffer, uint32_t tim
     //======Start Encoding, add task to list======
     LOG_V("Start Encoding vaSurface=0x%08x\n", task->enc_surface);
 
-    vaStatus = vaBeginPicture(mVADisplay, mVAContext, task->enc_surface);
+    vaStatus = mVA->BeginPicture(mVADisplay, mVAContext, task->enc_surface);
     CHECK_VA_STATUS_GOTO_CLEANUP("vaBeginPicture");
 
     ret = sendEncodeCommand(task);
     CHECK_ENCODE_STATUS_CLEANUP("sendEncodeCommand");
 
-    vaStatus = vaEndPicture(mVADisplay, mVAContext);
+    vaStatus = mVA->EndPicture(mVADisplay, mVAContext);
     CHECK_VA_STATUS_GOTO_CLEANUP("vaEndPicture");
 
     LOG_V("Add Task %p into Encode Task list\n", task);
-    mEncodeTask_Lock.lock();
-    mEncodeTaskList.push_back(task);
-    mEncodeTask_Cond.signal();
-    mEncodeTask_Lock.unlock();
+    mReadyTasks.push(task);
 
     mFrameNum ++;
 
@@ -439,11 +441,9 @@ Encode_Status VideoEncoderBase::encode(VideoEncRawBuffer *inBuffer, uint32_t tim
 
 CLEAN_UP:
 
-    delete task;
-    mCodedBuffer_Lock.lock();
-    mVACodedBufferList.push_back(coded_buf); //push to CodedBuffer pool again since it is not used
-    mCodedBuffer_Cond.signal();
-    mCodedBuffer_Lock.unlock();
+    //keep the task and its CodedBuffer for the next call since it is not used,
+    //only getOutput() returns tasks to mFreeTasks
+    mSpareTask = task;
 
     LOG_V("encode return error=%x\n", ret);
 
@@ -467,32 +467,26 @@ Encode_Status VideoEncoderBase::getOutput(VideoEncOutputBuffer *outBuffer, uint3
     CHECK_NULL_RETURN_IFFAIL(outBuffer);
 
     if (mCurOutputTask == NULL) {
-        mEncodeTask_Lock.lock();
-        if(mEncodeTaskList.empty()) {
+        if (mReadyTasks.empty()) {
             LOG_V("getOutput CurrentTask is NULL\n");
-            if(timeout == FUNC_BLOCK) {
-                LOG_V("waiting for task....\n");
-                mEncodeTask_Cond.wait(mEncodeTask_Lock);
-            } else if (timeout > 0) {
-                LOG_V("waiting for task in %i ms....\n", timeout);
-                if(NO_ERROR != mEncodeTask_Cond.waitRelative(mEncodeTask_Lock, 1000000*timeout)) {
-                    mEncodeTask_Lock.unlock();
-                    LOG_E("Time out wait for encode task.\n");
-                    return ENCODE_NO_REQUEST_DATA;
-                }
-            } else {//Nonblock
-                mEncodeTask_Lock.unlock();
+            if (timeout == FUNC_NONBLOCK) {
+                return ENCODE_NO_REQUEST_DATA;
+            }
+            LOG_V("waiting for task in %i ms....\n", timeout);
+            nsecs_t start = systemTime();
+            if (!mReadyTasks.wait(timeout)) {
+                LOG_E("Time out wait for encode task.\n");
                 return ENCODE_NO_REQUEST_DATA;
             }
+            mEncodeTaskWait.add(systemTime() - start);
+        } else {
+            mEncodeTaskWait.add(0);
         }
 
-        if(mEncodeTaskList.empty()){
-            mEncodeTask_Lock.unlock();
+        mCurOutputTask = mReadyTasks.pop();
+        if (mCurOutputTask == NULL) {
             return ENCODE_DATA_NOT_READY;
         }
-        mCurOutputTask =  *(mEncodeTaskList.begin());
-        mEncodeTaskList.erase(mEncodeTaskList.begin());
-        mEncodeTask_Lock.unlock();
     }
 
     //sync/query/wait task if not completed
@@ -512,12 +506,14 @@ Encode_Status VideoEncoderBase::getOutput(VideoEncOutputBuffer *outBuffer, uint3
             // so use vaMapbuffer instead
             LOG_V ("block mode, vaMapBuffer ID = 0x%08x\n", mOutCodedBuffer);
             if (mOutCodedBufferPtr == NULL) {
-                vaStatus = vaMapBuffer (mVADisplay, mOutCodedBuffer, (void **)&mOutCodedBufferPtr);
+                nsecs_t start = systemTime();
+                vaStatus = mVA->MapBuffer(mVADisplay, mOutCodedBuffer, (void **)&mOutCodedBufferPtr);
                 CHECK_VA_STATUS_GOTO_CLEANUP("vaMapBuffer");
                 CHECK_NULL_RETURN_IFFAIL(mOutCodedBufferPtr);
+                mHwWait.add(systemTime() - start);
             }
 
-            vaStatus = vaQuerySurfaceStatus(mVADisplay, mCurOutputTask->enc_surface,  &vaSurfaceStatus);
+            vaStatus = mVA->QuerySurfaceStatus(mVADisplay, mCurOutputTask->enc_surface,  &vaSurfaceStatus);
             CHECK_VA_STATUS_RETURN("vaQuerySurfaceStatus");
             mFrameSkipped = vaSurfaceStatus & VASurfaceSkipped;
 
@@ -527,7 +523,7 @@ Encode_Status VideoEncoderBase::getOutput(VideoEncOutputBuffer *outBuffer, uint3
             //For both block with timeout and non-block mode, query surface, if ready, output data
             LOG_V ("non-block mode, vaQuerySurfaceStatus ID = 0x%08x\n", mCurOutputTask->enc_surface);
 
-            vaStatus = vaQuerySurfaceStatus(mVADisplay, mCurOutputTask->enc_surface,  &vaSurfaceStatus);
+            vaStatus = mVA->QuerySurfaceStatus(mVADisplay, mCurOutputTask->enc_surface,  &vaSurfaceStatus);
             if (vaSurfaceStatus & VASurfaceReady) {
                 mOutCodedBuffer = mCurOutputTask->coded_buffer;
                 mFrameSkipped = vaSurfaceStatus & VASurfaceSkipped;
@@ -579,17 +575,15 @@ CLEAN_UP:
     }
 
     if (mOutCodedBufferPtr != NULL) {
-        vaStatus = vaUnmapBuffer(mVADisplay, mOutCodedBuffer);
+        vaStatus = mVA->UnmapBuffer(mVADisplay, mOutCodedBuffer);
         mOutCodedBufferPtr = NULL;
         mCurSegment = NULL;
     }
 
-    delete mCurOutputTask;
-    mCurOutputTask = NULL;
-    mCodedBuffer_Lock.lock();
-    mVACodedBufferList.push_back(mOutCodedBuffer);
-    mCodedBuffer_Cond.signal();
-    mCodedBuffer_Lock.unlock();
+    if (mCurOutputTask) {
+        mFreeTasks.push(mCurOutputTask);
+        mCurOutputTask = NULL;
+    }
 
     LOG_V("getOutput return error=%x\n", ret);
     return ret;
@@ -612,6 +606,14 @@ Encode_Status VideoEncoderBase::stop() {
 
     LOG_V( "Begin\n");
 
+    //Release waiting callers and drop all uncompleted tasks, also after
+    //a start() that failed once they were allocated
+    mFreeTasks.deinit();
+    mReadyTasks.deinit();
+    delete [] mTaskPool;
+    mTaskPool = NULL;
+    mSpareTask = NULL;
+
     // It is possible that above pointers have been allocated
     // before we set mStarted to true
     if (!mStarted) {
@@ -623,38 +625,24 @@ Encode_Status VideoEncoderBase::stop() {
         mAutoRefSurfaces = NULL;
     }
 
-    mCodedBuffer_Lock.lock();
-    mVACodedBufferList.clear();
-    mCodedBuffer_Lock.unlock();
-    mCodedBuffer_Cond.broadcast();
-
-    //Delete all uncompleted tasks
-    mEncodeTask_Lock.lock();
-    while(! mEncodeTaskList.empty())
-    {
-        delete *mEncodeTaskList.begin();
-        mEncodeTaskList.erase(mEncodeTaskList.begin());
-    }
-    mEncodeTask_Lock.unlock();
-    mEncodeTask_Cond.broadcast();
+    mCodedBufferWait.dump("coded buffer wait");
+    mEncodeTaskWait.dump("encode task wait");
+    mHwWait.dump("HW wait");
 
     //Release Src Surface Buffer Map, destroy surface manually since it is not added into context
-    LOG_V( "Rlease Src Surface Map\n");
-    while(! mSrcSurfaceMapList.empty())
-    {
-        delete (*mSrcSurfaceMapList.begin());
-        mSrcSurfaceMapList.erase(mSrcSurfaceMapList.begin());
-    }
+    LOG_V( "Rlease Src Surface Map, cache hits %d, misses %d\n",
+            mSrcSurfaceMapCache.getHits(), mSrcSurfaceMapCache.getMisses());
+    clearSurfaceMaps();
 
     LOG_V( "vaDestroyContext\n");
     if (mVAContext != VA_INVALID_ID) {
-        vaStatus = vaDestroyContext(mVADisplay, mVAContext);
+        vaStatus = mVA->DestroyContext(mVADisplay, mVAContext);
         CHECK_VA_STATUS_GOTO_CLEANUP("vaDestroyContext");
     }
 
     LOG_V( "vaDestroyConfig\n");
     if (mVAConfig != VA_INVALID_ID) {
-        vaStatus = vaDestroyConfig(mVADisplay, mVAConfig);
+        vaStatus = mVA->DestroyConfig(mVADisplay, mVAConfig);
         CHECK_VA_STATUS_GOTO_CLEANUP("vaDestroyConfig");
     }
 
@@ -687,7 +675,7 @@ Encode_Status VideoEncoderBase::prepareForOutput(
     // mCurSegment is NULL means it is first time to be here after finishing encoding a frame
     if (mCurSegment == NULL) {
         if (mOutCodedBufferPtr == NULL) {
-            vaStatus = vaMapBuffer (mVADisplay, mOutCodedBuffer, (void **)&mOutCodedBufferPtr);
+            vaStatus = mVA->MapBuffer(mVADisplay, mOutCodedBuffer, (void **)&mOutCodedBufferPtr);
             CHECK_VA_STATUS_RETURN("vaMapBuffer");
             CHECK_NULL_RETURN_IFFAIL(mOutCodedBufferPtr);
         }
@@ -781,19 +769,15 @@ Encode_Status VideoEncoderBase::cleanupForOutput() {
 
     //mCurSegment is NULL means all data has been copied out
     if (mCurSegment == NULL && mOutCodedBufferPtr) {
-        vaStatus = vaUnmapBuffer(mVADisplay, mOutCodedBuffer);
+        vaStatus = mVA->UnmapBuffer(mVADisplay, mOutCodedBuffer);
         CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
         mOutCodedBufferPtr = NULL;
         mTotalSize = 0;
         mOffsetInSeg = 0;
         mTotalSizeCopied = 0;
 
-        delete mCurOutputTask;
+        mFreeTasks.push(mCurOutputTask);
         mCurOutputTask = NULL;
-        mCodedBuffer_Lock.lock();
-        mVACodedBufferList.push_back(mOutCodedBuffer);
-        mCodedBuffer_Cond.signal();
-        mCodedBuffer_Lock.unlock();
 
         LOG_V("All data has been outputted, return CodedBuffer 0x%08x to pool\n", mOutCodedBuffer);
     }
@@ -809,7 +793,7 @@ Encode_Status VideoEncoderBase::queryProfileLevelConfig(VADisplay dpy, VAProfile
     if(profile ==  VAProfileH264Main) //need to be fixed
         return ENCODE_NOT_SUPPORTED;
 
-    vaStatus = vaQueryConfigEntrypoints(dpy, profile, entryPtr, &entryPtrNum);
+    vaStatus = mVA->QueryConfigEntrypoints(dpy, profile, entryPtr, &entryPtrNum);
     CHECK_VA_STATUS_RETURN("vaQueryConfigEntrypoints");
 
     for(i=0; i<entryPtrNum; i++){
@@ -827,7 +811,7 @@ Encode_Status VideoEncoderBase::queryAutoReferenceConfig(VAProfile profile) {
     attrib_list.type = VAConfigAttribEncAutoReference;
     attrib_list.value = VA_ATTRIB_NOT_SUPPORTED;
 
-    vaStatus = vaGetConfigAttributes(mVADisplay, profile, VAEntrypointEncSlice, &attrib_list, 1);
+    vaStatus = mVA->GetConfigAttributes(mVADisplay, profile, VAEntrypointEncSlice, &attrib_list, 1);
     CHECK_VA_STATUS_RETURN("vaQueryConfigAttributes");
 
     if(attrib_list.value == VA_ATTRIB_NOT_SUPPORTED )
@@ -847,7 +831,7 @@ Encode_Status VideoEncoderBase::querySupportedSurfaceMemTypes() {
     VASurfaceAttrib* attribs = NULL;
 
     //get attribs number
-    vaStatus = vaQuerySurfaceAttributes(mVADisplay, mVAConfig, attribs, &num);
+    vaStatus = mVA->QuerySurfaceAttributes(mVADisplay, mVAConfig, attribs, &num);
     CHECK_VA_STATUS_RETURN("vaGetSurfaceAttributes");
 
     if (num == 0)
@@ -855,7 +839,7 @@ Encode_Status VideoEncoderBase::querySupportedSurfaceMemTypes() {
 
     attribs = new VASurfaceAttrib[num];
 
-    vaStatus = vaQuerySurfaceAttributes(mVADisplay, mVAConfig, attribs, &num);
+    vaStatus = mVA->QuerySurfaceAttributes(mVADisplay, mVAConfig, attribs, &num);
     CHECK_VA_STATUS_RETURN("vaGetSurfaceAttributes");
 
     for(uint32_t i = 0; i < num; i ++) {
@@ -1522,10 +1506,10 @@ Encode_Status VideoEncoderBase::getNewUsrptrFromSurface(
     if (surface == VA_INVALID_SURFACE)
         return ENCODE_DRIVER_FAIL;
 
-    vaStatus = vaDeriveImage(mVADisplay, surface, &image);
+    vaStatus = mVA->DeriveImage(mVADisplay, surface, &image);
     CHECK_VA_STATUS_RETURN("vaDeriveImage");
     LOG_V( "vaDeriveImage Done\n");
-    vaStatus = vaMapBuffer(mVADisplay, image.buf, (void **) usrptr);
+    vaStatus = mVA->MapBuffer(mVADisplay, image.buf, (void **) usrptr);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     // make sure the physical page been allocated
@@ -1549,15 +1533,15 @@ Encode_Status VideoEncoderBase::getNewUsrptrFromSurface(
     LOG_V("data_size = %d\n", image.data_size);
     LOG_V("usrptr = 0x%p\n", *usrptr);
 
-    vaStatus = vaUnmapBuffer(mVADisplay, image.buf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, image.buf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
-    vaStatus = vaDestroyImage(mVADisplay, image.image_id);
+    vaStatus = mVA->DestroyImage(mVADisplay, image.image_id);
     CHECK_VA_STATUS_RETURN("vaDestroyImage");
 
     if (*outsize < expectedSize) {
         LOG_E ("Allocated buffer size is small than the expected size, destroy the surface");
         LOG_I ("Allocated size is %d, expected size is %d\n", *outsize, expectedSize);
-        vaStatus = vaDestroySurfaces(mVADisplay, &surface, 1);
+        vaStatus = mVA->DestroySurfaces(mVADisplay, &surface, 1);
         CHECK_VA_STATUS_RETURN("vaDestroySurfaces");
         return ENCODE_FAIL;
     }
@@ -1585,7 +1569,7 @@ Encode_Status VideoEncoderBase::getNewUsrptrFromSurface(
     map->setValueInfo(vinfo);
     map->doMapping();
 
-    mSrcSurfaceMapList.push_back(map);
+    addSurfaceMap(map);
 
     ret = ENCODE_SUCCESS;
 
@@ -1628,7 +1612,7 @@ Encode_Status VideoEncoderBase::setUpstreamBuffer(VideoParamsUpstreamBuffer *upS
         status = map->doMapping();
 
         if (status == ENCODE_SUCCESS)
-            mSrcSurfaceMapList.push_back(map);
+            addSurfaceMap(map);
         else
            delete map;
     }
@@ -1679,22 +1663,19 @@ Encode_Status VideoEncoderBase::manageSrcSurface(VideoEncRawBuffer *inBuffer, VA
         IntelMetadataBuffer::ClearContext(sflag, false);
         //flush surfacemap cache
         LOG_V( "Flush Src Surface Map\n");
-        while(! mSrcSurfaceMapList.empty())
-        {
-            delete (*mSrcSurfaceMapList.begin());
-            mSrcSurfaceMapList.erase(mSrcSurfaceMapList.begin());
-        }
+        clearSurfaceMaps();
     }
 #endif
 
     //find if mapped
-    map = (VASurfaceMap*) findSurfaceMapByValue(value);
+    map = mSrcSurfaceMapCache.find(value);
 
     if (map) {
         //has mapped, get surfaceID directly and do all necessary actions
         LOG_V("direct find surface %d from value %i\n", map->getVASurface(), value);
         *sid = map->getVASurface();
-        map->doMapping();
+        if (map->needsAction())
+            map->doMapping();
         return ret;
     }
 
@@ -1747,7 +1728,7 @@ Encode_Status VideoEncoderBase::manageSrcSurface(VideoEncRawBuffer *inBuffer, VA
         ret = map->doMapping();
         if (ret == ENCODE_SUCCESS) {
             LOG_V("surface mapping success, map value %i into surface %d\n", value, map->getVASurface());
-            mSrcSurfaceMapList.push_back(map);
+            addSurfaceMap(map);
         } else {
             delete map;
             LOG_E("surface mapping failed, wrong info or meet serious error\n");
@@ -1765,6 +1746,9 @@ Encode_Status VideoEncoderBase::manageSrcSurface(VideoEncRawBuffer *inBuffer, VA
     if (extravalues) {
         //map more using same ValueInfo
         for(unsigned int i=0; i<extravalues_count; i++) {
+            if (findSurfaceMapByValue(extravalues[i]) != NULL)  //already mapped
+                continue;
+
             map = new VASurfaceMap(mVADisplay, mSupportedSurfaceMemType);
             map->setValue(extravalues[i]);
             map->setValueInfo(vinfo);
@@ -1772,7 +1756,7 @@ Encode_Status VideoEncoderBase::manageSrcSurface(VideoEncRawBuffer *inBuffer, VA
             ret = map->doMapping();
             if (ret == ENCODE_SUCCESS) {
                 LOG_V("surface mapping extravalue success, map value %i into surface %d\n", extravalues[i], map->getVASurface());
-                mSrcSurfaceMapList.push_back(map);
+                addSurfaceMap(map);
             } else {
                 delete map;
                 map = NULL;
@@ -1794,7 +1778,7 @@ Encode_Status VideoEncoderBase::renderDynamicBitrate(EncodeTask* task) {
     VAEncMiscParameterRateControl *bitrateControlParam;
     VABufferID miscParamBufferID;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof (VAEncMiscParameterBuffer) + sizeof (VAEncMiscParameterRateControl),
             1, NULL,
@@ -1802,7 +1786,7 @@ Encode_Status VideoEncoderBase::renderDynamicBitrate(EncodeTask* task) {
 
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaMapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     miscEncParamBuf->type = VAEncMiscParameterTypeRateControl;
@@ -1836,10 +1820,10 @@ Encode_Status VideoEncoderBase::renderDynamicBitrate(EncodeTask* task) {
     LOG_V("disable_frame_skip = %d\n", bitrateControlParam->rc_flags.bits.disable_frame_skip);
     LOG_V("disable_bit_stuffing = %d\n", bitrateControlParam->rc_flags.bits.disable_bit_stuffing);
 
-    vaStatus = vaUnmapBuffer(mVADisplay, miscParamBufferID);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext,
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext,
             &miscParamBufferID, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
@@ -1861,13 +1845,13 @@ Encode_Status VideoEncoderBase::renderDynamicFrameRate() {
     VAEncMiscParameterFrameRate *frameRateParam;
     VABufferID miscParamBufferID;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof(miscEncParamBuf) + sizeof(VAEncMiscParameterFrameRate),
             1, NULL, &miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaMapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     miscEncParamBuf->type = VAEncMiscParameterTypeFrameRate;
@@ -1876,10 +1860,10 @@ Encode_Status VideoEncoderBase::renderDynamicFrameRate() {
             (unsigned int) (mComParams.frameRate.frameRateNum + mComParams.frameRate.frameRateDenom/2)
             / mComParams.frameRate.frameRateDenom;
 
-    vaStatus = vaUnmapBuffer(mVADisplay, miscParamBufferID);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_I( "frame rate = %d\n", frameRateParam->framerate);
@@ -1894,13 +1878,13 @@ Encode_Status VideoEncoderBase::renderHrd() {
     VAEncMiscParameterHRD *hrdParam;
     VABufferID miscParamBufferID;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
             VAEncMiscParameterBufferType,
             sizeof(miscEncParamBuf) + sizeof(VAEncMiscParameterHRD),
             1, NULL, &miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaMapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
+    vaStatus = mVA->MapBuffer(mVADisplay, miscParamBufferID, (void **)&miscEncParamBuf);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     miscEncParamBuf->type = VAEncMiscParameterTypeHRD;
@@ -1909,25 +1893,63 @@ Encode_Status VideoEncoderBase::renderHrd() {
     hrdParam->buffer_size = mHrdParam.bufferSize;
     hrdParam->initial_buffer_fullness = mHrdParam.initBufferFullness;
 
-    vaStatus = vaUnmapBuffer(mVADisplay, miscParamBufferID);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, miscParamBufferID);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &miscParamBufferID, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     return ENCODE_SUCCESS;
 }
 
 VASurfaceMap *VideoEncoderBase::findSurfaceMapByValue(intptr_t value) {
+    return mSrcSurfaceMapCache.lookup(value);
+}
+
+void VideoEncoderBase::addSurfaceMap(VASurfaceMap *map) {
+
+    if (mSrcSurfaceMapCache.size() >= MAX_SRC_SURFACE_MAP)
+        evictSurfaceMap();
+
+    mSrcSurfaceMapList.push_back(map);
+    if (mSrcSurfaceMapCache.add(map) != ENCODE_SUCCESS)
+        LOG_E("Failed to index surface map of value %i\n", map->getValue());
+}
+
+void VideoEncoderBase::evictSurfaceMap(void) {
+
     android::List<VASurfaceMap *>::iterator node;
+    VASurfaceMap *map;
 
-    for(node = mSrcSurfaceMapList.begin(); node !=  mSrcSurfaceMapList.end(); node++)
-    {
-        if ((*node)->getValue() == value)
-            return *node;
-        else
+    for (map = mSrcSurfaceMapCache.leastRecent(); map != NULL; map = mSrcSurfaceMapCache.moreRecent(map)) {
+        // At most codedBufNum frames are in flight, a surface not used since then is not
+        // referenced by any encode task. Maps are in LRU order, newer ones are all busier.
+        if (mSrcSurfaceMapCache.getIdleCount(map) <= mComParams.codedBufNum)
+            return;
+
+        // surfaces in the VA context or handed out to the client (usrptr) must stay
+        if (map->isTracked() || map->getValueInfo()->mode == MEM_MODE_USRPTR)
             continue;
+
+        LOG_V("Evict surface map of value %i, surface %d\n", map->getValue(), map->getVASurface());
+        mSrcSurfaceMapCache.remove(map);
+        for (node = mSrcSurfaceMapList.begin(); node != mSrcSurfaceMapList.end(); node++) {
+            if (*node == map) {
+                mSrcSurfaceMapList.erase(node);
+                break;
+            }
+        }
+        delete map;
+        return;
     }
+}
+
+void VideoEncoderBase::clearSurfaceMaps(void) {
 
-    return NULL;
+    mSrcSurfaceMapCache.clear();
+    while(! mSrcSurfaceMapList.empty())
+    {
+        delete (*mSrcSurfaceMapList.begin());
+        mSrcSurfaceMapList.erase(mSrcSurfaceMapList.begin());
+    }
 }
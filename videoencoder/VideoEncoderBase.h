@@ -25,6 +25,7 @@
 #include <utils/List.h>
 #include <utils/threads.h>
 #include "VideoEncoderUtils.h"
+#include "VABackend.h"
 
 struct SurfaceMap {
     VASurfaceID surface;
@@ -94,6 +95,9 @@ private:
     Encode_Status getNewUsrptrFromSurface(uint32_t width, uint32_t height, uint32_t format,
             uint32_t expectedSize, uint32_t *outsize, uint32_t *stride, uint8_t **usrptr);
     VASurfaceMap* findSurfaceMapByValue(intptr_t value);
+    void addSurfaceMap(VASurfaceMap *map);
+    void evictSurfaceMap(void);
+    void clearSurfaceMaps(void);
     Encode_Status manageSrcSurface(VideoEncRawBuffer *inBuffer, VASurfaceID *sid);
     void PrepareFrameInfo(EncodeTask* task);
 
@@ -109,6 +113,7 @@ protected:
 
     bool mInitialized;
     bool mStarted;
+    const VABackend *mVA; // libva or null VA
     VADisplay mVADisplay;
     VAContextID mVAContext;
     VAConfigID mVAConfig;
@@ -140,8 +145,11 @@ protected:
     VASurfaceID* mAutoRefSurfaces;
 
     android::List <VASurfaceMap *> mSrcSurfaceMapList;  //all mapped surface info list from input buffer
-    android::List <EncodeTask *> mEncodeTaskList;  //all encode tasks list
-    android::List <VABufferID> mVACodedBufferList;  //all available codedbuffer list
+    VASurfaceMapCache mSrcSurfaceMapCache;  //mSrcSurfaceMapList indexed by value
+    EncodeTask *mTaskPool;          //one task per coded buffer, allocated at start
+    EncodeTaskQueue mFreeTasks;     //tasks with an available coded buffer, getOutput -> encode
+    EncodeTaskQueue mReadyTasks;    //submitted tasks, encode -> getOutput
+    EncodeTask *mSpareTask;         //taken by encode but not submitted, reused by the next encode
 
     VASurfaceID mRefSurface;        //reference surface, only used in base
     VASurfaceID mRecSurface;        //reconstructed surface, only used in base
@@ -165,8 +173,8 @@ protected:
     uint32_t mOffsetInSeg;
     uint32_t mTotalSize;
     uint32_t mTotalSizeCopied;
-    android::Mutex               mCodedBuffer_Lock, mEncodeTask_Lock;
-    android::Condition           mCodedBuffer_Cond, mEncodeTask_Cond;
+    //time spent waiting for a coded buffer, a submitted task and the HW
+    WaitHistogram mCodedBufferWait, mEncodeTaskWait, mHwWait;
 
     bool mFrameSkipped;
 
@@ -71,7 +71,7 @@ Encode_Status VideoEncoderH263::renderSequenceParams(EncodeTask *) {
     LOG_I( "min_qp = %d\n", h263SequenceParam.min_qp);
     LOG_I( "intra_period = %d\n\n", h263SequenceParam.intra_period);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSequenceParameterBufferType,
             sizeof(h263SequenceParam),
@@ -79,7 +79,7 @@ Encode_Status VideoEncoderH263::renderSequenceParams(EncodeTask *) {
             &mSeqParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "end\n");
@@ -116,7 +116,7 @@ Encode_Status VideoEncoderH263::renderPictureParams(EncodeTask *task) {
     LOG_V( "picture_height = %d\n",h263PictureParams.picture_height);
     LOG_V( "picture_type = %d\n\n",h263PictureParams.picture_type);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncPictureParameterBufferType,
             sizeof(h263PictureParams),
@@ -124,7 +124,7 @@ Encode_Status VideoEncoderH263::renderPictureParams(EncodeTask *task) {
             &mPicParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mPicParamBuf , 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mPicParamBuf , 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "end\n");
@@ -144,7 +144,7 @@ Encode_Status VideoEncoderH263::renderSliceParams(EncodeTask *task) {
     sliceHeight &= (~15);
     sliceHeightInMB = sliceHeight / 16;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSliceParameterBufferType,
             sizeof(VAEncSliceParameterBuffer),
@@ -152,7 +152,7 @@ Encode_Status VideoEncoderH263::renderSliceParams(EncodeTask *task) {
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
     VAEncSliceParameterBuffer *sliceParams;
-    vaStatus = vaMapBuffer(mVADisplay, mSliceParamBuf, (void **)&sliceParams);
+    vaStatus = mVA->MapBuffer(mVADisplay, mSliceParamBuf, (void **)&sliceParams);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     // starting MB row number for this slice
@@ -167,10 +167,10 @@ Encode_Status VideoEncoderH263::renderSliceParams(EncodeTask *task) {
     LOG_V("slice_height_in_mb = %d\n", (int) sliceParams->slice_height);
     LOG_V("slice.is_intra = %d\n", (int) sliceParams->slice_flags.bits.is_intra);
 
-    vaStatus = vaUnmapBuffer(mVADisplay, mSliceParamBuf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, mSliceParamBuf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSliceParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSliceParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V("end\n");
@@ -161,7 +161,7 @@ Encode_Status VideoEncoderMP4::renderSequenceParams(EncodeTask *) {
     LOG_I("min_qp = %d\n", mp4SequenceParams.min_qp);
     LOG_I("intra_period = %d\n\n", mp4SequenceParams.intra_period);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSequenceParameterBufferType,
             sizeof(mp4SequenceParams),
@@ -169,7 +169,7 @@ Encode_Status VideoEncoderMP4::renderSequenceParams(EncodeTask *) {
             &mSeqParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "end\n");
@@ -206,7 +206,7 @@ Encode_Status VideoEncoderMP4::renderPictureParams(EncodeTask *task) {
     LOG_V("vop_time_increment = %d\n", mpeg4_pic_param.vop_time_increment);
     LOG_V("picture_type = %d\n\n", mpeg4_pic_param.picture_type);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncPictureParameterBufferType,
             sizeof(mpeg4_pic_param),
@@ -214,7 +214,7 @@ Encode_Status VideoEncoderMP4::renderPictureParams(EncodeTask *task) {
             &mPicParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mPicParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mPicParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     return ENCODE_SUCCESS;
@@ -246,7 +246,7 @@ Encode_Status VideoEncoderMP4::renderSliceParams(EncodeTask *task) {
     LOG_I( "sliceHeightInMB = %d\n", (int) sliceParams.slice_height);
     LOG_I( "is_intra = %d\n", (int) sliceParams.slice_flags.bits.is_intra);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSliceParameterBufferType,
             sizeof(VAEncSliceParameterBuffer),
@@ -254,7 +254,7 @@ Encode_Status VideoEncoderMP4::renderSliceParams(EncodeTask *task) {
             &mSliceParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSliceParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSliceParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "end\n");
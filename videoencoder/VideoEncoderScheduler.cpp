@@ -0,0 +1,322 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <string.h>
+#include "VideoEncoderLog.h"
+#include "VideoEncoderHost.h"
+#include "VideoEncoderScheduler.h"
+
+VideoEncoderScheduler::VideoEncoderScheduler()
+    :mNumWorkers(0)
+    ,mExit(false)
+    ,mNextSession(0)
+    ,mTotalFrames(0)
+    ,mStartTime(0) {
+    memset(mSessions, 0, sizeof(mSessions));
+}
+
+VideoEncoderScheduler::~VideoEncoderScheduler() {
+    for (int32_t i = 0; i < MAX_ENCODER_SESSIONS; i++) {
+        if (mSessions[i].encoder) {
+            closeSession(i);
+        }
+    }
+    stop();
+}
+
+Encode_Status VideoEncoderScheduler::start(uint32_t numWorkers) {
+    if (mNumWorkers) {
+        return ENCODE_ALREADY_INIT;
+    }
+    if (numWorkers == 0 || numWorkers > MAX_ENCODER_WORKERS) {
+        return ENCODE_INVALID_PARAMS;
+    }
+
+    mExit = false;
+    mTotalFrames = 0;
+    mStartTime = systemTime();
+    for (uint32_t i = 0; i < numWorkers; i++) {
+        if (pthread_create(&mWorkers[i], NULL, workerEntry, this) != 0) {
+            LOG_E("Failed to create encode worker %d\n", i);
+            break;
+        }
+        mNumWorkers++;
+    }
+    if (mNumWorkers == 0) {
+        return ENCODE_FAIL;
+    }
+
+    LOG_I("Encoder scheduler started with %d workers\n", mNumWorkers);
+    return ENCODE_SUCCESS;
+}
+
+void VideoEncoderScheduler::stop(void) {
+    if (mNumWorkers == 0) {
+        return;
+    }
+
+    mLock.lock();
+    mExit = true;
+    mWorkCond.broadcast();
+    mDoneCond.broadcast();
+    mLock.unlock();
+
+    // a frame being encoded is finished first
+    for (uint32_t i = 0; i < mNumWorkers; i++) {
+        pthread_join(mWorkers[i], NULL);
+    }
+    mNumWorkers = 0;
+    dumpStatistics();
+}
+
+int32_t VideoEncoderScheduler::openSession(const char *mimeType) {
+    IVideoEncoder *encoder = createVideoEncoder(mimeType);
+    if (encoder == NULL) {
+        return -1;
+    }
+
+    android::Mutex::Autolock autoLock(mLock);
+    for (int32_t i = 0; i < MAX_ENCODER_SESSIONS; i++) {
+        Session &session = mSessions[i];
+        if (session.encoder == NULL) {
+            memset(&session, 0, sizeof(session));
+            session.encoder = encoder;
+            return i;
+        }
+    }
+
+    LOG_E("Too many encoder sessions\n");
+    releaseVideoEncoder(encoder);
+    return -1;
+}
+
+bool VideoEncoderScheduler::isOpen(int32_t session) {
+    return session >= 0 && session < MAX_ENCODER_SESSIONS &&
+        mSessions[session].encoder != NULL;
+}
+
+IVideoEncoder* VideoEncoderScheduler::getEncoder(int32_t session) {
+    android::Mutex::Autolock autoLock(mLock);
+    return isOpen(session) ? mSessions[session].encoder : NULL;
+}
+
+Encode_Status VideoEncoderScheduler::startSession(int32_t session) {
+    Encode_Status ret = ENCODE_SUCCESS;
+
+    IVideoEncoder *encoder = getEncoder(session);
+    CHECK_NULL_RETURN_IFFAIL(encoder);
+
+    // Workers call getOutput right after encode, so a session never needs more
+    // than a couple of coded buffers, and must not start its own encode thread.
+    VideoParamsCommon params;
+    ret = encoder->getParameters(&params);
+    CHECK_ENCODE_STATUS_RETURN("getParameters");
+    if (params.codedBufNum > SESSION_CODED_BUF_NUM) {
+        params.codedBufNum = SESSION_CODED_BUF_NUM;
+    }
+    params.syncEncMode = true;
+    ret = encoder->setParameters(&params);
+    CHECK_ENCODE_STATUS_RETURN("setParameters");
+
+    ret = encoder->start();
+    CHECK_ENCODE_STATUS_RETURN("start");
+
+    android::Mutex::Autolock autoLock(mLock);
+    mSessions[session].started = true;
+    return ENCODE_SUCCESS;
+}
+
+Encode_Status VideoEncoderScheduler::closeSession(int32_t session) {
+    mLock.lock();
+    if (!isOpen(session)) {
+        mLock.unlock();
+        return ENCODE_INVALID_PARAMS;
+    }
+
+    Session &s = mSessions[session];
+    // no worker picks the session once it is not started
+    s.started = false;
+    while (s.busy) {
+        mDoneCond.wait(mLock);
+    }
+    IVideoEncoder *encoder = s.encoder;
+    LOG_I("Session %d: %d frames\n", session, s.frames);
+    memset(&s, 0, sizeof(s));
+    mDoneCond.broadcast();
+    mLock.unlock();
+
+    encoder->stop();
+    releaseVideoEncoder(encoder);
+    return ENCODE_SUCCESS;
+}
+
+bool VideoEncoderScheduler::waitLocked(android::Condition &cond, uint32_t timeout) {
+    if (timeout == FUNC_BLOCK) {
+        cond.wait(mLock);
+        return true;
+    }
+    if (timeout > 0) {
+        return NO_ERROR == cond.waitRelative(mLock, 1000000LL * timeout);
+    }
+    return false;
+}
+
+Encode_Status VideoEncoderScheduler::submit(int32_t session, VideoEncRawBuffer *inBuffer,
+        VideoEncOutputBuffer *outBuffer, uint32_t timeout) {
+    CHECK_NULL_RETURN_IFFAIL(inBuffer);
+    CHECK_NULL_RETURN_IFFAIL(outBuffer);
+
+    // workers call getOutput once per frame, formats that need more calls would leave
+    // the rest of the frame in the encoder for the next job
+    if (outBuffer->format != OUTPUT_EVERYTHING) {
+        LOG_E("Session %d: only OUTPUT_EVERYTHING is supported\n", session);
+        return ENCODE_NOT_SUPPORTED;
+    }
+
+    android::Mutex::Autolock autoLock(mLock);
+    if (!isOpen(session) || !mSessions[session].started || mExit) {
+        return ENCODE_NOT_INIT;
+    }
+
+    Session &s = mSessions[session];
+    while (s.queued + s.done >= MAX_SESSION_JOBS) {
+        if (!waitLocked(mDoneCond, timeout)) {
+            LOG_V("Session %d has no free job slot\n", session);
+            return ENCODE_DEVICE_BUSY;
+        }
+        if (!s.started || mExit) {
+            return ENCODE_NOT_INIT;
+        }
+    }
+
+    Job &job = s.jobs[(s.head + s.done + s.queued) % MAX_SESSION_JOBS];
+    job.inBuffer = inBuffer;
+    job.outBuffer = outBuffer;
+    job.status = ENCODE_SUCCESS;
+    job.submitTime = systemTime();
+    s.queued++;
+    mWorkCond.signal();
+    return ENCODE_SUCCESS;
+}
+
+Encode_Status VideoEncoderScheduler::getOutput(int32_t session, VideoEncOutputBuffer **outBuffer,
+        uint32_t timeout) {
+    CHECK_NULL_RETURN_IFFAIL(outBuffer);
+
+    android::Mutex::Autolock autoLock(mLock);
+    if (!isOpen(session)) {
+        return ENCODE_NOT_INIT;
+    }
+
+    Session &s = mSessions[session];
+    while (s.done == 0) {
+        if (s.queued == 0 && timeout != FUNC_BLOCK) {
+            return ENCODE_NO_REQUEST_DATA;
+        }
+        if (!waitLocked(mDoneCond, timeout)) {
+            return s.queued ? ENCODE_DATA_NOT_READY : ENCODE_NO_REQUEST_DATA;
+        }
+        if (!s.started || mExit) {
+            return ENCODE_NOT_INIT;
+        }
+    }
+
+    Job &job = s.jobs[s.head];
+    *outBuffer = job.outBuffer;
+    s.head = (s.head + 1) % MAX_SESSION_JOBS;
+    s.done--;
+    // a job slot is free again
+    mDoneCond.broadcast();
+    return job.status;
+}
+
+void* VideoEncoderScheduler::workerEntry(void *arg) {
+    ((VideoEncoderScheduler *)arg)->workerLoop();
+    return NULL;
+}
+
+int32_t VideoEncoderScheduler::pickSession(void) {
+    // called with mLock held
+    for (uint32_t n = 0; n < MAX_ENCODER_SESSIONS; n++) {
+        uint32_t i = (mNextSession + n) % MAX_ENCODER_SESSIONS;
+        Session &s = mSessions[i];
+        if (s.started && !s.busy && s.queued) {
+            mNextSession = i + 1;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void VideoEncoderScheduler::workerLoop(void) {
+    mLock.lock();
+    while (!mExit) {
+        int32_t index = pickSession();
+        if (index < 0) {
+            mWorkCond.wait(mLock);
+            continue;
+        }
+
+        // frames of one session are encoded in order, one at a time
+        Session &s = mSessions[index];
+        Job &job = s.jobs[(s.head + s.done) % MAX_SESSION_JOBS];
+        IVideoEncoder *encoder = s.encoder;
+        s.busy = true;
+        mLock.unlock();
+
+        Encode_Status ret = encoder->encode(job.inBuffer, FUNC_BLOCK);
+        if (ret == ENCODE_SUCCESS) {
+            // OUTPUT_EVERYTHING returns the whole frame, or drops it on any error
+            // (e.g. ENCODE_BUFFER_TOO_SMALL), so nothing is left for the next job
+            ret = encoder->getOutput(job.outBuffer, FUNC_BLOCK);
+        } else {
+            LOG_E("Session %d encode failed, ret = 0x%08x\n", index, ret);
+        }
+
+        mLock.lock();
+        nsecs_t latency = systemTime() - job.submitTime;
+        job.status = ret;
+        s.busy = false;
+        s.queued--;
+        s.done++;
+        s.frames++;
+        s.totalLatency += latency;
+        if (latency > s.maxLatency) {
+            s.maxLatency = latency;
+        }
+        mTotalFrames++;
+        mDoneCond.broadcast();
+    }
+    mLock.unlock();
+}
+
+void VideoEncoderScheduler::dumpStatistics(void) {
+    android::Mutex::Autolock autoLock(mLock);
+
+    nsecs_t elapsed = systemTime() - mStartTime;
+    if (elapsed > 0) {
+        LOG_I("Encoder scheduler: %d frames, %lld.%02lld fps\n", mTotalFrames,
+                (long long)(mTotalFrames * 1000000000LL / elapsed),
+                (long long)(mTotalFrames * 100000000000LL / elapsed % 100));
+    }
+    for (int32_t i = 0; i < MAX_ENCODER_SESSIONS; i++) {
+        Session &s = mSessions[i];
+        if (s.encoder && s.frames) {
+            LOG_I("Session %d: %d frames, latency avg %lld us, max %lld us\n", i, s.frames,
+                    (long long)(s.totalLatency / s.frames / 1000), (long long)(s.maxLatency / 1000));
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*
+* Copyright (c) 2009-2011 Intel Corporation.  All rights reserved.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef VIDEO_ENCODER_SCHEDULER_H_
+#define VIDEO_ENCODER_SCHEDULER_H_
+
+#include <pthread.h>
+#include <utils/threads.h>
+#include <utils/Timers.h>
+#include "VideoEncoderInterface.h"
+
+#define MAX_ENCODER_SESSIONS        64
+#define MAX_ENCODER_WORKERS         8
+// frames queued per session, including the one being encoded
+#define MAX_SESSION_JOBS            4
+// coded buffers per session, a worker gets the output right after encoding
+#define SESSION_CODED_BUF_NUM       2
+
+// Runs many encoder sessions (e.g. low resolution conference streams) on a fixed pool
+// of worker threads instead of one caller thread each. A worker takes one frame of the
+// next session in round-robin order that has work and is not being encoded already,
+// runs encode() and getOutput() on it, and queues the result for the session's caller.
+class VideoEncoderScheduler {
+public:
+    VideoEncoderScheduler();
+    ~VideoEncoderScheduler();
+
+    Encode_Status start(uint32_t numWorkers);
+    void stop(void);
+
+    // returns a session id, or -1. The encoder is configured through getEncoder
+    // and started by startSession.
+    int32_t openSession(const char *mimeType);
+    IVideoEncoder* getEncoder(int32_t session);
+    Encode_Status startSession(int32_t session);
+    // waits for the frame being encoded, queued frames are dropped
+    Encode_Status closeSession(int32_t session);
+
+    // inBuffer and outBuffer must stay valid until the frame is returned by getOutput.
+    // outBuffer->format must be OUTPUT_EVERYTHING, the whole frame goes to one buffer
+    // and a frame that does not fit fails with ENCODE_BUFFER_TOO_SMALL.
+    Encode_Status submit(int32_t session, VideoEncRawBuffer *inBuffer,
+            VideoEncOutputBuffer *outBuffer, uint32_t timeout = FUNC_BLOCK);
+    // next encoded frame of the session, in submission order
+    Encode_Status getOutput(int32_t session, VideoEncOutputBuffer **outBuffer,
+            uint32_t timeout = FUNC_BLOCK);
+
+    // aggregate frame rate and per session latency
+    void dumpStatistics(void);
+
+private:
+    struct Job {
+        VideoEncRawBuffer *inBuffer;
+        VideoEncOutputBuffer *outBuffer;
+        Encode_Status status;
+        nsecs_t submitTime;
+    };
+
+    struct Session {
+        IVideoEncoder *encoder;
+        bool started;
+        bool busy;          // a worker is encoding mJobs[head]
+        Job jobs[MAX_SESSION_JOBS];
+        uint32_t head;      // oldest job
+        uint32_t queued;    // submitted, not encoded
+        uint32_t done;      // encoded, not returned
+        uint32_t frames;
+        nsecs_t totalLatency;
+        nsecs_t maxLatency;
+    };
+
+    static void* workerEntry(void *arg);
+    void workerLoop(void);
+    int32_t pickSession(void);
+    bool waitLocked(android::Condition &cond, uint32_t timeout);
+    bool isOpen(int32_t session);
+
+    pthread_t mWorkers[MAX_ENCODER_WORKERS];
+    uint32_t mNumWorkers;
+    bool mExit;
+    android::Mutex mLock;
+    android::Condition mWorkCond;   // a session got a frame to encode
+    android::Condition mDoneCond;   // a frame was encoded or a job slot freed
+    Session mSessions[MAX_ENCODER_SESSIONS];
+    uint32_t mNextSession;          // where the next round-robin scan starts
+    uint32_t mTotalFrames;
+    nsecs_t mStartTime;
+};
+
+#endif /* VIDEO_ENCODER_SCHEDULER_H_ */
@@ -14,8 +14,11 @@
 * limitations under the License.
 */
 
+#include <string.h>
+#include <stdio.h>
 #include "VideoEncoderLog.h"
 #include "VideoEncoderUtils.h"
+#include "PlaneCopy.h"
 #include <va/va_android.h>
 #include <va/va_drmcommon.h>
 
@@ -250,27 +253,9 @@ void DumpGfx(intptr_t handle, char* filename) {
 
 #endif
 
-extern "C" {
-VAStatus vaLockSurface(VADisplay dpy,
-    VASurfaceID surface,
-    unsigned int *fourcc,
-    unsigned int *luma_stride,
-    unsigned int *chroma_u_stride,
-    unsigned int *chroma_v_stride,
-    unsigned int *luma_offset,
-    unsigned int *chroma_u_offset,
-    unsigned int *chroma_v_offset,
-    unsigned int *buffer_name,
-    void **buffer
-);
-
-VAStatus vaUnlockSurface(VADisplay dpy,
-    VASurfaceID surface
-);
-}
-
 VASurfaceMap::VASurfaceMap(VADisplay display, int hwcap) {
 
+    mVA = getVABackend();
     mVADisplay = display;
     mSupportedSurfaceMemType = hwcap;
     mValue = 0;
@@ -286,7 +271,7 @@ VASurfaceMap::VASurfaceMap(VADisplay display, int hwcap) {
 VASurfaceMap::~VASurfaceMap() {
 
     if (!mTracked && (mVASurface != VA_INVALID_SURFACE))
-        vaDestroySurfaces(mVADisplay, &mVASurface, 1);
+        mVA->DestroySurfaces(mVADisplay, &mVASurface, 1);
 
 #ifdef IMG_GFX
     if (mGfxHandle)
@@ -447,7 +432,7 @@ Encode_Status VASurfaceMap::MappingSurfaceID(intptr_t value) {
     uint32_t chromaVOffset = 0;
     uint32_t kBufHandle = 0;
 
-    vaStatus = vaLockSurface(
+    vaStatus = mVA->LockSurface(
             (VADisplay)mVinfo.handle, (VASurfaceID)value,
             &fourCC, &lumaStride, &chromaUStride, &chromaVStride,
             &lumaOffset, &chromaUOffset, &chromaVOffset, &kBufHandle, NULL);
@@ -458,7 +443,7 @@ Encode_Status VASurfaceMap::MappingSurfaceID(intptr_t value) {
     LOG_V("lumaOffset = %d, chromaUOffset = %d, chromaVOffset = %d\n", lumaOffset, chromaUOffset, chromaVOffset);
     LOG_V("kBufHandle = 0x%08x, fourCC = %d\n", kBufHandle, fourCC);
 
-    vaStatus = vaUnlockSurface((VADisplay)mVinfo.handle, (VASurfaceID)value);
+    vaStatus = mVA->UnlockSurface((VADisplay)mVinfo.handle, (VASurfaceID)value);
     CHECK_VA_STATUS_RETURN("vaUnlockSurface");
 
     mVinfo.mode = MEM_MODE_KBUFHANDLE;
@@ -615,9 +600,9 @@ Encode_Status VASurfaceMap::doActionCopy() {
 
 
     VAImage destImage;
-    vaStatus = vaDeriveImage(mVADisplay, mVASurface, &destImage);
+    vaStatus = mVA->DeriveImage(mVADisplay, mVASurface, &destImage);
     CHECK_VA_STATUS_RETURN("vaDeriveImage");
-    vaStatus = vaMapBuffer(mVADisplay, destImage.buf, (void **)&pDestBuffer);
+    vaStatus = mVA->MapBuffer(mVADisplay, destImage.buf, (void **)&pDestBuffer);
     CHECK_VA_STATUS_RETURN("vaMapBuffer");
 
     LOG_V("\nDest VASurface information\n");
@@ -634,29 +619,14 @@ Encode_Status VASurfaceMap::doActionCopy() {
         return ENCODE_INVALID_PARAMS;
     }
 
-    uint8_t *srcY, *dstY;
-    uint8_t *srcUV, *dstUV;
-
-    srcY = pSrcBuffer + srcY_offset;
-    dstY = pDestBuffer + destImage.offsets[0];
-    srcUV = pSrcBuffer + srcUV_offset;
-    dstUV = pDestBuffer + destImage.offsets[1];
-
-    for (uint32_t i = 0; i < height; i++) {
-        memcpy(dstY, srcY, width);
-        srcY += srcY_pitch;
-        dstY += destImage.pitches[0];
-    }
-
-    for (uint32_t i = 0; i < height / 2; i++) {
-        memcpy(dstUV, srcUV, width);
-        srcUV += srcUV_pitch;
-        dstUV += destImage.pitches[1];
-    }
+    NV12Planes src = {pSrcBuffer + srcY_offset, pSrcBuffer + srcUV_offset, srcY_pitch, srcUV_pitch};
+    NV12Planes dst = {pDestBuffer + destImage.offsets[0], pDestBuffer + destImage.offsets[1],
+                      destImage.pitches[0], destImage.pitches[1]};
+    copyNV12(dst, src, width, height);
 
-    vaStatus = vaUnmapBuffer(mVADisplay, destImage.buf);
+    vaStatus = mVA->UnmapBuffer(mVADisplay, destImage.buf);
     CHECK_VA_STATUS_RETURN("vaUnmapBuffer");
-    vaStatus = vaDestroyImage(mVADisplay, destImage.image_id);
+    vaStatus = mVA->DestroyImage(mVADisplay, destImage.image_id);
     CHECK_VA_STATUS_RETURN("vaDestroyImage");
 
 #ifdef IMG_GFX
@@ -761,7 +731,7 @@ VASurfaceID VASurfaceMap::CreateSurfaceFromExternalBuf(intptr_t value, ValueInfo
     attribs[1].value.type = VAGenericValueTypePointer;
     attribs[1].value.value.p = (void *)&extbuf;
 
-    vaStatus = vaCreateSurfaces(mVADisplay, VA_RT_FORMAT_YUV420, vinfo.width,
+    vaStatus = mVA->CreateSurfaces(mVADisplay, VA_RT_FORMAT_YUV420, vinfo.width,
                                  vinfo.height, &surface, 1, attribs, 2);
     if (vaStatus != VA_STATUS_SUCCESS){
         LOG_E("vaCreateSurfaces failed. vaStatus = %d\n", vaStatus);
@@ -806,10 +776,372 @@ VASurfaceID CreateNewVASurface(VADisplay display, int32_t width, int32_t height)
     attribs[1].value.type = VAGenericValueTypePointer;
     attribs[1].value.value.p = (void *)&extbuf;
 
-    vaStatus = vaCreateSurfaces(display, VA_RT_FORMAT_YUV420, width,
+    vaStatus = getVABackend()->CreateSurfaces(display, VA_RT_FORMAT_YUV420, width,
                                  height, &surface, 1, attribs, 2);
     if (vaStatus != VA_STATUS_SUCCESS)
         LOG_E("vaCreateSurfaces failed. vaStatus = %d\n", vaStatus);
 
     return surface;
 }
+
+VASurfaceMapCache::VASurfaceMapCache()
+    :mEntries(NULL)
+    ,mSlots(NULL)
+    ,mCapacity(0)
+    ,mSlotMask(0)
+    ,mCount(0)
+    ,mFree(INVALID_INDEX)
+    ,mOldest(INVALID_INDEX)
+    ,mNewest(INVALID_INDEX)
+    ,mUses(0)
+    ,mHits(0)
+    ,mMisses(0) {
+}
+
+VASurfaceMapCache::~VASurfaceMapCache() {
+    delete [] mEntries;
+    delete [] mSlots;
+}
+
+uint32_t VASurfaceMapCache::hash(intptr_t value) {
+    // handles and pointers are aligned, mix the bits before masking
+    uint64_t v = (uint64_t)(uintptr_t)value;
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    return (uint32_t)v & mSlotMask;
+}
+
+int32_t VASurfaceMapCache::findSlot(intptr_t value) {
+    if (mCount == 0) {
+        return INVALID_INDEX;
+    }
+    for (uint32_t slot = hash(value); mSlots[slot] != INVALID_INDEX; slot = (slot + 1) & mSlotMask) {
+        if (mEntries[mSlots[slot]].value == value) {
+            return slot;
+        }
+    }
+    return INVALID_INDEX;
+}
+
+void VASurfaceMapCache::unlinkEntry(int32_t index) {
+    Entry &entry = mEntries[index];
+    if (entry.older != INVALID_INDEX) {
+        mEntries[entry.older].newer = entry.newer;
+    } else {
+        mOldest = entry.newer;
+    }
+    if (entry.newer != INVALID_INDEX) {
+        mEntries[entry.newer].older = entry.older;
+    } else {
+        mNewest = entry.older;
+    }
+}
+
+void VASurfaceMapCache::linkNewest(int32_t index) {
+    Entry &entry = mEntries[index];
+    entry.older = mNewest;
+    entry.newer = INVALID_INDEX;
+    if (mNewest != INVALID_INDEX) {
+        mEntries[mNewest].newer = index;
+    } else {
+        mOldest = index;
+    }
+    mNewest = index;
+}
+
+VASurfaceMap* VASurfaceMapCache::find(intptr_t value) {
+    int32_t slot = findSlot(value);
+    mUses++;
+    if (slot == INVALID_INDEX) {
+        mMisses++;
+        return NULL;
+    }
+    mHits++;
+    int32_t index = mSlots[slot];
+    mEntries[index].lastUse = mUses;
+    if (index != mNewest) {
+        unlinkEntry(index);
+        linkNewest(index);
+    }
+    return mEntries[index].map;
+}
+
+VASurfaceMap* VASurfaceMapCache::lookup(intptr_t value) {
+    int32_t slot = findSlot(value);
+    return (slot != INVALID_INDEX) ? mEntries[mSlots[slot]].map : NULL;
+}
+
+Encode_Status VASurfaceMapCache::grow(void) {
+    uint32_t capacity = mCapacity ? mCapacity * 2 : INITIAL_CAPACITY;
+    Entry *entries = new Entry[capacity];
+    int32_t *slots = new int32_t[capacity * 2];
+    if (entries == NULL || slots == NULL) {
+        delete [] entries;
+        delete [] slots;
+        return ENCODE_NO_MEMORY;
+    }
+
+    Entry *oldEntries = mEntries;
+    int32_t oldest = mOldest;
+
+    delete [] mSlots;
+    mEntries = entries;
+    mSlots = slots;
+    mCapacity = capacity;
+    mSlotMask = capacity * 2 - 1;
+    for (uint32_t i = 0; i < capacity * 2; i++) {
+        mSlots[i] = INVALID_INDEX;
+    }
+    mCount = 0;
+    mFree = INVALID_INDEX;
+    mOldest = INVALID_INDEX;
+    mNewest = INVALID_INDEX;
+    for (int32_t i = capacity - 1; i >= 0; i--) {
+        mEntries[i].newer = mFree;
+        mFree = i;
+    }
+
+    // re-add in LRU order
+    uint32_t uses = mUses;
+    for (int32_t i = oldest; i != INVALID_INDEX; i = oldEntries[i].newer) {
+        mUses = oldEntries[i].lastUse;
+        add(oldEntries[i].map);
+    }
+    mUses = uses;
+    delete [] oldEntries;
+    return ENCODE_SUCCESS;
+}
+
+Encode_Status VASurfaceMapCache::add(VASurfaceMap *map) {
+    Encode_Status ret = ENCODE_SUCCESS;
+
+    if (mCount == mCapacity) {
+        ret = grow();
+        CHECK_ENCODE_STATUS_RETURN("grow");
+    }
+
+    intptr_t value = map->getValue();
+    uint32_t slot = hash(value);
+    while (mSlots[slot] != INVALID_INDEX) {
+        if (mEntries[mSlots[slot]].value == value) {
+            LOG_E("Value %p is already in the surface map cache\n", (void *)value);
+            return ENCODE_FAIL;
+        }
+        slot = (slot + 1) & mSlotMask;
+    }
+
+    int32_t index = mFree;
+    mFree = mEntries[index].newer;
+    mEntries[index].map = map;
+    mEntries[index].value = value;
+    mEntries[index].lastUse = mUses;
+    linkNewest(index);
+    mSlots[slot] = index;
+    mCount++;
+    return ENCODE_SUCCESS;
+}
+
+void VASurfaceMapCache::remove(VASurfaceMap *map) {
+    int32_t slot = findSlot(map->getValue());
+    if (slot == INVALID_INDEX || mEntries[mSlots[slot]].map != map) {
+        return;
+    }
+
+    int32_t index = mSlots[slot];
+    unlinkEntry(index);
+    mEntries[index].map = NULL;
+    mEntries[index].newer = mFree;
+    mFree = index;
+    mCount--;
+
+    // backward shift deletion, keeps probe sequences unbroken without tombstones
+    uint32_t hole = slot;
+    uint32_t next = slot;
+    while (true) {
+        next = (next + 1) & mSlotMask;
+        if (mSlots[next] == INVALID_INDEX) {
+            break;
+        }
+        uint32_t home = hash(mEntries[mSlots[next]].value);
+        // move the entry into the hole unless its home slot lies cyclically in (hole, next]
+        if (((next - home) & mSlotMask) >= ((next - hole) & mSlotMask)) {
+            mSlots[hole] = mSlots[next];
+            hole = next;
+        }
+    }
+    mSlots[hole] = INVALID_INDEX;
+}
+
+void VASurfaceMapCache::clear(void) {
+    while (mOldest != INVALID_INDEX) {
+        remove(mEntries[mOldest].map);
+    }
+}
+
+VASurfaceMap* VASurfaceMapCache::leastRecent(void) {
+    return (mOldest != INVALID_INDEX) ? mEntries[mOldest].map : NULL;
+}
+
+VASurfaceMap* VASurfaceMapCache::moreRecent(VASurfaceMap *map) {
+    int32_t slot = findSlot(map->getValue());
+    if (slot == INVALID_INDEX) {
+        return NULL;
+    }
+    int32_t newer = mEntries[mSlots[slot]].newer;
+    return (newer != INVALID_INDEX) ? mEntries[newer].map : NULL;
+}
+
+uint32_t VASurfaceMapCache::getIdleCount(VASurfaceMap *map) {
+    int32_t slot = findSlot(map->getValue());
+    return (slot != INVALID_INDEX) ? mUses - mEntries[mSlots[slot]].lastUse : 0;
+}
+
+EncodeTaskQueue::EncodeTaskQueue()
+    :mTasks(NULL)
+    ,mMask(0)
+    ,mHead(0)
+    ,mTail(0)
+    ,mWaiters(0)
+    ,mWoken(false) {
+}
+
+EncodeTaskQueue::~EncodeTaskQueue() {
+    deinit();
+}
+
+Encode_Status EncodeTaskQueue::init(uint32_t capacity) {
+    deinit();
+
+    // head and tail run freely, the ring size is a power of two so they wrap cleanly
+    uint32_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mTasks = new EncodeTask* [size];
+    if (mTasks == NULL) {
+        return ENCODE_NO_MEMORY;
+    }
+    mMask = size - 1;
+
+    android::Mutex::Autolock lock(mLock);
+    mWoken = false;
+    return ENCODE_SUCCESS;
+}
+
+void EncodeTaskQueue::deinit(void) {
+    android::Mutex::Autolock lock(mLock);
+    // stays woken until the next init, so a waiter that has not run yet still leaves
+    mWoken = true;
+    mCond.broadcast();
+    while (mWaiters > 0) {
+        mCond.wait(mLock);
+    }
+    delete [] mTasks;
+    mTasks = NULL;
+    mMask = 0;
+    mHead = 0;
+    mTail = 0;
+}
+
+bool EncodeTaskQueue::push(EncodeTask *task) {
+    uint32_t tail = mTail;
+    if (tail - __atomic_load_n(&mHead, __ATOMIC_ACQUIRE) > mMask) {
+        return false;
+    }
+    mTasks[tail & mMask] = task;
+    __atomic_store_n(&mTail, tail + 1, __ATOMIC_RELEASE);
+
+    // pairs with the fence in wait(): either the consumer sees the new tail,
+    // or we see it waiting and signal under the lock
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mWaiters, __ATOMIC_RELAXED) > 0) {
+        android::Mutex::Autolock lock(mLock);
+        mCond.signal();
+    }
+    return true;
+}
+
+EncodeTask* EncodeTaskQueue::pop(void) {
+    uint32_t head = mHead;
+    if (head == __atomic_load_n(&mTail, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    EncodeTask *task = mTasks[head & mMask];
+    __atomic_store_n(&mHead, head + 1, __ATOMIC_RELEASE);
+    return task;
+}
+
+bool EncodeTaskQueue::empty(void) {
+    return mHead == __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+}
+
+bool EncodeTaskQueue::wait(uint32_t timeout) {
+    if (!empty()) {
+        return true;
+    }
+    if (timeout == FUNC_NONBLOCK) {
+        return false;
+    }
+
+    android::Mutex::Autolock lock(mLock);
+    __atomic_add_fetch(&mWaiters, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (empty() && !mWoken) {
+        if (timeout == FUNC_BLOCK) {
+            mCond.wait(mLock);
+        } else if (NO_ERROR != mCond.waitRelative(mLock, 1000000LL * timeout)) {
+            break;
+        }
+    }
+    // the last waiter to leave lets deinit free the ring
+    if (__atomic_sub_fetch(&mWaiters, 1, __ATOMIC_RELAXED) == 0 && mWoken) {
+        mCond.broadcast();
+    }
+    return !empty() && !mWoken;
+}
+
+void EncodeTaskQueue::wakeAll(void) {
+    android::Mutex::Autolock lock(mLock);
+    mWoken = true;
+    mCond.broadcast();
+}
+
+WaitHistogram::WaitHistogram() {
+    reset();
+}
+
+void WaitHistogram::reset(void) {
+    memset(mBuckets, 0, sizeof(mBuckets));
+    mCount = 0;
+    mTotal = 0;
+    mMax = 0;
+}
+
+void WaitHistogram::add(nsecs_t wait) {
+    uint32_t us = (uint32_t)(wait / 1000);
+    uint32_t bucket = 0;
+    while (us && bucket < NUM_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    mBuckets[bucket]++;
+    mCount++;
+    mTotal += wait;
+    if (wait > mMax) {
+        mMax = wait;
+    }
+}
+
+void WaitHistogram::dump(const char *name) {
+    if (mCount == 0) {
+        return;
+    }
+    char line[NUM_BUCKETS * 12];
+    int len = 0;
+    for (uint32_t i = 0; i < NUM_BUCKETS; i++) {
+        len += snprintf(line + len, sizeof(line) - len, " %u", mBuckets[i]);
+    }
+    LOG_I("%s: %u waits, avg %lld us, max %lld us, log2 us buckets:%s\n",
+            name, mCount, (long long)(mTotal / mCount / 1000), (long long)(mMax / 1000), line);
+}
@@ -20,6 +20,9 @@
 #include <va/va_tpi.h>
 #include "VideoEncoderDef.h"
 #include "IntelMetadataBuffer.h"
+#include "VABackend.h"
+#include <utils/threads.h>
+#include <utils/Timers.h>
 #ifdef IMG_GFX
 #include <hardware/gralloc.h>
 #endif
@@ -43,7 +46,10 @@ public:
     void setValue(intptr_t value) {mValue = value;}
     void setValueInfo(ValueInfo& vinfo) {memcpy(&mVinfo, &vinfo, sizeof(ValueInfo));}
     void setTracked() {mTracked = true;}
+    bool isTracked() {return mTracked;}
     void setAction(int32_t action) {mAction = action;}
+    // true if doMapping has work to do on an already mapped surface
+    bool needsAction() {return mAction & (MAP_ACTION_COPY | MAP_ACTION_COLORCONVERT);}
 
 private:
     Encode_Status doActionCopy();
@@ -55,6 +61,7 @@ private:
     Encode_Status MappingMallocPTR(intptr_t value);
     VASurfaceID CreateSurfaceFromExternalBuf(intptr_t value, ValueInfo& vinfo);
 
+    const VABackend *mVA;
     VADisplay mVADisplay;
 
     intptr_t mValue;
@@ -79,6 +86,122 @@ private:
 #endif
 };
 
+// Index of surface maps by value (buffer handle or pointer), open addressing hash with
+// the maps kept in least recently used order. Maps are not owned by the cache.
+class VASurfaceMapCache {
+public:
+    VASurfaceMapCache();
+    ~VASurfaceMapCache();
+
+    // counts a hit or miss, a found map becomes the most recently used
+    VASurfaceMap* find(intptr_t value);
+    // no counting, no LRU update
+    VASurfaceMap* lookup(intptr_t value);
+    // the value must not be in the cache yet
+    Encode_Status add(VASurfaceMap *map);
+    void remove(VASurfaceMap *map);
+    void clear(void);
+
+    uint32_t size(void) {return mCount;}
+    uint32_t getHits(void) {return mHits;}
+    uint32_t getMisses(void) {return mMisses;}
+
+    // iterate from the least to the most recently used map
+    VASurfaceMap* leastRecent(void);
+    VASurfaceMap* moreRecent(VASurfaceMap *map);
+    // number of find calls since the map was added or last found
+    uint32_t getIdleCount(VASurfaceMap *map);
+
+private:
+    struct Entry {
+        VASurfaceMap *map;
+        intptr_t value;
+        uint32_t lastUse;
+        int32_t older;
+        int32_t newer;  // next free entry if not used
+    };
+
+    enum {
+        INVALID_INDEX = -1,
+        INITIAL_CAPACITY = 32,
+    };
+
+    uint32_t hash(intptr_t value);
+    int32_t findSlot(intptr_t value);
+    void unlinkEntry(int32_t index);
+    void linkNewest(int32_t index);
+    Encode_Status grow(void);
+
+    Entry *mEntries;
+    int32_t *mSlots;    // entry index per slot, twice the entries so probes stay short
+    uint32_t mCapacity;
+    uint32_t mSlotMask;
+    uint32_t mCount;
+    int32_t mFree;
+    int32_t mOldest;
+    int32_t mNewest;
+    uint32_t mUses;
+    uint32_t mHits;
+    uint32_t mMisses;
+};
+
+struct EncodeTask;
+
+// Single producer, single consumer ring of encode tasks. push/pop don't take a lock,
+// a consumer that has to wait blocks on a condition the producer signals only when
+// someone is waiting. Capacity is fixed at init, tasks themselves are not owned.
+class EncodeTaskQueue {
+public:
+    EncodeTaskQueue();
+    ~EncodeTaskQueue();
+
+    Encode_Status init(uint32_t capacity);
+    // wakes all waiters and frees the ring once they have left
+    void deinit(void);
+
+    // producer side, fails only if the queue is full
+    bool push(EncodeTask *task);
+    // consumer side, NULL if empty
+    EncodeTask* pop(void);
+    // consumer side, waits up to timeout ms (FUNC_BLOCK: forever) for a task.
+    // Returns false on time out or once wakeAll is called.
+    bool wait(uint32_t timeout);
+    // releases waiting consumers until the next init
+    void wakeAll(void);
+    bool empty(void);
+
+private:
+    EncodeTask **mTasks;
+    uint32_t mMask;
+    uint32_t mHead;     // written by the consumer only
+    uint32_t mTail;     // written by the producer only
+    int32_t mWaiters;
+    bool mWoken;
+    android::Mutex mLock;
+    android::Condition mCond;
+};
+
+// Log2 histogram of wait times, bucket i counts waits shorter than 2^i us.
+// Meant to be updated by a single thread.
+class WaitHistogram {
+public:
+    WaitHistogram();
+
+    void reset(void);
+    void add(nsecs_t wait);
+    void dump(const char *name);
+
+private:
+    enum {
+        NUM_BUCKETS = 16,
+    };
+
+    uint32_t mBuckets[NUM_BUCKETS];
+    uint32_t mCount;
+    nsecs_t mTotal;
+    nsecs_t mMax;
+};
+
 VASurfaceID CreateNewVASurface(VADisplay display, int32_t width, int32_t height);
 
 #endif
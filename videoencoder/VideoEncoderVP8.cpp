@@ -91,7 +91,7 @@ Encode_Status VideoEncoderVP8::renderSequenceParams() {
     vp8SeqParam.bits_per_second = mComParams.rcParams.bitRate;
     memcpy(vp8SeqParam.reference_frames, mAutoRefSurfaces, sizeof(mAutoRefSurfaces) * mAutoReferenceSurfaceNum);
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncSequenceParameterBufferType,
             sizeof(vp8SeqParam),
@@ -99,7 +99,7 @@ Encode_Status VideoEncoderVP8::renderSequenceParams() {
             &mSeqParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mSeqParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "End\n");
@@ -127,7 +127,7 @@ Encode_Status VideoEncoderVP8::renderPictureParams(EncodeTask *task) {
     vp8PicParam.pic_flags.bits.refresh_golden_frame = mVideoConfigVP8ReferenceFrame.refresh_golden_frame;
     vp8PicParam.pic_flags.bits.refresh_alternate_frame = mVideoConfigVP8ReferenceFrame.refresh_alternate_frame;
 
-    vaStatus = vaCreateBuffer(
+    vaStatus = mVA->CreateBuffer(
             mVADisplay, mVAContext,
             VAEncPictureParameterBufferType,
             sizeof(vp8PicParam),
@@ -135,7 +135,7 @@ Encode_Status VideoEncoderVP8::renderPictureParams(EncodeTask *task) {
             &mPicParamBuf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &mPicParamBuf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &mPicParamBuf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");
 
     LOG_V( "End\n");
@@ -149,13 +149,13 @@ Encode_Status VideoEncoderVP8::renderRCParams(uint32_t layer_id, bool total_bitr
     VAEncMiscParameterBuffer *misc_param;
     VAEncMiscParameterRateControl *misc_rate_ctrl;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
                               VAEncMiscParameterBufferType,
                               sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterRateControl),
                               1,NULL,&rc_param_buf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaMapBuffer(mVADisplay, rc_param_buf,(void **)&misc_param);
+    mVA->MapBuffer(mVADisplay, rc_param_buf,(void **)&misc_param);
 
     misc_param->type = VAEncMiscParameterTypeRateControl;
     misc_rate_ctrl = (VAEncMiscParameterRateControl *)misc_param->data;
@@ -177,9 +177,9 @@ Encode_Status VideoEncoderVP8::renderRCParams(uint32_t layer_id, bool total_bitr
     misc_rate_ctrl->basic_unit_size = 0;
     misc_rate_ctrl->max_qp = mVideoParamsVP8.max_qp;
 
-    vaUnmapBuffer(mVADisplay, rc_param_buf);
+    mVA->UnmapBuffer(mVADisplay, rc_param_buf);
 
-    vaStatus = vaRenderPicture(mVADisplay,mVAContext, &rc_param_buf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay,mVAContext, &rc_param_buf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");;
     return 0;
 }
@@ -193,13 +193,13 @@ Encode_Status VideoEncoderVP8::renderFrameRateParams(uint32_t layer_id, bool tot
     uint32_t frameRateNum = mComParams.frameRate.frameRateNum;
     uint32_t frameRateDenom = mComParams.frameRate.frameRateDenom;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
                               VAEncMiscParameterBufferType,
                               sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterFrameRate),
                               1,NULL,&framerate_param_buf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaMapBuffer(mVADisplay, framerate_param_buf,(void **)&misc_param);
+    mVA->MapBuffer(mVADisplay, framerate_param_buf,(void **)&misc_param);
     misc_param->type = VAEncMiscParameterTypeFrameRate;
     misc_framerate = (VAEncMiscParameterFrameRate *)misc_param->data;
     memset(misc_framerate, 0, sizeof(*misc_framerate));
@@ -213,9 +213,9 @@ Encode_Status VideoEncoderVP8::renderFrameRateParams(uint32_t layer_id, bool tot
             misc_framerate->framerate = mTemporalLayerBitrateFramerate[layer_id].frameRate;
     }
 
-    vaUnmapBuffer(mVADisplay, framerate_param_buf);
+    mVA->UnmapBuffer(mVADisplay, framerate_param_buf);
 
-    vaStatus = vaRenderPicture(mVADisplay,mVAContext, &framerate_param_buf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay,mVAContext, &framerate_param_buf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");;
 
     return 0;
@@ -227,22 +227,22 @@ Encode_Status VideoEncoderVP8::renderHRDParams(void)
     VAStatus vaStatus = VA_STATUS_SUCCESS;
     VAEncMiscParameterBuffer *misc_param;
     VAEncMiscParameterHRD * misc_hrd;
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
                               VAEncMiscParameterBufferType,
                               sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterHRD),
                               1,NULL,&hrd_param_buf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaMapBuffer(mVADisplay, hrd_param_buf,(void **)&misc_param);
+    mVA->MapBuffer(mVADisplay, hrd_param_buf,(void **)&misc_param);
     misc_param->type = VAEncMiscParameterTypeHRD;
     misc_hrd = (VAEncMiscParameterHRD *)misc_param->data;
     memset(misc_hrd, 0, sizeof(*misc_hrd));
     misc_hrd->buffer_size = 1000;
     misc_hrd->initial_buffer_fullness = 500;
     misc_hrd->optimal_buffer_fullness = 600;
-    vaUnmapBuffer(mVADisplay, hrd_param_buf);
+    mVA->UnmapBuffer(mVADisplay, hrd_param_buf);
 
-    vaStatus = vaRenderPicture(mVADisplay,mVAContext, &hrd_param_buf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay,mVAContext, &hrd_param_buf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");;
 
     return 0;
@@ -259,20 +259,20 @@ Encode_Status VideoEncoderVP8::renderMaxFrameSizeParams(void)
     unsigned int frameRate = (unsigned int)(frameRateNum + frameRateDenom /2);
     unsigned int bitRate = mComParams.rcParams.bitRate;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
                               VAEncMiscParameterBufferType,
                               sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterHRD),
                               1,NULL,&max_frame_size_param_buf);
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
 
-    vaMapBuffer(mVADisplay, max_frame_size_param_buf,(void **)&misc_param);
+    mVA->MapBuffer(mVADisplay, max_frame_size_param_buf,(void **)&misc_param);
     misc_param->type = VAEncMiscParameterTypeMaxFrameSize;
     misc_maxframesize = (VAEncMiscParameterBufferMaxFrameSize *)misc_param->data;
     memset(misc_maxframesize, 0, sizeof(*misc_maxframesize));
     misc_maxframesize->max_frame_size = (unsigned int)((bitRate/frameRate) * mVideoParamsVP8.max_frame_size_ratio);
-    vaUnmapBuffer(mVADisplay, max_frame_size_param_buf);
+    mVA->UnmapBuffer(mVADisplay, max_frame_size_param_buf);
 
-    vaStatus = vaRenderPicture(mVADisplay,mVAContext, &max_frame_size_param_buf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay,mVAContext, &max_frame_size_param_buf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");;
 
     return 0;
@@ -286,13 +286,13 @@ Encode_Status VideoEncoderVP8::renderLayerStructureParam(void)
     VAEncMiscParameterTemporalLayerStructure *misc_layer_struc;
     uint32_t i;
 
-    vaStatus = vaCreateBuffer(mVADisplay, mVAContext,
+    vaStatus = mVA->CreateBuffer(mVADisplay, mVAContext,
                                 VAEncMiscParameterBufferType,
                                 sizeof(VAEncMiscParameterBuffer) + sizeof(VAEncMiscParameterTemporalLayerStructure),
                                 1, NULL, &layer_struc_buf);
 
     CHECK_VA_STATUS_RETURN("vaCreateBuffer");
-    vaMapBuffer(mVADisplay, layer_struc_buf, (void **)&misc_param);
+    mVA->MapBuffer(mVADisplay, layer_struc_buf, (void **)&misc_param);
     misc_param->type = VAEncMiscParameterTypeTemporalLayerStructure;
     misc_layer_struc = (VAEncMiscParameterTemporalLayerStructure *)misc_param->data;
     memset(misc_layer_struc, 0, sizeof(*misc_layer_struc));
@@ -306,9 +306,9 @@ Encode_Status VideoEncoderVP8::renderLayerStructureParam(void)
         misc_layer_struc->layer_id[i] = mComParams.nLayerID[i];
     }
 
-    vaUnmapBuffer(mVADisplay, layer_struc_buf);
+    mVA->UnmapBuffer(mVADisplay, layer_struc_buf);
 
-    vaStatus = vaRenderPicture(mVADisplay, mVAContext, &layer_struc_buf, 1);
+    vaStatus = mVA->RenderPicture(mVADisplay, mVAContext, &layer_struc_buf, 1);
     CHECK_VA_STATUS_RETURN("vaRenderPicture");;
 
     return 0;